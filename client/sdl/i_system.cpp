@@ -335,6 +335,130 @@ void I_Yield()
 	I_Sleep(1000LL * 1000LL);		// sleep for 1ms
 }
 
+//
+// Parallel work
+//
+// A small pool of worker threads, started on first use. I_RunParallel hands
+// out the parts of a job to the workers and the calling thread, which take
+// the next unclaimed part until none are left.
+//
+static const int MAX_PARALLEL_THREADS = 7;
+
+static SDL_Thread* parallel_threads[MAX_PARALLEL_THREADS];
+static int parallel_numthreads = -1;	// -1 until the pool is started
+static SDL_sem* parallel_start = NULL;
+static SDL_sem* parallel_done = NULL;
+static bool parallel_quit = false;
+
+static void (*parallel_func)(void* data, int part) = NULL;
+static void* parallel_data = NULL;
+static int parallel_parts = 0;
+static SDL_atomic_t parallel_next;
+
+static void I_RunParallelParts()
+{
+	int part;
+	while ((part = SDL_AtomicAdd(&parallel_next, 1)) < parallel_parts)
+		parallel_func(parallel_data, part);
+}
+
+static int I_ParallelThread(void*)
+{
+	while (true)
+	{
+		SDL_SemWait(parallel_start);
+		if (parallel_quit)
+			break;
+
+		I_RunParallelParts();
+		SDL_SemPost(parallel_done);
+	}
+
+	return 0;
+}
+
+static void STACK_ARGS I_ShutdownParallel()
+{
+	parallel_quit = true;
+	for (int i = 0; i < parallel_numthreads; i++)
+		SDL_SemPost(parallel_start);
+	for (int i = 0; i < parallel_numthreads; i++)
+		SDL_WaitThread(parallel_threads[i], NULL);
+
+	SDL_DestroySemaphore(parallel_start);
+	SDL_DestroySemaphore(parallel_done);
+	parallel_numthreads = 0;
+}
+
+static void I_InitParallel()
+{
+	parallel_numthreads = 0;
+
+	const int count = MIN(SDL_GetCPUCount() - 1, MAX_PARALLEL_THREADS);
+	if (count <= 0)
+		return;
+
+	parallel_start = SDL_CreateSemaphore(0);
+	parallel_done = SDL_CreateSemaphore(0);
+	if (parallel_start == NULL || parallel_done == NULL)
+		return;
+
+	for (int i = 0; i < count; i++)
+	{
+		SDL_Thread* thread = SDL_CreateThread(I_ParallelThread, "ParallelWorker", NULL);
+		if (thread == NULL)
+			break;
+		parallel_threads[parallel_numthreads++] = thread;
+	}
+
+	atterm(I_ShutdownParallel);
+}
+
+//
+// I_ParallelWorkers
+//
+// Returns the number of threads I_RunParallel can spread work over,
+// including the calling thread.
+//
+int I_ParallelWorkers()
+{
+	if (parallel_numthreads < 0)
+		I_InitParallel();
+
+	return parallel_numthreads + 1;
+}
+
+//
+// I_RunParallel
+//
+// Runs func(data, part) for every part in [0, parts) on the worker pool and
+// the calling thread, and returns once all of them have finished. Parts may
+// run in any order and on any thread, so they must not depend on each other.
+//
+void I_RunParallel(void (*func)(void* data, int part), void* data, int parts)
+{
+	const int threads = MIN(I_ParallelWorkers() - 1, parts - 1);
+	if (threads <= 0)
+	{
+		for (int i = 0; i < parts; i++)
+			func(data, i);
+		return;
+	}
+
+	parallel_func = func;
+	parallel_data = data;
+	parallel_parts = parts;
+	SDL_AtomicSet(&parallel_next, 0);
+
+	for (int i = 0; i < threads; i++)
+		SDL_SemPost(parallel_start);
+
+	I_RunParallelParts();
+
+	for (int i = 0; i < threads; i++)
+		SDL_SemWait(parallel_done);
+}
+
 //
 // I_WaitVBL
 //
@@ -981,7 +1105,8 @@ bool I_IsHeadless()
 	static bool initialized = false;
 	if (!initialized)
 	{
-		headless = Args.CheckParm("-novideo") || Args.CheckParm("+demotest");
+		headless = Args.CheckParm("-novideo") || Args.CheckParm("+demotest") ||
+		           Args.CheckParm("-renderbench");
 		initialized = true;
 	}
 
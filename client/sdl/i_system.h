@@ -68,6 +68,12 @@ void I_Sleep(dtime_t);
 // yields to the OS for 1 millisecond
 void I_Yield();
 
+// number of threads I_RunParallel can spread work over, including the caller
+int I_ParallelWorkers();
+// runs func(data, part) for every part in [0, parts) and returns when all
+// of them are done
+void I_RunParallel(void (*func)(void* data, int part), void* data, int parts);
+
 //
 // Called by D_DoomLoop,
 // called before processing each tic in a frame.
@@ -43,11 +43,14 @@
 
 #include "i_system.h"
 #include "m_misc.h"
+#include "m_argv.h"
 #include "i_input.h"
 #include "m_fileio.h"
 
 #include "w_wad.h"
 #include "cmdlib.h"
+#include "c_dispatch.h"
+#include "r_intrin.h"
 
 // [Russell] - Just for windows, display the icon in the system menu and
 // alt-tab display
@@ -85,6 +88,8 @@ static IWindowSurface* loading_icon_background_surface = NULL;
 
 extern IWindowSurface* scaled_screenblocks_surface;
 
+EXTERN_CVAR(vid_defwidth)
+EXTERN_CVAR(vid_defheight)
 EXTERN_CVAR(vid_32bpp)
 EXTERN_CVAR(vid_fullscreen)
 EXTERN_CVAR(vid_vsync)
@@ -314,6 +319,171 @@ static void BlitLoopCrop(DEST_PIXEL_T* dest, const SOURCE_PIXEL_T* source,
 }
 
 
+//
+// BlitRowInteger
+//
+// Converts a row of srcw source pixels, writing each converted pixel
+// xfactor times. Used when the destination is an exact integer multiple of
+// the source size so that each source pixel is only converted once.
+//
+template <typename SOURCE_PIXEL_T, typename DEST_PIXEL_T>
+static void BlitRowInteger(DEST_PIXEL_T* dest, const SOURCE_PIXEL_T* source,
+					int srcw, int xfactor, const argb_t* palette)
+{
+	if (sizeof(DEST_PIXEL_T) == sizeof(SOURCE_PIXEL_T) && xfactor == 1)
+	{
+		memcpy(dest, source, srcw * sizeof(SOURCE_PIXEL_T));
+	}
+	else if (xfactor == 1)
+	{
+		for (int x = 0; x < srcw; x++)
+			dest[x] = ConvertPixel<SOURCE_PIXEL_T, DEST_PIXEL_T>(source[x], palette);
+	}
+	else
+	{
+		for (int x = 0; x < srcw; x++)
+		{
+			const DEST_PIXEL_T value = ConvertPixel<SOURCE_PIXEL_T, DEST_PIXEL_T>(source[x], palette);
+			for (int i = 0; i < xfactor; i++)
+				dest[i] = value;
+			dest += xfactor;
+		}
+	}
+}
+
+
+#ifdef __SSE2__
+
+//
+// BlitRowInteger_SSE2
+//
+// SSE2 version of BlitRowInteger for 8bpp palette to 32bpp ARGB expansion.
+// SSE2 has no gather so the palette lookups are scalar, but the converted
+// pixels are assembled four at a time and replicated with unpacks/broadcasts
+// instead of being written individually.
+//
+static void BlitRowInteger_SSE2(argb_t* dest, const palindex_t* source,
+					int srcw, int xfactor, const argb_t* palette)
+{
+	const uint32_t* pal = (const uint32_t*)palette;
+	int x = 0;
+
+	if (xfactor == 1)
+	{
+		for (; x + 4 <= srcw; x += 4)
+		{
+			const __m128i v = _mm_setr_epi32(pal[source[x]], pal[source[x + 1]],
+					pal[source[x + 2]], pal[source[x + 3]]);
+			_mm_storeu_si128((__m128i*)dest, v);
+			dest += 4;
+		}
+	}
+	else if (xfactor == 2)
+	{
+		for (; x + 4 <= srcw; x += 4)
+		{
+			const __m128i v = _mm_setr_epi32(pal[source[x]], pal[source[x + 1]],
+					pal[source[x + 2]], pal[source[x + 3]]);
+			_mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi32(v, v));
+			_mm_storeu_si128((__m128i*)(dest + 4), _mm_unpackhi_epi32(v, v));
+			dest += 8;
+		}
+	}
+	else
+	{
+		for (; x < srcw; x++)
+		{
+			const uint32_t value = pal[source[x]];
+			const __m128i v = _mm_set1_epi32(value);
+
+			int i = 0;
+			for (; i + 4 <= xfactor; i += 4)
+				_mm_storeu_si128((__m128i*)(dest + i), v);
+			for (; i < xfactor; i++)
+				dest[i] = value;
+			dest += xfactor;
+		}
+	}
+
+	// remaining pixels for the 1x and 2x loops
+	for (; x < srcw; x++)
+	{
+		const argb_t value = palette[source[x]];
+		for (int i = 0; i < xfactor; i++)
+			dest[i] = value;
+		dest += xfactor;
+	}
+}
+
+#endif	// __SSE2__
+
+
+// Set to false by the blitbench command to time the generic blitters.
+static bool blit_fast_paths = true;
+
+//
+// I_BlitUseSSE2
+//
+// Returns true if the SSE2 blitters were compiled in and the CPU supports them.
+//
+static bool I_BlitUseSSE2()
+{
+	#ifdef __SSE2__
+	static const bool has_sse2 = SDL_HasSSE2();
+	return has_sse2 && blit_fast_paths;
+	#else
+	return false;
+	#endif
+}
+
+
+//
+// BlitRowInteger
+//
+// 8bpp to 32bpp overload that picks the vectorized row blitter if available.
+//
+static void BlitRowInteger(argb_t* dest, const palindex_t* source,
+					int srcw, int xfactor, const argb_t* palette)
+{
+	#ifdef __SSE2__
+	if (I_BlitUseSSE2())
+	{
+		BlitRowInteger_SSE2(dest, source, srcw, xfactor, palette);
+		return;
+	}
+	#endif
+
+	BlitRowInteger<palindex_t, argb_t>(dest, source, srcw, xfactor, palette);
+}
+
+
+//
+// BlitLoopInteger
+//
+// Blits a source image scaled by integer factors xfactor and yfactor.
+// Each source row is converted once and the result is copied to the
+// remaining yfactor - 1 destination rows.
+//
+template <typename SOURCE_PIXEL_T, typename DEST_PIXEL_T>
+static void BlitLoopInteger(DEST_PIXEL_T* dest, const SOURCE_PIXEL_T* source,
+					int destpitchpixels, int srcpitchpixels, int srcw, int srch,
+					int xfactor, int yfactor, const argb_t* palette)
+{
+	const size_t row_bytes = srcw * xfactor * sizeof(DEST_PIXEL_T);
+
+	for (int y = 0; y < srch; y++)
+	{
+		BlitRowInteger(dest, source, srcw, xfactor, palette);
+
+		for (int i = 1; i < yfactor; i++)
+			memcpy(dest + i * destpitchpixels, dest, row_bytes);
+
+		dest += yfactor * destpitchpixels;
+		source += srcpitchpixels;
+	}
+}
+
+
 //
 // IWindowSurface::blitcrop
 //
@@ -525,12 +695,21 @@ void IWindowSurface::blit(const IWindowSurface* source_surface, int srcx, int sr
 	
 	const argb_t* palette = source_surface->getPalette();
 
+	// Exact integer scale factors (including 1:1) are the common case
+	// (vid_320x200, vid_640x400 and the 8bpp to 32bpp conversion surface) and
+	// can convert each source pixel once instead of once per dest pixel.
+	const bool integer_scale = blit_fast_paths && destw % srcw == 0 && desth % srch == 0;
+	const int xfactor = destw / srcw, yfactor = desth / srch;
+
 	if (srcbits == 8 && destbits == 8)
 	{
 		const palindex_t* source = (palindex_t*)source_surface->getBuffer() + srcy * srcpitchpixels + srcx;
 		palindex_t* dest = (palindex_t*)getBuffer() + desty * destpitchpixels + destx;
 
-		BlitLoop(dest, source, destpitchpixels, srcpitchpixels, destw, desth, xstep, ystep, palette);
+		if (integer_scale)
+			BlitLoopInteger(dest, source, destpitchpixels, srcpitchpixels, srcw, srch, xfactor, yfactor, palette);
+		else
+			BlitLoop(dest, source, destpitchpixels, srcpitchpixels, destw, desth, xstep, ystep, palette);
 	}
 	else if (srcbits == 8 && destbits == 32)
 	{
@@ -540,7 +719,10 @@ void IWindowSurface::blit(const IWindowSurface* source_surface, int srcx, int sr
 		const palindex_t* source = (palindex_t*)source_surface->getBuffer() + srcy * srcpitchpixels + srcx;
 		argb_t* dest = (argb_t*)getBuffer() + desty * destpitchpixels + destx;
 
-		BlitLoop(dest, source, destpitchpixels, srcpitchpixels, destw, desth, xstep, ystep, palette);
+		if (integer_scale)
+			BlitLoopInteger(dest, source, destpitchpixels, srcpitchpixels, srcw, srch, xfactor, yfactor, palette);
+		else
+			BlitLoop(dest, source, destpitchpixels, srcpitchpixels, destw, desth, xstep, ystep, palette);
 	}
 	else if (srcbits == 32 && destbits == 8)
 	{
@@ -552,7 +734,10 @@ void IWindowSurface::blit(const IWindowSurface* source_surface, int srcx, int sr
 		const argb_t* source = (argb_t*)source_surface->getBuffer() + srcy * srcpitchpixels + srcx;
 		argb_t* dest = (argb_t*)getBuffer() + desty * destpitchpixels + destx;
 
-		BlitLoop(dest, source, destpitchpixels, srcpitchpixels, destw, desth, xstep, ystep, palette);
+		if (integer_scale)
+			BlitLoopInteger(dest, source, destpitchpixels, srcpitchpixels, srcw, srch, xfactor, yfactor, palette);
+		else
+			BlitLoop(dest, source, destpitchpixels, srcpitchpixels, destw, desth, xstep, ystep, palette);
 	}
 }
 
@@ -935,7 +1120,35 @@ void STACK_ARGS I_ShutdownHardware()
 //
 void I_InitHardware()
 {
-	if (I_IsHeadless())
+	if (I_IsHeadless() && Args.CheckParm("-renderbench"))
+	{
+		// Offscreen rendering for -renderbench. Pick the mode the same way
+		// V_Init will so that the requested mode always matches the surface.
+		int width = M_GetParmValue("-width"), height = M_GetParmValue("-height");
+		int bpp = M_GetParmValue("-bits");
+
+		if (width == 0 && height == 0)
+		{
+			width = vid_defwidth.asInt();
+			height = vid_defheight.asInt();
+		}
+		else if (width == 0)
+		{
+			width = height * 4 / 3;
+		}
+		else if (height == 0)
+		{
+			height = width * 3 / 4;
+		}
+
+		if (bpp != 8 && bpp != 32)
+			bpp = vid_32bpp ? 32 : 8;
+
+		width = clamp(width, 320, MAXWIDTH);
+		height = clamp(height, 200, MAXHEIGHT);
+		video_subsystem = new IDummyVideoSubsystem(IVideoMode(width, height, bpp, WINDOW_Windowed));
+	}
+	else if (I_IsHeadless())
 	{
 		video_subsystem = new IDummyVideoSubsystem();
 	}
@@ -1438,4 +1651,70 @@ int I_GetAspectCorrectWidth(int surface_height, int asset_height, int asset_widt
 	return aspect_scale_ratio * asset_width;
 }
 
+
+//
+// I_BlitBenchmark
+//
+// Times IWindowSurface::blit from a 320x200 source of the given bit depth to
+// a destination scaled by factor, with and without the fast paths.
+//
+static void I_BlitBenchmark(int srcbits, int destbits, int factor, int iterations)
+{
+	IWindowSurface* source = I_AllocateSurface(320, 200, srcbits);
+	IWindowSurface* dest = I_AllocateSurface(320 * factor, 200 * factor, destbits);
+
+	// fill the source with a pattern that doesn't hit the same palette entry
+	// for every pixel
+	source->lock();
+	for (int y = 0; y < source->getHeight(); y++)
+	{
+		uint8_t* row = source->getBuffer(0, y);
+		for (int x = 0; x < source->getWidth() * source->getBytesPerPixel(); x++)
+			row[x] = (x * 7 + y * 13) & 0xFF;
+	}
+	source->unlock();
+
+	double elapsed[2];
+	for (int pass = 0; pass < 2; pass++)
+	{
+		blit_fast_paths = (pass == 1);
+
+		dtime_t start = I_GetTime();
+		for (int i = 0; i < iterations; i++)
+			dest->blit(source, 0, 0, source->getWidth(), source->getHeight(),
+					0, 0, dest->getWidth(), dest->getHeight());
+		elapsed[pass] = double(I_GetTime() - start) / (1000000.0 * iterations);
+	}
+
+	blit_fast_paths = true;
+
+	Printf(PRINT_HIGH, "%2d -> %2d bpp  %4dx%-4d  generic %7.3f ms  fast%s %7.3f ms\n",
+			srcbits, destbits, dest->getWidth(), dest->getHeight(), elapsed[0],
+			(srcbits == 8 && destbits == 32 && I_BlitUseSSE2()) ? " (sse2)" : "       ",
+			elapsed[1]);
+
+	I_FreeSurface(dest);
+	I_FreeSurface(source);
+}
+
+
+BEGIN_COMMAND(blitbench)
+{
+	int iterations = argc > 1 ? atoi(argv[1]) : 100;
+	if (iterations <= 0)
+	{
+		Printf(PRINT_HIGH, "Usage: blitbench [iterations]\n");
+		return;
+	}
+
+	static const int formats[][2] = { { 8, 8 }, { 8, 32 }, { 32, 32 } };
+	static const int factors[] = { 1, 2, 3, 4 };
+
+	for (size_t i = 0; i < ARRAY_LENGTH(formats); i++)
+		for (size_t j = 0; j < ARRAY_LENGTH(factors); j++)
+			I_BlitBenchmark(formats[i][0], formats[i][1], factors[j], iterations);
+}
+END_COMMAND(blitbench)
+
+
 VERSION_CONTROL (i_video_cpp, "$Id$")
@@ -266,7 +266,8 @@ public:
 class IDummyVideoCapabilities : public IVideoCapabilities
 {
 public:
-	IDummyVideoCapabilities() : IVideoCapabilities(), mVideoMode(320, 200, 8, WINDOW_Windowed)
+	IDummyVideoCapabilities(const IVideoMode& video_mode) :
+		IVideoCapabilities(), mVideoMode(video_mode)
 	{	mModeList.push_back(mVideoMode);	}
 
 	virtual ~IDummyVideoCapabilities() { }
@@ -432,6 +433,14 @@ public:
 
 	virtual void startRefresh() { }
 	virtual void finishRefresh() { }
+
+	// time the caller spent in finishRefresh for the last frame
+	virtual dtime_t getPresentTime() const
+	{	return 0;	}
+
+	// time from a frame being finished to it reaching the screen
+	virtual dtime_t getPresentLatency() const
+	{	return 0;	}
 };
 
 
@@ -534,6 +543,12 @@ public:
 	virtual void startRefresh() { }
 	virtual void finishRefresh() { }
 
+	virtual dtime_t getPresentTime() const
+	{	return 0;	}
+
+	virtual dtime_t getPresentLatency() const
+	{	return 0;	}
+
 	virtual void setWindowTitle(const std::string& caption = "") { }
 	virtual void setWindowIcon() { }
 
@@ -560,9 +575,9 @@ public:
 class IDummyWindow : public IWindow
 {
 public:
-	IDummyWindow() :
-		IWindow(), mPrimarySurface(NULL), mVideoMode(320, 200, 8, WINDOW_Windowed),
-		mPixelFormat(8, 0, 0, 0, 0, 0, 0, 0, 0)
+	IDummyWindow(const IVideoMode& video_mode) :
+		IWindow(), mPrimarySurface(NULL), mVideoMode(video_mode),
+		mPixelFormat(video_mode.bpp == 8 ? *I_Get8bppPixelFormat() : *I_Get32bppPixelFormat())
 	{ }
 
 	virtual ~IDummyWindow()
@@ -648,17 +663,20 @@ public:
 //
 // IDummyVideoSubsystem class interface
 //
-// Video subsystem for headless clients.
+// Video subsystem for headless clients. The surface is always created with
+// the given mode, which is 320x200x8 unless an offscreen render benchmark
+// requested otherwise.
 //
 // ============================================================================
 
 class IDummyVideoSubsystem : public IVideoSubsystem
 {
 public:
-	IDummyVideoSubsystem() : IVideoSubsystem()
+	IDummyVideoSubsystem(const IVideoMode& video_mode = IVideoMode(320, 200, 8, WINDOW_Windowed)) :
+		IVideoSubsystem()
 	{
-		mVideoCapabilities = new IDummyVideoCapabilities();
-		mWindow = new IDummyWindow();
+		mVideoCapabilities = new IDummyVideoCapabilities(video_mode);
+		mWindow = new IDummyWindow(video_mode);
 	}
 
 	virtual ~IDummyVideoSubsystem()
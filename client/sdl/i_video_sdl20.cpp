@@ -56,6 +56,7 @@
 EXTERN_CVAR (vid_fullscreen)
 EXTERN_CVAR (vid_widescreen)
 EXTERN_CVAR (vid_pillarbox)
+EXTERN_CVAR (vid_pipelinepresent)
 
 #ifdef SDL20
 // ============================================================================
@@ -213,6 +214,9 @@ ISDL20TextureWindowSurfaceManager::ISDL20TextureWindowSurfaceManager(
 		mWindow(window),
 		mSDLRenderer(NULL), mSDLTexture(NULL),
 		mSurface(NULL), m8bppTo32BppSurface(NULL),
+		mPresentThread(NULL), mPresentMutex(NULL), mPresentCond(NULL),
+		mPresentQuit(false), mFramePending(false), mFrameConverted(false),
+		mStageSurface(NULL), mFrameFinishedTime(0), mPresentTime(0), mPresentLatency(0),
         mWidth(width), mHeight(height)
 {
 	assert(mWindow != NULL);
@@ -295,6 +299,8 @@ ISDL20TextureWindowSurfaceManager::ISDL20TextureWindowSurfaceManager(
 //
 ISDL20TextureWindowSurfaceManager::~ISDL20TextureWindowSurfaceManager()
 {
+	stopPresentThread();
+
     delete m8bppTo32BppSurface;
 	delete mSurface;
 
@@ -346,21 +352,10 @@ void ISDL20TextureWindowSurfaceManager::startRefresh()
 
 
 //
-// ISDL20TextureWindowSurfaceManager::finishRefresh
+// ISDL20TextureWindowSurfaceManager::presentTexture
 //
-void ISDL20TextureWindowSurfaceManager::finishRefresh()
+void ISDL20TextureWindowSurfaceManager::presentTexture()
 {
-    if (mSurface->getBitsPerPixel() == 8)
-    {
-        m8bppTo32BppSurface->blit(mSurface, 0, 0, mSurface->getWidth(), mSurface->getHeight(),
-                0, 0, m8bppTo32BppSurface->getWidth(), m8bppTo32BppSurface->getHeight());
-	    SDL_UpdateTexture(mSDLTexture, NULL, m8bppTo32BppSurface->getBuffer(), m8bppTo32BppSurface->getPitch());
-    }
-    else
-    {
-	   SDL_UpdateTexture(mSDLTexture, NULL, mSurface->getBuffer(), mSurface->getPitch());
-    }
-
 	if (mDrawLogicalRect)
 		SDL_RenderCopy(mSDLRenderer, mSDLTexture, NULL, &mLogicalRect);
 	else
@@ -370,6 +365,183 @@ void ISDL20TextureWindowSurfaceManager::finishRefresh()
 }
 
 
+//
+// ISDL20TextureWindowSurfaceManager::presentThreadFunc
+//
+// Entry point of the conversion thread. Waits for the main thread to stage
+// a finished 8bpp frame and expands it into m8bppTo32BppSurface. It makes
+// no SDL_Renderer calls; the upload and present stay on the main thread.
+//
+int ISDL20TextureWindowSurfaceManager::presentThreadFunc(void* data)
+{
+	ISDL20TextureWindowSurfaceManager* manager =
+		static_cast<ISDL20TextureWindowSurfaceManager*>(data);
+
+	SDL_LockMutex(manager->mPresentMutex);
+	while (true)
+	{
+		while (!manager->mFramePending && !manager->mPresentQuit)
+			SDL_CondWait(manager->mPresentCond, manager->mPresentMutex);
+
+		if (manager->mPresentQuit)
+			break;
+
+		SDL_UnlockMutex(manager->mPresentMutex);
+		manager->m8bppTo32BppSurface->blit(manager->mStageSurface, 0, 0,
+				manager->mWidth, manager->mHeight, 0, 0, manager->mWidth, manager->mHeight);
+		SDL_LockMutex(manager->mPresentMutex);
+
+		manager->mFramePending = false;
+		SDL_CondBroadcast(manager->mPresentCond);
+	}
+	SDL_UnlockMutex(manager->mPresentMutex);
+
+	return 0;
+}
+
+
+//
+// ISDL20TextureWindowSurfaceManager::startPresentThread
+//
+// Starts the conversion thread. Returns false if that is not possible.
+//
+bool ISDL20TextureWindowSurfaceManager::startPresentThread()
+{
+	mPresentQuit = false;
+	mFramePending = false;
+	mFrameConverted = false;
+
+	mStageSurface = new IWindowSurface(mWidth, mHeight, &mFormat);
+	mStageSurface->setPalette(mStagePalette);
+
+	mPresentMutex = SDL_CreateMutex();
+	mPresentCond = SDL_CreateCond();
+	if (mPresentMutex && mPresentCond)
+		mPresentThread = SDL_CreateThread(presentThreadFunc, "present", this);
+
+	if (mPresentThread == NULL)
+	{
+		Printf(PRINT_WARNING, "Unable to start presentation thread: %s\n", SDL_GetError());
+		stopPresentThread();
+		return false;
+	}
+
+	return true;
+}
+
+
+//
+// ISDL20TextureWindowSurfaceManager::stopPresentThread
+//
+// Joins the conversion thread. A frame that was converted but not presented
+// yet is dropped.
+//
+void ISDL20TextureWindowSurfaceManager::stopPresentThread()
+{
+	if (mPresentThread)
+	{
+		SDL_LockMutex(mPresentMutex);
+		mPresentQuit = true;
+		SDL_CondBroadcast(mPresentCond);
+		SDL_UnlockMutex(mPresentMutex);
+
+		SDL_WaitThread(mPresentThread, NULL);
+		mPresentThread = NULL;
+	}
+
+	mFramePending = false;
+	mFrameConverted = false;
+
+	if (mPresentCond)
+		SDL_DestroyCond(mPresentCond);
+	if (mPresentMutex)
+		SDL_DestroyMutex(mPresentMutex);
+	mPresentCond = NULL;
+	mPresentMutex = NULL;
+
+	delete mStageSurface;
+	mStageSurface = NULL;
+}
+
+
+//
+// ISDL20TextureWindowSurfaceManager::finishRefresh
+//
+// With vid_pipelinepresent enabled, 8bpp frames are staged and expanded to
+// the texture's pixel format on the conversion thread while the main thread
+// uploads and presents the frame before, so frames reach the screen one
+// frame late. 32bpp frames need no conversion and are presented directly.
+//
+void ISDL20TextureWindowSurfaceManager::finishRefresh()
+{
+	const dtime_t start_time = I_GetTime();
+
+	if (vid_pipelinepresent && mWindow->mBlit && mSurface->getBitsPerPixel() == 8)
+	{
+		if (mPresentThread == NULL && !startPresentThread())
+			vid_pipelinepresent.Set(0.0f);
+	}
+	else if (mPresentThread != NULL)
+	{
+		stopPresentThread();
+	}
+
+	if (mPresentThread != NULL)
+	{
+		SDL_LockMutex(mPresentMutex);
+		while (mFramePending)
+			SDL_CondWait(mPresentCond, mPresentMutex);
+		SDL_UnlockMutex(mPresentMutex);
+
+		// m8bppTo32BppSurface holds the previous frame; upload it before the
+		// conversion thread starts writing the next one into it
+		const bool present = mFrameConverted;
+		const dtime_t frame_time = mFrameFinishedTime;
+		if (present)
+			SDL_UpdateTexture(mSDLTexture, NULL, m8bppTo32BppSurface->getBuffer(), m8bppTo32BppSurface->getPitch());
+
+		// The renderer relies on the primary surface keeping its contents
+		// between frames (status bar, view border), so stage a copy.
+		memcpy(mStageSurface->getBuffer(), mSurface->getBuffer(),
+				mSurface->getPitch() * mSurface->getHeight());
+		if (mSurface->getPalette())
+			memcpy(mStagePalette, mSurface->getPalette(), sizeof(mStagePalette));
+
+		mFrameFinishedTime = start_time;
+		mFrameConverted = true;
+
+		SDL_LockMutex(mPresentMutex);
+		mFramePending = true;
+		SDL_CondBroadcast(mPresentCond);
+		SDL_UnlockMutex(mPresentMutex);
+
+		if (present)
+		{
+			presentTexture();
+			mPresentLatency = I_GetTime() - frame_time;
+		}
+	}
+	else
+	{
+		if (mSurface->getBitsPerPixel() == 8)
+		{
+			m8bppTo32BppSurface->blit(mSurface, 0, 0, mSurface->getWidth(), mSurface->getHeight(),
+					0, 0, m8bppTo32BppSurface->getWidth(), m8bppTo32BppSurface->getHeight());
+			SDL_UpdateTexture(mSDLTexture, NULL, m8bppTo32BppSurface->getBuffer(), m8bppTo32BppSurface->getPitch());
+		}
+		else
+		{
+			SDL_UpdateTexture(mSDLTexture, NULL, mSurface->getBuffer(), mSurface->getPitch());
+		}
+
+		presentTexture();
+
+		mPresentLatency = I_GetTime() - start_time;
+	}
+
+	mPresentTime = I_GetTime() - start_time;
+}
+
 
 
 // ============================================================================
@@ -98,6 +98,12 @@ public:
 	virtual void startRefresh();
 	virtual void finishRefresh();
 
+	virtual dtime_t getPresentTime() const
+	{	return mPresentTime;	}
+
+	virtual dtime_t getPresentLatency() const
+	{	return mPresentLatency;	}
+
 private:
 	ISDL20Window*			mWindow;
 	SDL_Renderer*			mSDLRenderer;
@@ -106,6 +112,24 @@ private:
 	IWindowSurface*			mSurface;
 	IWindowSurface*			m8bppTo32BppSurface;
 
+	// Pipelined presentation (vid_pipelinepresent). 8bpp frames are copied
+	// to mStageSurface and expanded into m8bppTo32BppSurface by
+	// mPresentThread, while the main thread uploads and presents the frame
+	// before. The renderer and texture are only used by the main thread.
+	SDL_Thread*				mPresentThread;
+	SDL_mutex*				mPresentMutex;
+	SDL_cond*				mPresentCond;
+	bool					mPresentQuit;
+	bool					mFramePending;		// mStageSurface awaits conversion
+	bool					mFrameConverted;	// m8bppTo32BppSurface awaits upload
+
+	IWindowSurface*			mStageSurface;
+	argb_t					mStagePalette[256];
+
+	dtime_t					mFrameFinishedTime;
+	dtime_t					mPresentTime;
+	dtime_t					mPresentLatency;
+
 	uint16_t				mWidth;
 	uint16_t				mHeight;
 
@@ -115,6 +139,12 @@ private:
 	SDL_Rect mLogicalRect;
 
 	SDL_Renderer* createRenderer(bool vsync) const;
+
+	void presentTexture();
+
+	bool startPresentThread();
+	void stopPresentThread();
+	static int presentThreadFunc(void* data);
 };
 
 
@@ -191,6 +221,12 @@ public:
 	virtual void startRefresh();
 	virtual void finishRefresh();
 
+	virtual dtime_t getPresentTime() const
+	{	return mSurfaceManager ? mSurfaceManager->getPresentTime() : 0;	}
+
+	virtual dtime_t getPresentLatency() const
+	{	return mSurfaceManager ? mSurfaceManager->getPresentLatency() : 0;	}
+
 	virtual void lockSurface();
 	virtual void unlockSurface();
 
@@ -780,6 +780,10 @@ CVAR_FUNC_DECL(	vid_maxfps, "60", "Maximum framerate (0 indicates unlimited fram
 CVAR_FUNC_DECL(	vid_vsync, "0", "Enable/Disable vertical refresh sync (vsync)",
 				CVARTYPE_BOOL, CVAR_CLIENTARCHIVE)
 
+CVAR(			vid_pipelinepresent, "0", "Convert finished 8bpp frames on a separate thread while the "
+				"previous frame is presented (adds one frame of latency)",
+				CVARTYPE_BOOL, CVAR_CLIENTARCHIVE)
+
 #ifdef GCONSOLE
 CVAR_FUNC_DECL(	vid_fullscreen, "1", "Full screen video mode",
 				CVARTYPE_BYTE, CVAR_CLIENTARCHIVE | CVAR_NOENABLEDISABLE)
@@ -37,6 +37,7 @@
 #include "p_mobj.h"
 #include "svc_message.h"
 #include "g_gametype.h"
+#include "r_bench.h"
 
 EXTERN_CVAR(sv_maxclients)
 EXTERN_CVAR(sv_maxplayers)
@@ -45,6 +46,8 @@ extern std::string server_host;
 extern std::string digest;
 extern OResFiles wadfiles;
 
+void CL_QuitCommand();
+
 /**
  * @brief Map demo versions to the latest Odamex version that can read them.
  *
@@ -712,6 +715,12 @@ bool NetDemo::stopPlaying()
     gameaction = ga_fullconsole;
     gamestate = GS_FULLCONSOLE;
 
+	if (R_BenchActive())
+	{
+		R_BenchFinish();
+		CL_QuitCommand();
+	}
+
 	return true;
 }
 
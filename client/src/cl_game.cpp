@@ -65,6 +65,7 @@
 #include "g_spawninv.h"
 #include "g_gametype.h"
 #include "p_horde.h"
+#include "r_bench.h"
 
 #ifdef _XBOX
 #include "i_xbox.h"
@@ -2161,6 +2162,7 @@ BOOL G_CheckDemoStatus (void)
 
 				Printf(PRINT_HIGH, "timed %i gametics in %i realtics (%.1f fps)\n",
 						gametic, realtics, fps);
+				R_BenchFinish();
 
 				// exit the application
 				CL_QuitCommand();
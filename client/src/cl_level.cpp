@@ -616,8 +616,7 @@ void G_DoLoadLevel (int position)
 	// died.
 
 	{
-		extern msecnode_t *headsecnode; // phares 3/25/98
-		headsecnode = NULL;
+		P_ClearSecNodes(); // phares 3/25/98
 
 		// denis - todo - wtf is this crap?
 		// [RH] Need to prevent the AActor destructor from trying to
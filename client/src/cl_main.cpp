@@ -47,6 +47,7 @@
 #include "w_ident.h"
 #include "md5.h"
 #include "m_fileio.h"
+#include "m_wdlstats.h"
 #include "r_sky.h"
 #include "r_interp.h"
 #include "cl_demo.h"
@@ -695,6 +696,8 @@ void CL_RunTics()
 		CL_StepTics(1);
 	}
 
+	M_WDLTicker();
+
 	if (!connected)
 		CL_RequestConnectInfo();
 
@@ -625,7 +625,7 @@ static void CL_SpawnMobj(const odaproto::svc::SpawnMobj* msg)
 
 	if (connected && (mo->flags & MF_MISSILE) && mo->info->seesound)
 	{
-		S_Sound(mo, CHAN_VOICE, mo->info->seesound, 1, ATTN_NORM);
+		S_MobjSound(mo, CHAN_VOICE, mo->info->seesound, mobjsounds[mo->type].see, 1, ATTN_NORM);
 	}
 
 	if (mo->type == MT_IFOG)
@@ -650,7 +650,10 @@ static void CL_SpawnMobj(const odaproto::svc::SpawnMobj* msg)
 	if (type == MT_ZDOOMBRIDGE)
 	{
 		if (msg->args_size() >= 1)
+		{
 			mo->radius = msg->args().Get(0) << FRACBITS;
+			mo->bmapnode.Refresh();
+		}
 		if (msg->args_size() >= 2)
 			mo->height = msg->args().Get(1) << FRACBITS;
 	}
@@ -1266,6 +1269,7 @@ static void CL_KillMobj(const odaproto::svc::KillMobj* msg)
 		target->x = msg->target().pos().x();
 		target->y = msg->target().pos().y();
 		target->z = msg->target().pos().z();
+		target->bmapnode.Refresh();
 		target->angle = msg->target().angle();
 		target->momx = msg->target().mom().x();
 		target->momy = msg->target().mom().y();
@@ -1339,6 +1343,7 @@ static void CL_UpdateSector(const odaproto::svc::UpdateSector* msg)
 	sector_t* sector = &::sectors[sectornum];
 	P_SetCeilingHeight(sector, ceilingheight);
 	P_SetFloorHeight(sector, floorheight);
+	P_SoundGraphSectorMoved(sector);
 
 	if (floorpic >= ::numflats)
 		floorpic = ::numflats;
@@ -2307,6 +2312,8 @@ static void CL_LineUpdate(const odaproto::svc::LineUpdate* msg)
 	line_t* line = &lines[linenum];
 	line->flags = flags;
 	line->lucency = lucency;
+
+	P_SoundGraphLinesChanged();
 }
 
 /**
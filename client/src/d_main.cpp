@@ -81,9 +81,11 @@
 #include "p_ctf.h"
 #include "cl_main.h"
 #include "g_mapinfo.h"
+#include "m_wdlstats.h"
 #include "g_horde.h"
 #include "w_ident.h"
 #include "gui_boot.h"
+#include "r_bench.h"
 
 #ifdef GEKKO
 #include "i_wii.h"
@@ -239,7 +241,7 @@ void D_DisplayTicker()
 //
 void D_Display()
 {
-	if (nodrawers || I_IsHeadless())
+	if (nodrawers || (I_IsHeadless() && !R_BenchActive()))
 		return; 				// for comparative timing / profiling
 
 	BEGIN_STAT(D_Display);
@@ -285,6 +287,8 @@ void D_Display()
 
 			// Drawn to R_GetRenderingSurface()
 			R_RenderPlayerView(&displayplayer());
+
+			R_BenchBeginPhase(RBP_HUD);
 			R_DrawViewBorder();
 			ST_Drawer();
 
@@ -298,6 +302,10 @@ void D_Display()
 			HU_Drawer();
 			C_DrawMid();
 			C_DrawGMid();
+			R_BenchEndPhase(RBP_HUD);
+
+			// checksum the finished view before any console/menu overlays
+			R_BenchFinishFrame(I_GetPrimarySurface());
 			break;
 
 		case GS_INTERMISSION:
@@ -879,6 +887,7 @@ void D_DoomMain()
 	// [SL] Call init routines that need to be reinitialized every time WAD changes
 	atterm(D_Shutdown);
 	D_Init();
+	atterm(M_ShutdownWDLLog);
 
 	atterm(I_Endoom);
 
@@ -997,6 +1006,9 @@ void D_DoomMain()
 		defdemoname = Args.GetArg(p+1);
 	}
 
+	// check for -renderbench, which runs the demo uncapped and logs frame timings
+	R_BenchInit();
+
 	// [SL] check for -timedemo (was removed at some point)
 	p = Args.CheckParm("-timedemo");
 	if (p && p < Args.NumArgs() - 1)
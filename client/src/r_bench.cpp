@@ -0,0 +1,218 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id$
+//
+// Copyright (C) 2006-2024 by The Odamex Team.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Headless renderer benchmark (-renderbench).
+//
+//	Usage:
+//	  odamex -renderbench -width 1920 -height 1080 -bits 32 -timedemo demo1
+//	  odamex -renderbench -bits 8 -netplay match.odd [-benchlog frames.csv]
+//
+//	The client runs with the offscreen video subsystem (no window, no GPU)
+//	and uncapped simulation. One CSV row is written per rendered level
+//	frame with the time spent in each renderer phase and a CRC32 of the
+//	finished framebuffer, and a summary is printed when the demo ends.
+//
+//-----------------------------------------------------------------------------
+
+#include "odamex.h"
+
+#include "r_bench.h"
+
+#include "crc32.h"
+#include "g_game.h"
+#include "i_system.h"
+#include "i_video.h"
+#include "m_argv.h"
+#include "m_fileio.h"
+
+static const char* phase_names[NUM_RENDERBENCH_PHASES] = {"bsp", "planes", "masked",
+                                                           "hud"};
+
+static bool bench_active = false;
+static FILE* bench_log = NULL;
+
+static dtime_t phase_start[NUM_RENDERBENCH_PHASES];
+static dtime_t frame_time[NUM_RENDERBENCH_PHASES];
+static dtime_t total_time[NUM_RENDERBENCH_PHASES];
+
+static unsigned int frame_count = 0;
+static dtime_t min_frame = 0, max_frame = 0;
+static uint32_t run_checksum = 0;
+
+//
+// R_BenchActive
+//
+bool R_BenchActive()
+{
+	return bench_active;
+}
+
+//
+// R_BenchInit
+//
+// Checks for -renderbench on the command line and prepares the per-frame
+// log. I_IsHeadless also checks for -renderbench so that the offscreen video
+// subsystem is selected by I_InitHardware.
+//
+void R_BenchInit()
+{
+	if (!Args.CheckParm("-renderbench"))
+		return;
+
+	bench_active = true;
+	timingdemo = true; // run the simulation uncapped
+
+	const char* logname = Args.CheckValue("-benchlog");
+	std::string filename = logname ? logname : M_GetUserFileName("renderbench.csv");
+
+	bench_log = fopen(filename.c_str(), "w");
+	if (bench_log == NULL)
+	{
+		Printf(PRINT_WARNING, "R_BenchInit: could not open %s for writing.\n",
+		       filename.c_str());
+	}
+	else
+	{
+		fprintf(bench_log, "frame,gametic");
+		for (int i = 0; i < NUM_RENDERBENCH_PHASES; i++)
+			fprintf(bench_log, ",%s_us", phase_names[i]);
+		fprintf(bench_log, ",checksum\n");
+		Printf(PRINT_HIGH, "R_BenchInit: logging frame timings to %s.\n",
+		       filename.c_str());
+	}
+
+	for (int i = 0; i < NUM_RENDERBENCH_PHASES; i++)
+		frame_time[i] = total_time[i] = 0;
+}
+
+//
+// R_BenchBeginPhase
+//
+void R_BenchBeginPhase(renderBenchPhase_t phase)
+{
+	if (bench_active)
+		phase_start[phase] = I_GetTime();
+}
+
+//
+// R_BenchEndPhase
+//
+void R_BenchEndPhase(renderBenchPhase_t phase)
+{
+	if (bench_active)
+		frame_time[phase] += I_GetTime() - phase_start[phase];
+}
+
+//
+// R_BenchFrameChecksum
+//
+// CRC32 of the visible pixels of the surface, ignoring any pitch padding.
+//
+static uint32_t R_BenchFrameChecksum(const IWindowSurface* surface)
+{
+	const int row_length = surface->getWidth() * surface->getBytesPerPixel();
+
+	uint32_t crc = 0;
+	for (int y = 0; y < surface->getHeight(); y++)
+		crc = crc32_fast(surface->getBuffer(0, y), row_length, crc);
+
+	return crc;
+}
+
+//
+// R_BenchFinishFrame
+//
+// Records the phase timings and framebuffer checksum for the frame that was
+// just drawn into surface.
+//
+void R_BenchFinishFrame(const IWindowSurface* surface)
+{
+	if (!bench_active || surface == NULL)
+		return;
+
+	const uint32_t checksum = R_BenchFrameChecksum(surface);
+	run_checksum = crc32_fast(&checksum, sizeof(checksum), run_checksum);
+
+	dtime_t frame_total = 0;
+	for (int i = 0; i < NUM_RENDERBENCH_PHASES; i++)
+	{
+		frame_total += frame_time[i];
+		total_time[i] += frame_time[i];
+	}
+
+	if (frame_count == 0 || frame_total < min_frame)
+		min_frame = frame_total;
+	if (frame_count == 0 || frame_total > max_frame)
+		max_frame = frame_total;
+
+	if (bench_log)
+	{
+		fprintf(bench_log, "%u,%d", frame_count, gametic);
+		for (int i = 0; i < NUM_RENDERBENCH_PHASES; i++)
+			fprintf(bench_log, ",%lld", (long long)(frame_time[i] / 1000LL));
+		fprintf(bench_log, ",%08x\n", checksum);
+	}
+
+	for (int i = 0; i < NUM_RENDERBENCH_PHASES; i++)
+		frame_time[i] = 0;
+
+	frame_count++;
+}
+
+//
+// R_BenchFinish
+//
+// Prints a summary of the run and closes the frame log. Called when the
+// benchmarked demo ends, just before the client quits.
+//
+void R_BenchFinish()
+{
+	if (!bench_active)
+		return;
+
+	bench_active = false;
+
+	if (bench_log)
+	{
+		fclose(bench_log);
+		bench_log = NULL;
+	}
+
+	const IWindowSurface* surface = I_GetPrimarySurface();
+	Printf(PRINT_HIGH, "renderbench: %u frames at %dx%dx%d\n", frame_count,
+	       surface ? surface->getWidth() : 0, surface ? surface->getHeight() : 0,
+	       surface ? surface->getBitsPerPixel() : 0);
+
+	if (frame_count == 0)
+		return;
+
+	dtime_t all_phases = 0;
+	for (int i = 0; i < NUM_RENDERBENCH_PHASES; i++)
+	{
+		all_phases += total_time[i];
+		Printf(PRINT_HIGH, "renderbench: %-6s %8.3f ms/frame\n", phase_names[i],
+		       double(total_time[i]) / (1000000.0 * frame_count));
+	}
+
+	Printf(PRINT_HIGH, "renderbench: total  %8.3f ms/frame (min %.3f, max %.3f)\n",
+	       double(all_phases) / (1000000.0 * frame_count), double(min_frame) / 1000000.0,
+	       double(max_frame) / 1000000.0);
+	Printf(PRINT_HIGH, "renderbench: checksum %08x\n", run_checksum);
+}
+
+VERSION_CONTROL (r_bench_cpp, "$Id$")
@@ -0,0 +1,46 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id$
+//
+// Copyright (C) 2006-2024 by The Odamex Team.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Headless renderer benchmark (-renderbench).
+//
+//	Plays back a vanilla demo (-timedemo) or netdemo (-netplay) while
+//	rendering every frame into an offscreen surface, recording the time
+//	spent in each renderer phase and a checksum of the finished frame.
+//
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+class IWindowSurface;
+
+enum renderBenchPhase_t
+{
+	RBP_BSP,
+	RBP_PLANES,
+	RBP_MASKED,
+	RBP_HUD,
+
+	NUM_RENDERBENCH_PHASES
+};
+
+bool R_BenchActive();
+void R_BenchInit();
+void R_BenchBeginPhase(renderBenchPhase_t phase);
+void R_BenchEndPhase(renderBenchPhase_t phase);
+void R_BenchFinishFrame(const IWindowSurface* surface);
+void R_BenchFinish();
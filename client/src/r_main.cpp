@@ -42,6 +42,7 @@
 #include "m_vectors.h"
 #include "am_map.h"
 #include "cl_demo.h"
+#include "r_bench.h"
 
 extern NetDemo netdemo;
 
@@ -1029,6 +1030,7 @@ void R_RenderPlayerView(player_t* player)
 
     // [Russell] - From zdoom 1.22 source, added camera pointer check
 	// Never draw the player unless in chasecam mode
+	R_BenchBeginPhase(RBP_BSP);
 	if (camera && camera->player && !(player->cheats & CF_CHASECAM))
 	{
 		int flags2_backup = camera->flags2;
@@ -1038,10 +1040,15 @@ void R_RenderPlayerView(player_t* player)
 	}
 	else
 		R_RenderBSPNode(numnodes - 1);	// The head node is the last node output.
+	R_BenchEndPhase(RBP_BSP);
 
+	R_BenchBeginPhase(RBP_PLANES);
 	R_DrawPlanes();
+	R_BenchEndPhase(RBP_PLANES);
 
+	R_BenchBeginPhase(RBP_MASKED);
 	R_DrawMasked();
+	R_BenchEndPhase(RBP_MASKED);
 
 	// NOTE(jsd): Full-screen status color blending:
 	int blend_alpha = int(blend_color.geta() * 255.0f);
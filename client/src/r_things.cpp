@@ -36,6 +36,7 @@
 #include "p_local.h"
 
 #include "c_console.h"
+#include "c_dispatch.h"
 
 #include "v_video.h"
 
@@ -213,7 +214,7 @@ void R_DrawVisSprite (vissprite_t *vis, int x1, int x2)
 	}
 
 	// [AM] Ensure that we're not going to fall off the side of the patch.
-	const short patchWidth = W_CachePatch(vis->patch, PU_CACHE)->width();
+	const short patchWidth = R_GetLevelPatch(vis->patch)->width();
 	const int start = vis->startfrac >> FRACBITS;
 	if (start < 0 || start > patchWidth)
 	{
@@ -873,17 +874,30 @@ void R_DrawPlayerSprites()
 //		more vissprites that need to be sorted, the better the performance
 //		gain compared to the old function.
 //
+// The qsort() has since been replaced with an LSD radix sort on a 64-bit key
+// built from the sprite's depth and gzt, which sorts in the same order as
+// the old comparator (depth ascending, then gzt descending) in linear time.
+//
 
 static int				vsprcount;
 static vissprite_t**	spritesorter;
 static int				spritesorter_size = 0;
 
-static int STACK_ARGS sv_compare(const void *arg1, const void *arg2)
+struct vsprsortkey_t
 {
-	int diff = (*(vissprite_t **)arg1)->depth - (*(vissprite_t **)arg2)->depth;
-	if (diff == 0)
-		return (*(vissprite_t **)arg2)->gzt - (*(vissprite_t **)arg1)->gzt;
-	return diff;
+	uint64_t		key;
+	vissprite_t*	spr;
+};
+
+static std::vector<vsprsortkey_t> sortkeys, sorttemp;
+
+static inline uint64_t R_VisSpriteSortKey(const vissprite_t* vis)
+{
+	// flip the sign bits so that the signed fixed_t values compare
+	// correctly as unsigned integers, and invert gzt to sort it descending
+	const uint32_t depth = uint32_t(vis->depth) ^ 0x80000000u;
+	const uint32_t gzt = ~(uint32_t(vis->gzt) ^ 0x80000000u);
+	return (uint64_t(depth) << 32) | gzt;
 }
 
 void R_SortVisSprites()
@@ -900,10 +914,145 @@ void R_SortVisSprites()
 		spritesorter_size = MaxVisSprites;
 	}
 
+	sortkeys.resize(vsprcount);
+	sorttemp.resize(vsprcount);
+
+	for (int i = 0; i < vsprcount; i++)
+	{
+		sortkeys[i].key = R_VisSpriteSortKey(vissprites + i);
+		sortkeys[i].spr = vissprites + i;
+	}
+
+	vsprsortkey_t* src = &sortkeys[0];
+	vsprsortkey_t* dest = &sorttemp[0];
+
+	// one pass per byte of the key, least significant first
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		int count[256] = { 0 };
+		for (int i = 0; i < vsprcount; i++)
+			count[(src[i].key >> shift) & 0xFF]++;
+
+		// every key has the same value for this byte
+		if (count[(src[0].key >> shift) & 0xFF] == vsprcount)
+			continue;
+
+		int offset = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			const int n = count[i];
+			count[i] = offset;
+			offset += n;
+		}
+
+		for (int i = 0; i < vsprcount; i++)
+			dest[count[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dest);
+	}
+
 	for (int i = 0; i < vsprcount; i++)
-		spritesorter[i] = vissprites + i;
+		spritesorter[i] = src[i].spr;
+}
+
+
+//
+// Drawseg index for sprite clipping
+//
+// R_DrawSprite only cares about drawsegs that have a silhouette or a masked
+// midtexture and that overlap the sprite horizontally. Before the masked
+// pass, those drawsegs are bucketed by the screen columns they cover so each
+// sprite only has to test the drawsegs in the buckets it touches instead of
+// every drawseg in the frame. All lists keep drawseg order so that sprites
+// are still clipped and masked midtextures rendered back to front.
+//
+
+static const int DSBUCKETSHIFT = 5;		// 32 columns per bucket
+static const int NUMDSBUCKETS = (MAXWIDTH >> DSBUCKETSHIFT) + 1;
+
+static std::vector<int> dsbuckets[NUMDSBUCKETS];
+static std::vector<int> dsclippers;		// every drawseg that can clip a sprite
+static std::vector<int> dscandidates;
+static std::vector<unsigned int> dsstamp;
+static unsigned int dsstampcount;
+
+// Statistics for the last masked pass (see the r_maskedstats command)
+static unsigned int masked_sprites;
+static unsigned int masked_drawsegs_tested;
+static dtime_t masked_time;
+
+static void R_BuildDrawSegIndex()
+{
+	const int numdrawsegs = ds_p - drawsegs;
+	const int numbuckets = (viewwidth >> DSBUCKETSHIFT) + 1;
+
+	for (int b = 0; b < numbuckets; b++)
+		dsbuckets[b].clear();
+	dsclippers.clear();
+
+	if (dsstamp.size() < (size_t)numdrawsegs)
+		dsstamp.resize(numdrawsegs, dsstampcount);
+
+	for (int i = 0; i < numdrawsegs; i++)
+	{
+		const drawseg_t* ds = drawsegs + i;
+		if (!(ds->silhouette & SIL_BOTH) && !ds->midposts)
+			continue;
+
+		dsclippers.push_back(i);
+
+		const int b1 = MAX<int>(ds->x1, 0) >> DSBUCKETSHIFT;
+		const int b2 = MIN<int>(ds->x2 >> DSBUCKETSHIFT, numbuckets - 1);
+		for (int b = b1; b <= b2; b++)
+			dsbuckets[b].push_back(i);
+	}
+}
+
+//
+// R_GetSpriteClipSegs
+//
+// Returns the indices of the drawsegs that may clip a sprite spanning
+// columns x1 through x2, in drawseg order.
+//
+static const std::vector<int>& R_GetSpriteClipSegs(int x1, int x2)
+{
+	const int b1 = x1 >> DSBUCKETSHIFT;
+	const int b2 = x2 >> DSBUCKETSHIFT;
+
+	if (b1 == b2)
+		return dsbuckets[b1];
+
+	size_t total = 0;
+	for (int b = b1; b <= b2; b++)
+		total += dsbuckets[b].size();
+
+	// wide sprites close to the view are cheaper to test against everything
+	if (total >= dsclippers.size())
+		return dsclippers;
+
+	// merge the buckets, skipping drawsegs that span more than one of them
+	if (++dsstampcount == 0)
+	{
+		std::fill(dsstamp.begin(), dsstamp.end(), 0);
+		dsstampcount = 1;
+	}
 
-	qsort(spritesorter, vsprcount, sizeof(vissprite_t *), sv_compare);
+	dscandidates.clear();
+	for (int b = b1; b <= b2; b++)
+	{
+		for (size_t i = 0; i < dsbuckets[b].size(); i++)
+		{
+			const int index = dsbuckets[b][i];
+			if (dsstamp[index] != dsstampcount)
+			{
+				dsstamp[index] = dsstampcount;
+				dscandidates.push_back(index);
+			}
+		}
+	}
+
+	std::sort(dscandidates.begin(), dscandidates.end());
+	return dscandidates;
 }
 
 
@@ -980,13 +1129,15 @@ void R_DrawSprite (vissprite_t *spr)
 
 	// Scan drawsegs from end to start for obscuring segs.
 	// The first drawseg that has a greater scale is the clip seg.
+	// Only the drawsegs in the index buckets covering the sprite are checked.
 
-	// Modified by Lee Killough:
-	// (pointer check was originally nonportable
-	// and buggy, by going past LEFT end of array):
+	const std::vector<int>& clipsegs = R_GetSpriteClipSegs(spr->x1, spr->x2);
+	masked_drawsegs_tested += clipsegs.size();
 
-	for (ds = ds_p ; ds-- > drawsegs ; )  // new -- killough
+	for (size_t n = clipsegs.size(); n-- > 0; )
 	{
+		ds = drawsegs + clipsegs[n];
+
 		// determine if the drawseg obscures the sprite
 		if (ds->x1 > spr->x2 || ds->x2 < spr->x1 ||
 			(!(ds->silhouette & SIL_BOTH) && !ds->midposts) )
@@ -1046,7 +1197,13 @@ void R_DrawMasked (void)
 {
 	drawseg_t		 *ds;
 
+	const dtime_t start_time = I_GetTime();
+
 	R_SortVisSprites ();
+	R_BuildDrawSegIndex ();
+
+	masked_sprites = vsprcount;
+	masked_drawsegs_tested = 0;
 
 	while (vsprcount > 0)
 		R_DrawSprite(spritesorter[--vsprcount]);
@@ -1065,7 +1222,20 @@ void R_DrawMasked (void)
 
 	// draw the psprites on top of everything
 	R_DrawPlayerSprites();
+
+	masked_time = I_GetTime() - start_time;
+}
+
+
+BEGIN_COMMAND(r_maskedstats)
+{
+	Printf(PRINT_HIGH, "sprites: %u\n", masked_sprites);
+	Printf(PRINT_HIGH, "drawsegs: %d (%u can clip sprites)\n",
+			int(ds_p - drawsegs), (unsigned int)dsclippers.size());
+	Printf(PRINT_HIGH, "drawsegs tested: %u\n", masked_drawsegs_tested);
+	Printf(PRINT_HIGH, "masked pass: %.3f ms\n", double(masked_time) / 1000000.0);
 }
+END_COMMAND(r_maskedstats)
 
 void R_InitParticles (void)
 {
@@ -749,20 +749,39 @@ void S_LoopedSoundID(fixed_t *pt, int channel, int sound_id, float volume, int a
 	S_StartSound(pt, 0, 0, channel, sound_id, volume, attenuation, true);
 }
 
-static void S_StartNamedSound(AActor *ent, fixed_t *pt, fixed_t x, fixed_t y, int channel,
-                              const char *name, float volume, int attenuation, bool looping)
+//
+// S_SoundSilenced
+//
+// Sounds are not started before the console player has spawned (apart from
+// interface sounds) or from things in silent sectors.
+//
+static bool S_SoundSilenced(AActor *ent, int channel)
 {
 	if (!consoleplayer().mo && channel != CHAN_INTERFACE)
-		return;
+		return true;
 
+	return ent && ent != (AActor *)(~0) && ent->subsector && ent->subsector->sector &&
+	       ent->subsector->sector->MoreFlags & SECF_SILENT;
+}
+
+static void S_StartSoundFrom(AActor *ent, fixed_t *pt, fixed_t x, fixed_t y, int channel,
+                             int sfx_id, float volume, int attenuation, bool looping)
+{
+	if (ent && ent != (AActor *)(~0))
+		S_StartSound(&ent->x, x, y, channel, sfx_id, volume, attenuation, looping);
+	else if (pt)
+		S_StartSound(pt, x, y, channel, sfx_id, volume, attenuation, looping);
+	else
+		S_StartSound((fixed_t *)ent, x, y, channel, sfx_id, volume, attenuation, looping);
+}
+
+static void S_StartNamedSound(AActor *ent, fixed_t *pt, fixed_t x, fixed_t y, int channel,
+                              const char *name, float volume, int attenuation, bool looping)
+{
 	const std::string soundname = name ? name : "";
 
-	if (soundname.empty() ||
-			(ent && ent != (AActor *)(~0) && ent->subsector && ent->subsector->sector &&
-			ent->subsector->sector->MoreFlags & SECF_SILENT))
-	{
+	if (soundname.empty() || S_SoundSilenced(ent, channel))
 		return;
-	}
 
 	int sfx_id = -1;
 
@@ -802,12 +821,7 @@ static void S_StartNamedSound(AActor *ent, fixed_t *pt, fixed_t x, fixed_t y, in
 		return;
 	}
 
-	if (ent && ent != (AActor *)(~0))
-		S_StartSound(&ent->x, x, y, channel, sfx_id, volume, attenuation, looping);
-	else if (pt)
-		S_StartSound(pt, x, y, channel, sfx_id, volume, attenuation, looping);
-	else
-		S_StartSound((fixed_t *)ent, x, y, channel, sfx_id, volume, attenuation, looping);
+	S_StartSoundFrom(ent, pt, x, y, channel, sfx_id, volume, attenuation, looping);
 }
 
 // [Russell] - Hack to stop multiple plat stop sounds
@@ -838,6 +852,26 @@ void S_Sound(fixed_t *pt, int channel, const char *name, float volume, int atten
 	S_StartNamedSound(NULL, pt, 0, 0, channel, name, volume, attenuation, false);
 }
 
+void S_SoundHandle(int channel, int sfx_id, float volume, int attenuation)
+{
+	// full volume regardless of location, like S_Sound(channel, name)
+	if (sfx_id == -1 || S_SoundSilenced(NULL, channel))
+		return;
+
+	S_StartSoundFrom(NULL, NULL, 0, 0, channel, sfx_id, volume, ATTN_NONE, false);
+}
+
+void S_SoundHandle(AActor *ent, int channel, int sfx_id, float volume, int attenuation)
+{
+	if(!co_globalsound && channel == CHAN_ITEM && ent != listenplayer().camera)
+		return;
+
+	if (sfx_id == -1 || S_SoundSilenced(ent, channel))
+		return;
+
+	S_StartSoundFrom(ent, NULL, 0, 0, channel, sfx_id, volume, attenuation, false);
+}
+
 void S_LoopedSound(AActor *ent, int channel, const char *name, float volume, int attenuation)
 {
 	S_StartNamedSound(ent, NULL, 0, 0, channel, name, volume, attenuation, true);
@@ -1457,6 +1491,7 @@ void S_ParseSndInfo()
 		}
 	}
 	S_HashSounds();
+	S_InternMobjSounds();
 
 	sfx_empty = W_CheckNumForName("dsempty");
 	sfx_noway = S_FindSoundByLump(W_CheckNumForName("dsnoway"));
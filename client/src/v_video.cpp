@@ -639,6 +639,23 @@ struct frametimeGraph_t
 	}
 } g_GraphData;
 
+//
+// V_PresentStatsString
+//
+// Time the main thread spent presenting the last frame, and how long it took
+// a frame to reach the screen (with vid_pipelinepresent, the frame before).
+//
+static void V_PresentStatsString(std::string& buffer)
+{
+	static const double ONE_MS = double(I_ConvertTimeFromMs(1));
+
+	const IWindow* window = I_GetWindow();
+	const double present_ms = window ? window->getPresentTime() / ONE_MS : 0.0;
+	const double latency_ms = window ? window->getPresentLatency() / ONE_MS : 0.0;
+
+	StrFormat(buffer, "PRS %4.1f LAT %4.1f", present_ms, latency_ms);
+}
+
 //
 // V_DrawFPSWidget
 //
@@ -750,6 +767,10 @@ void V_DrawFPSWidget()
 		// FPS counter
 		StrFormat(buffer, "FPS %5.1f", last_fps);
 		screen->PrintStr(graphBox.min.x, graphBox.max.y + 1, buffer.c_str());
+
+		// Present stall and latency
+		V_PresentStatsString(buffer);
+		screen->PrintStr(graphBox.min.x, graphBox.max.y + 9, buffer.c_str());
 	}
 	else if (vid_displayfps.asInt() == FPS_COUNTER)
 	{
@@ -771,6 +792,9 @@ void V_DrawFPSWidget()
 		std::string buffer;
 		StrFormat(buffer, "FPS %5.1f", last_fps);
 		screen->PrintStr(botleft.x, botleft.y + 1, buffer.c_str());
+
+		V_PresentStatsString(buffer);
+		screen->PrintStr(botleft.x, botleft.y + 9, buffer.c_str());
 	}
 }
 
@@ -364,6 +364,12 @@ class AActor : public DThinker
 
 		AActorPtrCounted() {}
 
+		AActorPtrCounted(const AActorPtrCounted &other) : ptr(other.ptr)
+		{
+			if(ptr)
+				ptr->refCount++;
+		}
+
 		AActorPtr &operator= (AActorPtr other)
 		{
 			if(ptr)
@@ -509,6 +515,7 @@ public:
 	byte			args[5];		// special arguments
 
 	AActor			*inext, *iprev;	// Links to other mobjs in same bucket
+	AActor			*tnext, *tprev;	// Links to other mobjs of the same type
 
 	// denis - playerids of players to whom this object has been sent
 	// [SL] changed to use a bitfield instead of a vector for O(1) lookups
@@ -525,6 +532,13 @@ public:
 	// a linked list of sectors where this object appears
 	struct msecnode_s	*touching_sectorlist;				// phares 3/14/98
 
+	// position, radius and geometry generation touching_sectorlist was
+	// built for, so relinking in place can keep the list as it is
+	fixed_t			secnodex;
+	fixed_t			secnodey;
+	fixed_t			secnoderadius;
+	unsigned int	secnodegen;
+
 	short           deadtic;        // tics after player's death
 	int             oldframe;
 
@@ -539,6 +553,13 @@ public:
 	AActor *FindGoal (int tid, int kind) const;
 	static AActor *FindGoal (const AActor *first, int tid, int kind);
 
+	// Per-type actor lists, kept in spawn order
+	static void ClearTypeLists ();
+	void AddToTypeList ();
+	void RemoveFromTypeList ();
+	static AActor *FirstOfType (mobjtype_t kind);
+	static int CountOfType (mobjtype_t kind);
+
 	uint32_t		netid;          // every object has its own netid
 	short			tid;			// thing identifier
 	baseline_t		baseline;		// Baseline data for mobj sent to clients
@@ -550,6 +571,10 @@ private:
 	static AActor *TIDHash[TIDHashSize];
 	static inline int TIDHASH (int key) { return key & TIDHashMask; }
 
+	static AActor *TypeListHead[NUMMOBJTYPES];
+	static AActor *TypeListTail[NUMMOBJTYPES];
+	static int TypeListCount[NUMMOBJTYPES];
+
 	friend class FActorIterator;
 
 public:
@@ -574,7 +599,9 @@ public:
 		ActorBlockMapListNode(AActor *mo);
 		void Link();
 		void Unlink();
+		void Refresh();
 		AActor* Next(int bmx, int bmy);
+		void SetSlot(int bmx, int bmy, size_t index);
 
 	private:
 		void clear();
@@ -596,6 +623,9 @@ public:
 		// this actor can inhabit
 		AActor		*next[BLOCKSX * BLOCKSY];
 		AActor		**prev[BLOCKSX * BLOCKSY];
+
+		// where this actor's record is in each block's thing records
+		size_t		slot[BLOCKSX * BLOCKSY];
 	};
 	
 	ActorBlockMapListNode bmapnode;
@@ -629,6 +659,39 @@ private:
 };
 
 
+//
+// FActorTypeIterator
+//
+// Iterates over all of the actors of one type in spawn order without walking
+// the whole thinker list. Destroying the actor last returned by Next() ends
+// the iteration.
+//
+class FActorTypeIterator
+{
+public:
+	FActorTypeIterator (mobjtype_t kind) : base (NULL), kind (kind), started (false)
+	{
+	}
+	AActor *Next ()
+	{
+		if (!started)
+		{
+			base = AActor::FirstOfType(kind);
+			started = true;
+		}
+		else if (base)
+		{
+			base = base->tnext;
+		}
+
+		return base;
+	}
+private:
+	AActor *base;
+	mobjtype_t kind;
+	bool started;
+};
+
 template<class T>
 class TActorIterator : public FActorIterator
 {
@@ -389,6 +389,10 @@ CVAR_RANGE_FUNC_DECL(sv_splashfactor, "1.0", "Rocket explosion thrust effect?",
 					CVARTYPE_FLOAT, CVAR_ARCHIVE | CVAR_SERVERINFO | CVAR_NOENABLEDISABLE,
 					0.01f, 100.0f)
 
+CVAR(				sv_splashbatching, "0",
+					"Apply all of a tic's explosions together at the end of the tic (not vanilla)",
+					CVARTYPE_BOOL, CVAR_ARCHIVE | CVAR_SERVERINFO)
+
 CVAR(               cl_waddownloaddir, "", "Set custom WAD download directory",
 					CVARTYPE_STRING, CVAR_CLIENTARCHIVE | CVAR_NOENABLEDISABLE)
 
@@ -423,6 +427,15 @@ CVAR(				lookspring, "1", "Generate centerview when mlook encountered",
 CVAR(				waddirs, "", "Allow custom WAD directories to be specified",
 					CVARTYPE_STRING, CVAR_ARCHIVE | CVAR_NOENABLEDISABLE)
 
+CVAR(				p_parallelthinkers, "0",
+					"Run lighting and texture scrolling thinkers on worker threads",
+					CVARTYPE_BOOL, CVAR_ARCHIVE)
+
+CVAR(				p_mapcache, "0",
+					"Save the processed geometry of each map loaded to the user directory and " \
+					"load it from there the next time",
+					CVARTYPE_BOOL, CVAR_ARCHIVE)
+
 CVAR_RANGE_FUNC_DECL(net_rcvbuf, "131072", "Net receive buffer size in bytes",
 					CVARTYPE_INT, CVAR_ARCHIVE | CVAR_NOENABLEDISABLE,
 					1500.0f, 256.0f * 1024.0f * 1024.0f)
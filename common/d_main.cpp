@@ -652,6 +652,17 @@ void D_LoadResourceFiles(const OWantFiles& newwadfiles, const OWantFiles& newpat
 	::missingfiles.clear();
 	::missingCommercialIWAD = false;
 
+	// Hash everything we are about to resolve in one parallel batch.
+	OWantFiles wanted(newwadfiles);
+	wanted.insert(wanted.end(), newpatchfiles.begin(), newpatchfiles.end());
+	if (::wadfiles.empty())
+	{
+		OWantFile want_odamex;
+		OWantFile::make(want_odamex, "odamex.wad", OFILE_WAD);
+		wanted.push_back(want_odamex);
+	}
+	M_PrehashWantedFiles(wanted);
+
 	// Resolve wanted wads.
 	OResFiles resolved_wads;
 	resolved_wads.reserve(newwadfiles.size());
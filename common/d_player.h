@@ -405,7 +405,69 @@ typedef player_s player_t;
 typedef player_t::client_t client_t;
 
 // Bookkeeping on players - state.
-typedef std::list<player_t> Players;
+//
+// The players list keeps an id-indexed table of pointers into itself so that
+// idplayer() does not have to walk the list.  Elements of a std::list never
+// move, so entries only need to be dropped when players are removed; an entry
+// whose player has since been given a different id is caught by checking the
+// id on lookup and falls back to a search.
+//
+// generation() changes whenever players are added or removed, for other
+// indexes over the list (such as the server's address lookup) to notice.
+class Players : public std::list<player_t>
+{
+  public:
+	Players() : m_generation(0) { clearIndex(); }
+	Players(const Players& other) : std::list<player_t>(other), m_generation(0)
+	{
+		clearIndex();
+	}
+	Players& operator=(const Players& other)
+	{
+		std::list<player_t>::operator=(other);
+		clearIndex();
+		return *this;
+	}
+
+	iterator erase(iterator it)
+	{
+		clearIndex();
+		return std::list<player_t>::erase(it);
+	}
+	iterator erase(iterator first, iterator last)
+	{
+		clearIndex();
+		return std::list<player_t>::erase(first, last);
+	}
+	void clear()
+	{
+		clearIndex();
+		std::list<player_t>::clear();
+	}
+	void resize(size_type count)
+	{
+		clearIndex();
+		std::list<player_t>::resize(count);
+	}
+	void push_back(const player_t& player)
+	{
+		m_generation++;
+		std::list<player_t>::push_back(player);
+	}
+
+	player_t* lookup(byte id);
+	unsigned int generation() const { return m_generation; }
+
+  private:
+	void clearIndex()
+	{
+		memset(m_index, 0, sizeof(m_index));
+		m_generation++;
+	}
+
+	player_t* m_index[256];
+	unsigned int m_generation;
+};
 extern Players players;
 
 // Player taking events, and displaying.
@@ -52,6 +52,9 @@ void DSectorEffect::Destroy ()
 			m_Sector->ceilingdata = NULL;
 		if (m_Sector->lightingdata == this)
 			m_Sector->lightingdata = NULL;
+
+		// Scripts waiting for this sector's tag can check again
+		P_WakeTagWaiters(m_Sector->tag);
 	}
 
 	Super::Destroy();
@@ -63,6 +63,14 @@ public:
 	virtual ~DThinker ();
 	virtual void RunThink () {}
 
+	// Thinkers that only touch their own state and a single sector or
+	// sidedef can be run in parallel with the neighbouring thinkers in the
+	// list that can too.  They return a key identifying what they touch (a
+	// sector number, or numsectors plus a sidedef number) and thinkers with
+	// the same key are run in list order on the same thread.  Everything
+	// else returns -1 and is always run serially.
+	virtual int ParallelKey () const { return -1; }
+
 	void *operator new (size_t size);
 	void operator delete (void *block);
 
@@ -70,6 +78,7 @@ public:
 	static DThinker *FirstThinker;
 	static DThinker *LastThinker;
 	static void RunThinkers ();
+	static void RunParallelThinkers ();
 	static void DestroyAllThinkers ();
 	static void DestroyMostThinkers ();
 	static void SerializeAll (FArchive &arc, bool keepPlayers);
@@ -31,6 +31,7 @@
 #include "m_fixed.h"
 #include "info.h"
 #include "actor.h"
+#include "s_sound.h"
 
 const char *sprnames[NUMSPRITES+1] = {
 	"TROO","SHTG","PUNG","PISG","PISF","SHTF","SHT2","CHGG","CHGF","MISG",
@@ -1333,6 +1334,9 @@ state_t odastates[NUMSTATES - S_GIB0] = {
 // frame list size to the end of the doom states to get the odamex states.
 state_t states[NUMSTATES] = {};
 
+// filled in by S_InternMobjSounds
+mobjsounds_t mobjsounds[NUMMOBJTYPES];
+
 mobjinfo_t mobjinfo[NUMMOBJTYPES] = {
 
 	{		// MT_PLAYER
@@ -9220,4 +9224,91 @@ void D_Init_DEHEXTRA_Frames(void)
 	}
 }
 
+//
+// S_InternVariant
+//
+// Looks up name with its last character replaced by variant.
+//
+static int S_InternVariant(const char* name, char variant)
+{
+	char sound[MAX_SNDNAME + 1];
+
+	strncpy(sound, name, MAX_SNDNAME);
+	sound[MAX_SNDNAME] = 0;
+	sound[strlen(sound) - 1] = variant;
+
+	return S_FindSound(sound);
+}
+
+static int S_InternSound(const char* name)
+{
+	// Player sounds are resolved per player by S_MobjSound
+	if (name == NULL || name[0] == '*')
+		return -1;
+
+	return S_FindSound(name);
+}
+
+//
+// S_InternMobjSounds
+//
+// Resolves the sound names of every mobjinfo entry to S_sfx ids. Called
+// once SNDINFO has been loaded, by which point any DeHackEd patches have
+// already replaced the names.
+//
+void S_InternMobjSounds()
+{
+	for (int i = 0; i < NUMMOBJTYPES; i++)
+	{
+		const mobjinfo_t* info = &mobjinfo[i];
+		mobjsounds_t* sounds = &mobjsounds[i];
+
+		sounds->see = S_InternSound(info->seesound);
+		sounds->attack = S_InternSound(info->attacksound);
+		sounds->pain = S_InternSound(info->painsound);
+		sounds->active = S_InternSound(info->activesound);
+		sounds->death = S_InternSound(info->deathsound);
+		sounds->rip = S_InternSound(info->ripsound);
+
+		// A see sound ending in 1 has up to three variants, with any missing
+		// variant falling back to the first.
+		const char* see = info->seesound;
+		sounds->numseevariants = 1;
+		for (int v = 0; v < 3; v++)
+			sounds->seevariants[v] = sounds->see;
+
+		if (see && *see && see[strlen(see) - 1] == '1')
+		{
+			sounds->numseevariants = 3;
+			for (int v = 1; v < 3; v++)
+			{
+				const int id = S_InternVariant(see, '1' + v);
+				if (id != -1)
+					sounds->seevariants[v] = id;
+			}
+		}
+
+		// The zombiemen and imps pick one of their death sounds at random.
+		const char* death = info->deathsound;
+		sounds->numdeathvariants = 1;
+		for (int v = 0; v < 3; v++)
+			sounds->deathvariants[v] = sounds->death;
+
+		if (death == NULL)
+			continue;
+
+		if (stricmp(death, "grunt/death1") == 0 || stricmp(death, "shotguy/death1") == 0 ||
+		    stricmp(death, "chainguy/death1") == 0)
+			sounds->numdeathvariants = 3;
+		else if (stricmp(death, "imp/death1") == 0 || stricmp(death, "imp/death2") == 0)
+			sounds->numdeathvariants = 2;
+
+		if (sounds->numdeathvariants > 1)
+		{
+			for (int v = 0; v < sounds->numdeathvariants; v++)
+				sounds->deathvariants[v] = S_InternVariant(death, '1' + v);
+		}
+	}
+}
+
 VERSION_CONTROL (info_cpp, "$Id$")
@@ -1731,6 +1731,27 @@ typedef struct
 
 extern mobjinfo_t mobjinfo[NUMMOBJTYPES];
 
+// S_sfx ids of a mobjinfo entry's sounds, -1 where there is none. These
+// are interned by S_InternMobjSounds whenever SNDINFO is loaded, so the
+// action functions never look a sound up by name.
+typedef struct
+{
+	int see;
+	int attack;
+	int pain;
+	int death;
+	int active;
+	int rip;
+
+	// the random see and death sound variants A_Look and A_Scream pick from
+	int seevariants[3];
+	int deathvariants[3];
+	byte numseevariants;
+	byte numdeathvariants;
+} mobjsounds_t;
+
+extern mobjsounds_t mobjsounds[NUMMOBJTYPES];
+
 inline FArchive &operator<< (FArchive &arc, mobjinfo_t *info)
 {
 	if (info)
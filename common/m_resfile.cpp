@@ -254,6 +254,28 @@ std::vector<std::string> M_FileSearchDirs()
 	return dirs;
 }
 
+/**
+ * @brief Get the base filename and the extensions to search for when
+ *        resolving a wanted file.
+ */
+static void WantedFileExts(const OWantFile& wanted, std::string& basename,
+                           std::vector<std::string>& exts)
+{
+	std::string strext;
+	std::string path = M_CleanPath(wanted.getWantedPath());
+	M_ExtractFileBase(path, basename);
+	if (M_ExtractFileExtension(path, strext))
+	{
+		exts.push_back("." + strext);
+	}
+	else
+	{
+		const std::vector<std::string>& ftexts = M_FileTypeExts(wanted.getWantedType());
+		exts.insert(exts.end(), ftexts.begin(), ftexts.end());
+	}
+	std::unique(exts.begin(), exts.end());
+}
+
 /**
  * @brief Resolve an OResFile given a filename.
  *
@@ -283,21 +305,9 @@ bool M_ResolveWantedFile(OResFile& out, const OWantFile& wanted)
 		// Not a match, keep trying.
 	}
 
-	std::string dir, basename, strext;
+	std::string basename;
 	std::vector<std::string> exts;
-	std::string path = M_CleanPath(wanted.getWantedPath());
-	M_ExtractFilePath(path, dir);
-	M_ExtractFileBase(path, basename);
-	if (M_ExtractFileExtension(path, strext))
-	{
-		exts.push_back("." + strext);
-	}
-	else
-	{
-		const std::vector<std::string>& ftexts = M_FileTypeExts(wanted.getWantedType());
-		exts.insert(exts.end(), ftexts.begin(), ftexts.end());
-	}
-	std::unique(exts.begin(), exts.end());
+	WantedFileExts(wanted, basename, exts);
 
 	// And now...we resolve.
 	const std::vector<std::string> dirs = M_FileSearchDirs();
@@ -318,6 +328,60 @@ bool M_ResolveWantedFile(OResFile& out, const OWantFile& wanted)
 	return false;
 }
 
+/**
+ * @brief Hash the files that resolving a set of wanted files would hash.
+ *
+ * @detail M_ResolveWantedFile hashes candidates one at a time as it finds
+ *         them.  Calling this first finds the same candidates without
+ *         hashing them, and hashes them all at once on the worker pool, so
+ *         resolving afterwards only hits the hash cache.
+ *
+ * @param wanted Wanted files that are about to be resolved.
+ */
+void M_PrehashWantedFiles(const OWantFiles& wanted)
+{
+	std::vector<std::string> paths;
+	const std::vector<std::string> dirs = M_FileSearchDirs();
+
+	for (OWantFiles::const_iterator it = wanted.begin(); it != wanted.end(); ++it)
+	{
+		if (M_FileExists(it->getWantedPath()))
+		{
+			paths.push_back(it->getWantedPath());
+			if (it->getWantedMD5().empty())
+				continue;
+		}
+
+		std::string basename;
+		std::vector<std::string> exts;
+		WantedFileExts(*it, basename, exts);
+
+		std::vector<OString> names;
+		for (size_t i = 0; i < exts.size(); i++)
+		{
+			if (!it->getWantedMD5().empty())
+			{
+				names.push_back(basename + "." +
+				                it->getWantedMD5().getHexStr().substr(0, 6) + exts[i]);
+			}
+			names.push_back(basename + exts[i]);
+		}
+
+		for (size_t i = 0; i < dirs.size(); i++)
+		{
+			const std::vector<std::string> files = M_BaseFilesScanDir(dirs[i], names);
+			for (size_t j = 0; j < files.size(); j++)
+				paths.push_back(dirs[i] + PATHSEP + files[j]);
+
+			// Without a hash, the first directory with a match wins
+			if (!files.empty() && it->getWantedMD5().empty())
+				break;
+		}
+	}
+
+	W_HashFiles(paths);
+}
+
 static bool ScanIWADCmp(const scannedIWAD_t& a, const scannedIWAD_t& b)
 {
 	return a.id->weight < b.id->weight;
@@ -339,31 +403,38 @@ std::vector<scannedIWAD_t> M_ScanIWADs()
 	std::vector<scannedIWAD_t> rvo;
 	OHashTable<OCRC32Sum, bool> found;
 
+	std::vector<std::string> fullpaths;
 	for (size_t i = 0; i < dirs.size(); i++)
 	{
 		std::vector<std::string> files = M_BaseFilesScanDir(dirs[i], iwads);
 		for (size_t j = 0; j < files.size(); j++)
-		{
-			const std::string fullpath = dirs[i] + PATHSEP + files[j];
+			fullpaths.push_back(dirs[i] + PATHSEP + files[j]);
+	}
 
-			// Check to see if we got a real IWAD.
-			const OCRC32Sum crc32 = W_CRC32(fullpath);
-			if (crc32.empty())
-				continue;
+	// Hash every candidate up front, so they are hashed in parallel
+	W_HashFiles(fullpaths);
 
-			// Found a dupe?
-			if (found.find(crc32) != found.end())
-				continue;
+	for (size_t i = 0; i < fullpaths.size(); i++)
+	{
+		const std::string& fullpath = fullpaths[i];
 
-			// Does the gameinfo exist?
-			const fileIdentifier_t* id = W_GameInfo(crc32);
-			if (id == NULL)
-				continue;
+		// Check to see if we got a real IWAD.
+		const OCRC32Sum crc32 = W_CRC32(fullpath);
+		if (crc32.empty())
+			continue;
 
-			scannedIWAD_t iwad = {fullpath, id};
-			rvo.push_back(iwad);
-			found[crc32] = true;
-		}
+		// Found a dupe?
+		if (found.find(crc32) != found.end())
+			continue;
+
+		// Does the gameinfo exist?
+		const fileIdentifier_t* id = W_GameInfo(crc32);
+		if (id == NULL)
+			continue;
+
+		scannedIWAD_t iwad = {fullpath, id};
+		rvo.push_back(iwad);
+		found[crc32] = true;
 	}
 
 	// Sort the results by weight.
@@ -139,5 +139,6 @@ std::string M_ResFilesToString(const OResFiles& files);
 const std::vector<std::string>& M_FileTypeExts(ofile_t type);
 std::vector<std::string> M_FileSearchDirs();
 bool M_ResolveWantedFile(OResFile& out, const OWantFile& wanted);
+void M_PrehashWantedFiles(const OWantFiles& wanted);
 std::vector<scannedIWAD_t> M_ScanIWADs();
 std::vector<scannedPWAD_t> M_ScanPWADs();
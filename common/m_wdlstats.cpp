@@ -21,6 +21,7 @@
 //
 //-----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <ctime>
 
 #include "odamex.h"
@@ -75,6 +76,9 @@ static struct WDLState
 
 	// [Blair] Toggle for whether that recording has playerbeacons enabled.
 	bool enablebeacons;
+
+	// Write events in the compact binary format instead of text.
+	bool binary;
 } wdlstate;
 
 // A single tracked player
@@ -152,10 +156,57 @@ struct WDLEvent
 	int arg3;
 };
 
-// Events that we're keeping track of.
+// Events of the current tic, which can still be merged into.
 typedef std::vector<WDLEvent> WDLEventLog;
 static WDLEventLog wdlevents;
 
+// Finished events waiting to be written, also kept as a short history for
+// wdlinfo after they are written.
+static const unsigned int WDL_RING_SIZE = 4096;
+
+// Most events written out per tic.
+static const unsigned int WDL_FLUSH_BATCH = 512;
+
+// Bytes of the event spool copied into a committed log per tic.
+static const size_t WDL_COPY_CHUNK = 64 * 1024;
+
+// Events are streamed to a spool file during play, so that committing a log
+// only has to write the header and then append the spool a chunk at a time.
+static struct WDLStream
+{
+	WDLEvent ring[WDL_RING_SIZE];
+
+	// Absolute event numbers of the next event to go into the ring and the
+	// next event to be written out.
+	unsigned int head;
+	unsigned int tail;
+
+	FILE* spool;
+	std::string spoolname;
+
+	// Format of the log being recorded.
+	bool binary;
+
+	// Gametic of the last binary event, they are delta coded.
+	int lastgametic;
+
+	// Events written synchronously because the ring was full.
+	unsigned int late;
+
+	// Events lost because the spool could not be written to.
+	unsigned int dropped;
+} wdlstream;
+
+// A committed log that is still having its events appended.
+static struct WDLFinalize
+{
+	FILE* spool;
+	FILE* out;
+	std::string spoolname;
+	std::string partname;
+	std::string filename;
+} wdlfinal;
+
 // Turn an event enum into a string.
 //static const char* WDLEventString(WDLEvents i)
 //{
@@ -164,6 +215,176 @@ static WDLEventLog wdlevents;
 //	return ::wdlevstrings[i];
 //}
 
+static void WriteVarInt(FILE* fh, int value)
+{
+	// Zigzag so small negative numbers stay small.
+	unsigned int v = (static_cast<unsigned int>(value) << 1) ^
+	                 static_cast<unsigned int>(value >> 31);
+
+	byte buf[5];
+	size_t len = 0;
+
+	while (v >= 0x80)
+	{
+		buf[len++] = static_cast<byte>(v | 0x80);
+		v >>= 7;
+	}
+	buf[len++] = static_cast<byte>(v);
+
+	fwrite(buf, 1, len, fh);
+}
+
+static void WriteWDLEvent(FILE* fh, const WDLEvent& evt)
+{
+	if (::wdlstream.binary)
+	{
+		WriteVarInt(fh, evt.ev);
+		WriteVarInt(fh, evt.activator);
+		WriteVarInt(fh, evt.target);
+		WriteVarInt(fh, evt.gametic - ::wdlstream.lastgametic);
+		for (int i = 0; i < 3; i++)
+			WriteVarInt(fh, evt.apos[i]);
+		for (int i = 0; i < 3; i++)
+			WriteVarInt(fh, evt.tpos[i]);
+		WriteVarInt(fh, evt.arg0);
+		WriteVarInt(fh, evt.arg1);
+		WriteVarInt(fh, evt.arg2);
+		WriteVarInt(fh, evt.arg3);
+
+		::wdlstream.lastgametic = evt.gametic;
+		return;
+	}
+
+	//          "ev,ac,tg,gt,ax,ay,az,tx,ty,tz,a0,a1,a2,a3"
+	fprintf(fh, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", evt.ev, evt.activator,
+	        evt.target, evt.gametic, evt.apos[0], evt.apos[1], evt.apos[2],
+	        evt.tpos[0], evt.tpos[1], evt.tpos[2], evt.arg0, evt.arg1, evt.arg2,
+	        evt.arg3);
+}
+
+/**
+ * Write up to count events from the ring to the spool file.
+ */
+static void FlushWDLRing(unsigned int count)
+{
+	for (; count > 0 && ::wdlstream.tail != ::wdlstream.head; count--)
+	{
+		const WDLEvent& evt = ::wdlstream.ring[::wdlstream.tail % WDL_RING_SIZE];
+		::wdlstream.tail++;
+
+		if (::wdlstream.spool == NULL || ferror(::wdlstream.spool))
+			::wdlstream.dropped++;
+		else
+			WriteWDLEvent(::wdlstream.spool, evt);
+	}
+}
+
+/**
+ * Move the events of the last tic into the ring, they can no longer be
+ * merged into.
+ */
+static void CloseWDLEvents()
+{
+	WDLEventLog::const_iterator it = ::wdlevents.begin();
+	for (; it != ::wdlevents.end(); ++it)
+	{
+		// Writer fell behind, make room the slow way.
+		if (::wdlstream.head - ::wdlstream.tail >= WDL_RING_SIZE)
+		{
+			::wdlstream.late++;
+			FlushWDLRing(1);
+		}
+
+		::wdlstream.ring[::wdlstream.head % WDL_RING_SIZE] = *it;
+		::wdlstream.head++;
+	}
+
+	::wdlevents.clear();
+}
+
+/**
+ * Add a new event to the log.
+ */
+static void PushWDLEvent(const WDLEvent& evt)
+{
+	if (!::wdlevents.empty() && ::wdlevents.back().gametic != evt.gametic)
+		CloseWDLEvents();
+
+	::wdlevents.push_back(evt);
+}
+
+/**
+ * Throw away the events of an unfinished log.
+ */
+static void DiscardWDLSpool()
+{
+	if (::wdlstream.spool != NULL)
+	{
+		fclose(::wdlstream.spool);
+		remove(::wdlstream.spoolname.c_str());
+		::wdlstream.spool = NULL;
+	}
+
+	::wdlevents.clear();
+	::wdlstream.head = ::wdlstream.tail = 0;
+	::wdlstream.lastgametic = 0;
+	::wdlstream.late = ::wdlstream.dropped = 0;
+}
+
+/**
+ * Append the next chunk of spooled events to a committed log.
+ *
+ * Returns true once the log is complete.
+ */
+static bool StepWDLFinalize(size_t bytes)
+{
+	if (::wdlfinal.out == NULL)
+		return true;
+
+	static char buf[WDL_COPY_CHUNK];
+	while (bytes > 0 && ::wdlfinal.spool != NULL)
+	{
+		size_t len = fread(buf, 1, std::min(bytes, sizeof(buf)), ::wdlfinal.spool);
+		if (len == 0)
+			break;
+
+		fwrite(buf, 1, len, ::wdlfinal.out);
+		bytes -= len;
+	}
+
+	if (bytes == 0)
+		return false;
+
+	if (::wdlfinal.spool != NULL)
+	{
+		fclose(::wdlfinal.spool);
+		remove(::wdlfinal.spoolname.c_str());
+		::wdlfinal.spool = NULL;
+	}
+
+	bool ok = ferror(::wdlfinal.out) == 0;
+	fclose(::wdlfinal.out);
+	::wdlfinal.out = NULL;
+
+	remove(::wdlfinal.filename.c_str());
+	if (!ok || rename(::wdlfinal.partname.c_str(), ::wdlfinal.filename.c_str()) != 0)
+	{
+		Printf(PRINT_HIGH, "wdlstats: Could not save \"%s\".\n",
+		       ::wdlfinal.filename.c_str());
+		return true;
+	}
+
+	Printf(PRINT_HIGH, "wdlstats: Log saved as \"%s\".\n", ::wdlfinal.filename.c_str());
+	return true;
+}
+
+static void FinishWDLFinalize()
+{
+	while (!StepWDLFinalize(WDL_COPY_CHUNK))
+	{
+	}
+}
+
 static void AddWDLPlayer(player_t* player)
 {
 	// Don't add player if their name is already in the vector.
@@ -411,8 +632,9 @@ static void WDLStatsHelp()
 	       "wdlstats - Starts logging WDL statistics to the given directory.  Unless "
 	       "you are running a WDL server, you probably are not interested in this.\n\n"
 	       "Usage:\n"
-	       "  ] wdlstats <DIRNAME>\n"
-	       "  Starts logging WDL statistics in the directory DIRNAME.\n");
+	       "  ] wdlstats <DIRNAME> [binary]\n"
+	       "  Starts logging WDL statistics in the directory DIRNAME.  With \"binary\",\n"
+	       "  events are written in a compact binary format after the usual header.\n");
 }
 
 BEGIN_COMMAND(wdlstats)
@@ -430,6 +652,8 @@ BEGIN_COMMAND(wdlstats)
 	if (*(::wdlstate.logdir.end() - 1) != PATHSEPCHAR)
 		::wdlstate.logdir += PATHSEPCHAR;
 
+	::wdlstate.binary = argc > 2 && stricmp(argv[2], "binary") == 0;
+
 	Printf(PRINT_HIGH,
 	       "wdlstats: Enabled, will log to directory \"%s\" on next map change.\n",
 	       wdlstate.logdir.c_str());
@@ -438,6 +662,13 @@ END_COMMAND(wdlstats)
 
 void M_StartWDLLog(bool newmap)
 {
+	// A log committed at the end of the last map must not be left half
+	// written.
+	FinishWDLFinalize();
+
+	// Events of a log that was never committed.
+	DiscardWDLSpool();
+
 	if (::wdlstate.logdir.empty())
 	{
 		::wdlstate.recording = false;
@@ -470,7 +701,16 @@ void M_StartWDLLog(bool newmap)
 	*/
 
 	// Start with a fresh slate of events.
-	::wdlevents.clear();
+	::wdlstream.spoolname = ::wdlstate.logdir + "wdl_" + GenerateTimestamp() + ".events";
+	::wdlstream.binary = ::wdlstate.binary;
+	::wdlstream.spool = fopen(::wdlstream.spoolname.c_str(), ::wdlstream.binary ? "wb" : "w");
+	if (::wdlstream.spool == NULL)
+	{
+		::wdlstate.recording = false;
+		Printf(PRINT_HIGH, "wdlstats: Could not open \"%s\" for writing.\n",
+		       ::wdlstream.spoolname.c_str());
+		return;
+	}
 
 	// And a fresh set of players.
 	::wdlplayers.clear();
@@ -711,7 +951,7 @@ void M_LogWDLItemRespawnEvent(AActor* activator)
 	// Add the event to the log.
 	WDLEvent evt = {WDL_EVENT_SPAWNITEM, 0,     0,        ::gametic, {ax, ay, az},
 	                {0, 0, 0},           itemtype, itemspawnid, 0,         0};
-	::wdlevents.push_back(evt);
+	PushWDLEvent(evt);
 }
 
 /**
@@ -776,7 +1016,15 @@ void M_LogWDLPickupEvent(player_t* activator, AActor* target, WDLPowerups pickup
 	WDLEvent evt = {
 	    WDL_EVENT_PICKUPITEM, aid,        tid,         ::gametic, {ax, ay, az},
 	    {tx, ty, tz},         pickuptype, itemspawnid, dropitem,  0};
-	::wdlevents.push_back(evt);
+	PushWDLEvent(evt);
+}
+
+/**
+ * @brief Check if events are being logged on this map.
+ */
+bool M_IsWDLRecording()
+{
+	return ::wdlstate.recording;
 }
 
 /**
@@ -862,7 +1110,7 @@ void M_LogWDLEvent(WDLEvents event, player_t* activator, player_t* target, int a
 	// Add the event to the log.
 	WDLEvent evt = {event,        aid,  tid,  ::gametic, {ax, ay, az},
 	                {tx, ty, tz}, arg0, arg1, arg2,      arg3};
-	::wdlevents.push_back(evt);
+	PushWDLEvent(evt);
 }
 
 /**
@@ -947,10 +1195,14 @@ int M_GetPlayerId(player_t* player, team_t team)
 
 void M_CommitWDLLog()
 {
-	if (!::wdlstate.recording || wdlevents.empty() ||
+	if (!::wdlstate.recording ||
+	    (::wdlstream.head == 0 && ::wdlevents.empty()) ||
 	    ::levelstate.getState() != LevelState::INGAME)
 		return;
 
+	// Only one log can be appending at a time.
+	FinishWDLFinalize();
+
 	// See if we can write a file.
 	std::string timestamp = GenerateTimestamp();
 	std::string filename = ::wdlstate.logdir + "wdl_" + timestamp + ".log";
@@ -984,10 +1236,12 @@ void M_CommitWDLLog()
 	char iso8601buf[sizeof "2011-10-08T07:07:09Z"];
 	strftime(iso8601buf, sizeof iso8601buf, "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
 
-	FILE* fh = fopen(filename.c_str(), "w+");
+	std::string partname = filename + ".part";
+	FILE* fh = fopen(partname.c_str(), ::wdlstream.binary ? "wb" : "w");
 	if (fh == NULL)
 	{
 		::wdlstate.recording = false;
+		DiscardWDLSpool();
 		Printf(PRINT_HIGH, "wdlstats: Could not save\"%s\" for writing.\n",
 		       filename.c_str());
 		return;
@@ -995,6 +1249,8 @@ void M_CommitWDLLog()
 
 	// Header (metadata)
 	fprintf(fh, "version=%d\n", WDLSTATS_VERSION);
+	if (::wdlstream.binary)
+		fprintf(fh, "format=binary\n");
 	fprintf(fh, "time=%s\n", iso8601buf);
 	fprintf(fh, "levelnum=%d\n", ::level.levelnum);
 	fprintf(fh, "levelname=%s\n", ::level.level_name);
@@ -1040,25 +1296,65 @@ void M_CommitWDLLog()
 	fprintf(fh, "wads\n");
 	fprintf(fh, "%s", M_GetCurrentWadHashes().c_str());
 
-	// Events
+	// Events, everything up to here has already been written to the spool.
 	fprintf(fh, "events\n");
-	WDLEventLog::const_iterator eit = ::wdlevents.begin();
-	for (; eit != ::wdlevents.end(); ++eit)
+
+	CloseWDLEvents();
+	FlushWDLRing(WDL_RING_SIZE);
+	long spoolsize = ftell(::wdlstream.spool);
+	fclose(::wdlstream.spool);
+	::wdlstream.spool = NULL;
+
+	// The spool is appended from M_WDLTicker a chunk per tic.
+	::wdlfinal.out = fh;
+	::wdlfinal.spoolname = ::wdlstream.spoolname;
+	::wdlfinal.spool = fopen(::wdlfinal.spoolname.c_str(), ::wdlstream.binary ? "rb" : "r");
+	::wdlfinal.partname = partname;
+	::wdlfinal.filename = filename;
+
+	// Short logs are not worth spreading out.
+	if (spoolsize >= 0 && static_cast<size_t>(spoolsize) <= WDL_COPY_CHUNK)
+		FinishWDLFinalize();
+
+	if (::wdlstream.late || ::wdlstream.dropped)
 	{
-		//          "ev,ac,tg,gt,ax,ay,az,tx,ty,tz,a0,a1,a2,a3"
-		fprintf(fh, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", eit->ev,
-		        eit->activator, eit->target, eit->gametic, eit->apos[0], eit->apos[1],
-		        eit->apos[2], eit->tpos[0], eit->tpos[1], eit->tpos[2], eit->arg0,
-		        eit->arg1, eit->arg2, eit->arg3);
+		Printf(PRINT_HIGH, "wdlstats: %u events written late, %u dropped.\n",
+		       ::wdlstream.late, ::wdlstream.dropped);
 	}
 
-	fclose(fh);
-
 	// Turn off stat recording global - it must be turned on again by the
 	// log starter next go-around.
 	::wdlstate.recording = false;
+}
 
-	Printf(PRINT_HIGH, "wdlstats: Log saved as \"%s\".\n", filename.c_str());
+/**
+ * Write out finished events and continue appending a committed log.
+ *
+ * Called once per tic, so that no single tic pays for a whole log.
+ */
+void M_WDLTicker()
+{
+	if (::wdlstate.recording)
+	{
+		if (!::wdlevents.empty() && ::wdlevents.back().gametic != ::gametic)
+			CloseWDLEvents();
+
+		FlushWDLRing(WDL_FLUSH_BATCH);
+	}
+
+	StepWDLFinalize(WDL_COPY_CHUNK);
+}
+
+/**
+ * Finish a committed log and throw away an uncommitted one.
+ *
+ * Called on quit, so that no .part or .events files are left behind.
+ */
+void STACK_ARGS M_ShutdownWDLLog()
+{
+	FinishWDLFinalize();
+	DiscardWDLSpool();
+	::wdlstate.recording = false;
 }
 
 static void PrintWDLEvent(const WDLEvent& evt)
@@ -1070,6 +1366,20 @@ static void PrintWDLEvent(const WDLEvent& evt)
 	       evt.tpos[0], evt.tpos[1], evt.tpos[2], evt.arg0, evt.arg1, evt.arg2, evt.arg3);
 }
 
+// Oldest event still in the ring.
+static unsigned int WDLOldestEvent()
+{
+	return ::wdlstream.head > WDL_RING_SIZE ? ::wdlstream.head - WDL_RING_SIZE : 0;
+}
+
+// Event by its number in the log, which must be no older than WDLOldestEvent.
+static const WDLEvent& WDLEventByID(unsigned int id)
+{
+	if (id >= ::wdlstream.head)
+		return ::wdlevents[id - ::wdlstream.head];
+	return ::wdlstream.ring[id % WDL_RING_SIZE];
+}
+
 static void WDLInfoHelp()
 {
 	Printf(PRINT_HIGH,
@@ -1096,7 +1406,10 @@ BEGIN_COMMAND(wdlinfo)
 	if (stricmp(argv[1], "size") == 0)
 	{
 		// Count total events.
-		Printf(PRINT_HIGH, "%" PRIuSIZE " events found\n", ::wdlevents.size());
+		Printf(PRINT_HIGH, "%" PRIuSIZE " events found\n",
+		       ::wdlstream.head + ::wdlevents.size());
+		Printf(PRINT_HIGH, "%u written, %u late, %u dropped\n", ::wdlstream.tail,
+		       ::wdlstream.late, ::wdlstream.dropped);
 		return;
 	}
 	else if (stricmp(argv[1], "state") == 0)
@@ -1107,25 +1420,25 @@ BEGIN_COMMAND(wdlinfo)
 		Printf(PRINT_HIGH, "Directory to write logs to: \"%s\"\n",
 		       ::wdlstate.logdir.c_str());
 		Printf(PRINT_HIGH, "Log starting gametic: %d\n", ::wdlstate.begintic);
+		Printf(PRINT_HIGH, "Event format: %s\n", ::wdlstate.binary ? "binary" : "text");
 		return;
 	}
 	else if (stricmp(argv[1], "tail") == 0)
 	{
-		// [Blair] C++ doesn't like when you access an iterator on an empty vector.
-		if (::wdlevents.empty())
+		const unsigned int total = ::wdlstream.head + ::wdlevents.size();
+		if (total == 0)
 		{
 			Printf(PRINT_HIGH, "No events to show.\n");
 			return;
 		}
+
 		// Show last 10 events.
-		WDLEventLog::const_iterator it = ::wdlevents.end() - 10;
-		if (it < ::wdlevents.begin())
-			it = wdlevents.begin();
-
-		Printf(PRINT_HIGH, "Showing last %" PRIdSIZE " events:\n",
-		       ::wdlevents.end() - it);
-		for (; it != ::wdlevents.end(); ++it)
-			PrintWDLEvent(*it);
+		unsigned int first = total > 10 ? total - 10 : 0;
+		first = std::max(first, WDLOldestEvent());
+
+		Printf(PRINT_HIGH, "Showing last %u events:\n", total - first);
+		for (unsigned int id = first; id < total; id++)
+			PrintWDLEvent(WDLEventByID(id));
 		return;
 	}
 
@@ -1138,13 +1451,17 @@ BEGIN_COMMAND(wdlinfo)
 	if (stricmp(argv[1], "event") == 0)
 	{
 		int id = atoi(argv[2]);
-		if (id >= static_cast<int>(::wdlevents.size()))
+		if (id < 0 || id >= static_cast<int>(::wdlstream.head + ::wdlevents.size()))
 		{
 			Printf(PRINT_HIGH, "Event number %d not found\n", id);
 			return;
 		}
-		WDLEvent evt = ::wdlevents.at(id);
-		PrintWDLEvent(evt);
+		if (static_cast<unsigned int>(id) < WDLOldestEvent())
+		{
+			Printf(PRINT_HIGH, "Event number %d is no longer in memory\n", id);
+			return;
+		}
+		PrintWDLEvent(WDLEventByID(id));
 		return;
 	}
 
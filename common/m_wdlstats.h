@@ -111,6 +111,7 @@ enum WDLPowerups {
 };
 
 void M_StartWDLLog(bool newmap);
+bool M_IsWDLRecording();
 void M_LogWDLEvent(
 	WDLEvents event, player_t* activator, player_t* target,
 	int arg0, int arg1, int arg2, int arg3
@@ -130,4 +131,6 @@ int M_GetPlayerSpawn(int x, int y);
 void M_HandleWDLNameChange(team_t team, std::string oldname, std::string newname, int netid);
 int GetMaxShotsForMod(int mod);
 void M_CommitWDLLog();
+void M_WDLTicker();
+void STACK_ARGS M_ShutdownWDLLog();
 WDLPowerups M_GetWDLItemByMobjType(const mobjtype_t type);
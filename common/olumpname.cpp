@@ -38,6 +38,8 @@ void OLumpName::MakeDataPresentable()
 
 	// ensure last char is escape character
 	m_data[8] = '\0';
+
+	m_lumpgen = 0;
 }
 
 // constructors/assignment operators
@@ -45,6 +47,7 @@ void OLumpName::MakeDataPresentable()
 OLumpName::OLumpName()
 {
 	memset(m_data, '\0', 9);
+	m_lumpgen = 0;
 }
 
 OLumpName::OLumpName(const OLumpName& other)
@@ -26,6 +26,12 @@ class OLumpName
 {
 	char m_data[9];
 
+	// Last lump this name resolved to, filled in by W_CheckNumForName
+	mutable uint64_t m_lumpkey;
+	mutable int m_lump;
+	mutable int m_lumpns;
+	mutable unsigned int m_lumpgen;	// 0 if never resolved
+
 	void MakeDataPresentable();
 
   public:
@@ -68,4 +74,6 @@ class OLumpName
 	friend bool operator!=(const OLumpName& lhs, const OLumpName& rhs);
 	friend bool operator!=(const OLumpName& lhs, const char* rhs);
 	friend bool operator!=(const OLumpName& lhs, const std::string& rhs);
+
+	friend int W_CheckNumForName(const OLumpName& name, int namespc);
 };
@@ -36,6 +36,7 @@
 #include "c_dispatch.h"
 #include "s_sndseq.h"
 #include "i_system.h"
+#include "w_wad.h"
 #include "m_vectors.h"
 #include "p_inter.h"
 #include "gi.h"
@@ -576,6 +577,10 @@ FBehavior::FBehavior (BYTE *object, int len)
 	Functions = NULL;
 	Arrays = NULL;
 	Chunks = NULL;
+	Code = NULL;
+	CodeSize = 0;
+	CodeOfs = NULL;
+	FunctionCode = NULL;
 
 	if (object[0] != 'A' || object[1] != 'C' || object[2] != 'S')
 	{
@@ -683,7 +688,7 @@ FBehavior::FBehavior (BYTE *object, int len)
 		Functions = FindChunk(MAKE_ID('F','U','N','C'));
 		if (Functions != NULL)
 		{
-			NumFunctions = LELONG(((DWORD *)Functions)[1]);
+			NumFunctions = LELONG(((DWORD *)Functions)[1]) / 8;
 			Functions += 8;
 		}
 
@@ -730,6 +735,8 @@ FBehavior::FBehavior (BYTE *object, int len)
 		}
 	}
 
+	TranslateCode ();
+
 	DPrintf ("Loaded %d scripts, %d Functions\n", NumScripts, NumFunctions);
 }
 
@@ -749,6 +756,10 @@ FBehavior::~FBehavior ()
 		delete[] Arrays;
 		Arrays = NULL;
 	}
+
+	delete[] Code;
+	delete[] CodeOfs;
+	delete[] FunctionCode;
 }
 
 int STACK_ARGS FBehavior::SortScripts (const void *a, const void *b)
@@ -768,7 +779,7 @@ int *FBehavior::FindScript (int script) const
 	const ScriptPtr *ptr = BinarySearch<ScriptPtr, WORD>
 		((ScriptPtr *)Scripts, NumScripts, &ScriptPtr::Number, (WORD)script);
 
-	return ptr ? (int *)(ptr->Address + Data) : NULL;
+	return ptr ? Ofs2PC (ptr->Address) : NULL;
 }
 
 ScriptFunction *FBehavior::GetFunction (int funcnum) const
@@ -800,6 +811,299 @@ void FBehavior::SetArrayVal (int arraynum, int index, int value)
 	array->Elements[index] = value;
 }
 
+DWORD FBehavior::PC2Ofs (int *pc) const
+{
+	ptrdiff_t index = pc - Code;
+
+	if (index < 0 || index >= CodeSize)
+		return 0;
+	return CodeOfs[index];
+}
+
+int *FBehavior::Ofs2PC (DWORD ofs) const
+{
+	std::map<DWORD, int>::const_iterator it = CodeIndex.find (ofs);
+
+	// Anything that was never translated ends up at the TERMINATE in front
+	if (it == CodeIndex.end())
+		return Code;
+	return Code + it->second;
+}
+
+//
+// How the operands of a p-code are stored in the object file:
+//	b	a byte
+//	B	a byte in ACSe objects, a word in all others
+//	W	a word
+//	J	a word with the offset of a jump target
+//	*	a byte count, followed by that many bytes
+//
+// P-codes that are not listed take no operands. Some are translated into a
+// p-code that takes the same operands as words.
+//
+struct PCodeLayout
+{
+	int PCode;
+	const char *Operands;
+	int Translation;
+};
+
+#define LAYOUT(pcd,ops)			{ DLevelScript::pcd, ops, DLevelScript::pcd }
+#define LAYOUTAS(pcd,ops,as)	{ DLevelScript::pcd, ops, DLevelScript::as }
+#define VARLAYOUTS(op) \
+	LAYOUT(PCD_##op##SCRIPTVAR, "B"), LAYOUT(PCD_##op##MAPVAR, "B"), \
+	LAYOUT(PCD_##op##WORLDVAR, "B"), LAYOUT(PCD_##op##GLOBALVAR, "B"), \
+	LAYOUT(PCD_##op##MAPARRAY, "B"), LAYOUT(PCD_##op##WORLDARRAY, "B"), \
+	LAYOUT(PCD_##op##GLOBALARRAY, "B")
+
+static const PCodeLayout PCodeLayouts[] =
+{
+	LAYOUT(PCD_PUSHNUMBER, "W"),
+	LAYOUTAS(PCD_PUSHBYTE, "b", PCD_PUSHNUMBER),
+	LAYOUT(PCD_PUSH2BYTES, "bb"),
+	LAYOUT(PCD_PUSH3BYTES, "bbb"),
+	LAYOUT(PCD_PUSH4BYTES, "bbbb"),
+	LAYOUT(PCD_PUSH5BYTES, "bbbbb"),
+	LAYOUT(PCD_PUSHBYTES, "*"),
+	LAYOUT(PCD_LSPEC1, "B"),
+	LAYOUT(PCD_LSPEC2, "B"),
+	LAYOUT(PCD_LSPEC3, "B"),
+	LAYOUT(PCD_LSPEC4, "B"),
+	LAYOUT(PCD_LSPEC5, "B"),
+	LAYOUT(PCD_LSPEC1DIRECT, "BW"),
+	LAYOUT(PCD_LSPEC2DIRECT, "BWW"),
+	LAYOUT(PCD_LSPEC3DIRECT, "BWWW"),
+	LAYOUT(PCD_LSPEC4DIRECT, "BWWWW"),
+	LAYOUT(PCD_LSPEC5DIRECT, "BWWWWW"),
+	LAYOUTAS(PCD_LSPEC1DIRECTB, "bb", PCD_LSPEC1DIRECT),
+	LAYOUTAS(PCD_LSPEC2DIRECTB, "bbb", PCD_LSPEC2DIRECT),
+	LAYOUTAS(PCD_LSPEC3DIRECTB, "bbbb", PCD_LSPEC3DIRECT),
+	LAYOUTAS(PCD_LSPEC4DIRECTB, "bbbbb", PCD_LSPEC4DIRECT),
+	LAYOUTAS(PCD_LSPEC5DIRECTB, "bbbbbb", PCD_LSPEC5DIRECT),
+	LAYOUT(PCD_CALL, "B"),
+	LAYOUT(PCD_CALLDISCARD, "B"),
+	VARLAYOUTS(ASSIGN),
+	VARLAYOUTS(PUSH),
+	VARLAYOUTS(ADD),
+	VARLAYOUTS(SUB),
+	VARLAYOUTS(MUL),
+	VARLAYOUTS(DIV),
+	VARLAYOUTS(MOD),
+	VARLAYOUTS(INC),
+	VARLAYOUTS(DEC),
+	LAYOUT(PCD_GOTO, "J"),
+	LAYOUT(PCD_IFGOTO, "J"),
+	LAYOUT(PCD_IFNOTGOTO, "J"),
+	LAYOUT(PCD_CASEGOTO, "WJ"),
+	LAYOUT(PCD_DELAYDIRECT, "W"),
+	LAYOUTAS(PCD_DELAYDIRECTB, "b", PCD_DELAYDIRECT),
+	LAYOUT(PCD_RANDOMDIRECT, "WW"),
+	LAYOUTAS(PCD_RANDOMDIRECTB, "bb", PCD_RANDOMDIRECT),
+	LAYOUT(PCD_THINGCOUNTDIRECT, "WW"),
+	LAYOUT(PCD_TAGWAITDIRECT, "W"),
+	LAYOUT(PCD_POLYWAITDIRECT, "W"),
+	LAYOUT(PCD_CHANGEFLOORDIRECT, "WW"),
+	LAYOUT(PCD_CHANGECEILINGDIRECT, "WW"),
+	LAYOUT(PCD_SCRIPTWAITDIRECT, "W"),
+	LAYOUT(PCD_SETGRAVITYDIRECT, "W"),
+	LAYOUT(PCD_SETAIRCONTROLDIRECT, "W"),
+	LAYOUT(PCD_SPAWNDIRECT, "WWWWWW"),
+	LAYOUT(PCD_SPAWNSPOTDIRECT, "WWWW"),
+	LAYOUT(PCD_GIVEINVENTORYDIRECT, "WW"),
+	LAYOUT(PCD_TAKEINVENTORYDIRECT, "WW"),
+	LAYOUT(PCD_CHECKINVENTORYDIRECT, "W"),
+	LAYOUT(PCD_SETMUSICDIRECT, "WWW"),
+	LAYOUT(PCD_LOCALSETMUSICDIRECT, "WWW"),
+};
+
+#undef LAYOUT
+#undef LAYOUTAS
+#undef VARLAYOUTS
+
+static const PCodeLayout *FindPCodeLayout (int pcd)
+{
+	static const PCodeLayout *layouts[DLevelScript::PCODE_COMMAND_COUNT];
+	static bool initialized = false;
+
+	if (!initialized)
+	{
+		for (size_t i = 0; i < ARRAY_LENGTH(PCodeLayouts); ++i)
+			layouts[PCodeLayouts[i].PCode] = &PCodeLayouts[i];
+		initialized = true;
+	}
+
+	if ((unsigned)pcd >= DLevelScript::PCODE_COMMAND_COUNT)
+		return NULL;
+	return layouts[pcd];
+}
+
+// Reads a little endian value of size bytes, returns false if it does not
+// fit in the object
+static bool ReadCodeValue (const BYTE *data, DWORD datasize, DWORD &ofs, int size, int &value)
+{
+	if (ofs >= datasize || datasize - ofs < (DWORD)size)
+		return false;
+
+	if (size == 1)
+		value = data[ofs];
+	else
+		value = data[ofs] | (data[ofs+1] << 8) | (data[ofs+2] << 16) | (data[ofs+3] << 24);
+
+	ofs += size;
+	return true;
+}
+
+struct TranslatedPCode
+{
+	int PCode;
+	std::vector<int> Operands;
+	int JumpOperand;	// Which operand is a jump target, or -1
+	bool FallsThrough;	// Can continue with the p-code after it
+	DWORD Next;			// Offset of the p-code after it
+};
+
+//
+// FBehavior::TranslateCode
+//
+// Decodes every p-code that can be reached from a script or function into
+// Code. Operands are widened to words and jump targets are resolved, so the
+// interpreter never has to care which format the object was in.
+//
+void FBehavior::TranslateCode ()
+{
+	const bool bytes = (Format == ACS_LittleEnhanced);
+	std::map<DWORD, TranslatedPCode> pcodes;
+	std::vector<DWORD> pending;
+	int i;
+
+	for (i = 0; i < NumScripts; ++i)
+		pending.push_back (((ScriptPtr *)(Scripts + 8*i))->Address);
+	for (i = 0; i < NumFunctions; ++i)
+		pending.push_back (((ScriptFunction *)Functions + i)->Address);
+
+	while (!pending.empty())
+	{
+		DWORD ofs = pending.back();
+		pending.pop_back();
+
+		if (pcodes.find (ofs) != pcodes.end())
+			continue;
+
+		// P-codes that run off the end of the object become TERMINATEs
+		TranslatedPCode &pcode = pcodes[ofs];
+		pcode.PCode = DLevelScript::PCD_TERMINATE;
+		pcode.JumpOperand = -1;
+		pcode.FallsThrough = false;
+		pcode.Next = ofs;
+
+		DWORD pos = ofs;
+		int pcd, value, count;
+		bool ok = ReadCodeValue (Data, DataSize, pos, bytes ? 1 : 4, pcd);
+		const PCodeLayout *layout = FindPCodeLayout (pcd);
+
+		for (const char *op = layout ? layout->Operands : ""; ok && *op; ++op)
+		{
+			switch (*op)
+			{
+			case 'b':
+				ok = ReadCodeValue (Data, DataSize, pos, 1, value);
+				break;
+			case 'B':
+				ok = ReadCodeValue (Data, DataSize, pos, bytes ? 1 : 4, value);
+				break;
+			case 'J':
+				pcode.JumpOperand = pcode.Operands.size();
+				// fall through
+			case 'W':
+				ok = ReadCodeValue (Data, DataSize, pos, 4, value);
+				break;
+			case '*':
+				ok = ReadCodeValue (Data, DataSize, pos, 1, count);
+				pcode.Operands.push_back (count);
+				while (ok && count-- > 0)
+				{
+					ok = ReadCodeValue (Data, DataSize, pos, 1, value);
+					pcode.Operands.push_back (value);
+				}
+				continue;
+			}
+			pcode.Operands.push_back (value);
+		}
+
+		if (!ok)
+		{
+			pcode.Operands.clear();
+			pcode.JumpOperand = -1;
+			continue;
+		}
+
+		pcode.PCode = layout ? layout->Translation : pcd;
+		pcode.Next = pos;
+		pcode.FallsThrough =
+			pcd != DLevelScript::PCD_TERMINATE && pcd != DLevelScript::PCD_RESTART &&
+			pcd != DLevelScript::PCD_GOTO && pcd != DLevelScript::PCD_RETURNVOID &&
+			pcd != DLevelScript::PCD_RETURNVAL;
+
+		if (pcode.JumpOperand >= 0)
+			pending.push_back ((DWORD)pcode.Operands[pcode.JumpOperand]);
+		if (pcode.FallsThrough)
+			pending.push_back (pcode.Next);
+	}
+
+	// Lay the p-codes out in the order they had in the object, with a
+	// TERMINATE in front for bad offsets to go to.
+	std::vector<int> code (1, (int)DLevelScript::PCD_TERMINATE);
+	std::vector<DWORD> offsets (1, 0);
+	std::vector<std::pair<size_t, DWORD> > jumps;
+	std::map<DWORD, TranslatedPCode>::const_iterator it, next;
+
+	for (it = pcodes.begin(); it != pcodes.end(); it = next)
+	{
+		const TranslatedPCode &pcode = it->second;
+
+		next = it;
+		++next;
+
+		CodeIndex[it->first] = code.size();
+		code.push_back (pcode.PCode);
+		offsets.push_back (it->first);
+
+		for (size_t j = 0; j < pcode.Operands.size(); ++j)
+		{
+			if ((int)j == pcode.JumpOperand)
+				jumps.push_back (std::make_pair (code.size(), (DWORD)pcode.Operands[j]));
+			code.push_back (pcode.Operands[j]);
+			offsets.push_back (it->first);
+		}
+
+		// Something jumped into the middle of this p-code, so the one after
+		// it was not laid out next.
+		if (pcode.FallsThrough && (next == pcodes.end() || next->first != pcode.Next))
+		{
+			code.push_back (DLevelScript::PCD_GOTO);
+			offsets.push_back (pcode.Next);
+			jumps.push_back (std::make_pair (code.size(), pcode.Next));
+			code.push_back (0);
+			offsets.push_back (pcode.Next);
+		}
+	}
+
+	CodeSize = code.size();
+	Code = new int[CodeSize];
+	CodeOfs = new DWORD[CodeSize];
+	std::copy (code.begin(), code.end(), Code);
+	std::copy (offsets.begin(), offsets.end(), CodeOfs);
+
+	for (size_t j = 0; j < jumps.size(); ++j)
+		Code[jumps[j].first] = Ofs2PC (jumps[j].second) - Code;
+
+	FunctionCode = new int[NumFunctions > 0 ? NumFunctions : 1];
+	for (i = 0; i < NumFunctions; ++i)
+		FunctionCode[i] = Ofs2PC (((ScriptFunction *)Functions + i)->Address) - Code;
+
+	DPrintf ("Translated %d p-codes into %d words\n", (int)pcodes.size(), CodeSize);
+}
+
 BYTE *FBehavior::FindChunk (DWORD id) const
 {
 	BYTE *chunk = Chunks;
@@ -1007,7 +1311,7 @@ void FBehavior::StartTypedScripts (WORD type, AActor *activator, int arg0, int a
 		if (ptr->Type == type)
 		{
 			P_GetScriptGoing (activator, NULL, ptr->Number,
-				(int *)(ptr->Address + Data), 0, arg0, arg1, arg2, always, true);
+				Ofs2PC (ptr->Address), 0, arg0, arg1, arg2, always, true);
 		}
 	}
 }
@@ -1016,8 +1320,91 @@ void FBehavior::StartTypedScripts (WORD type, AActor *activator, int arg0, int a
 
 
 
-#define NEXTWORD	(LELONG(*pc++))
-#define NEXTBYTE	(fmt==ACS_LittleEnhanced?getbyte(pc):NEXTWORD)
+// Scripts run from the stream built by FBehavior::TranslateCode, where every
+// operand has already been widened to a native word
+#define NEXTWORD	(*pc++)
+#define NEXTBYTE	NEXTWORD
+
+// With GCC and Clang every handler jumps straight to the next one through a
+// table of label addresses instead of going back around the switch, other
+// compilers just use the switch.
+#if defined(__GNUC__)
+#define ACS_THREADED
+#endif
+
+#ifdef ACS_THREADED
+#define PCODE(x)		case x: op_##x
+#define PCODE_DEFAULT	default: op_default
+#define NEXTPCODE \
+	if (state != SCRIPT_Running || runaway >= 500000) \
+		break; \
+	runaway++; \
+	pcd = NEXTBYTE; \
+	goto *((unsigned)pcd < PCODE_COMMAND_COUNT ? dispatch[pcd] : &&op_default)
+
+// Every p-code RunScript has a handler for, after translation
+#define ACS_PCODES(X) \
+	X(PCD_NOP) X(PCD_TERMINATE) X(PCD_SUSPEND) X(PCD_PUSHNUMBER) X(PCD_LSPEC1) \
+	X(PCD_LSPEC2) X(PCD_LSPEC3) X(PCD_LSPEC4) X(PCD_LSPEC5) X(PCD_LSPEC1DIRECT) \
+	X(PCD_LSPEC2DIRECT) X(PCD_LSPEC3DIRECT) X(PCD_LSPEC4DIRECT) \
+	X(PCD_LSPEC5DIRECT) X(PCD_ADD) X(PCD_SUBTRACT) X(PCD_MULTIPLY) \
+	X(PCD_DIVIDE) X(PCD_MODULUS) X(PCD_EQ) X(PCD_NE) X(PCD_LT) X(PCD_GT) \
+	X(PCD_LE) X(PCD_GE) X(PCD_ASSIGNSCRIPTVAR) X(PCD_ASSIGNMAPVAR) \
+	X(PCD_ASSIGNWORLDVAR) X(PCD_PUSHSCRIPTVAR) X(PCD_PUSHMAPVAR) \
+	X(PCD_PUSHWORLDVAR) X(PCD_ADDSCRIPTVAR) X(PCD_ADDMAPVAR) X(PCD_ADDWORLDVAR) \
+	X(PCD_SUBSCRIPTVAR) X(PCD_SUBMAPVAR) X(PCD_SUBWORLDVAR) X(PCD_MULSCRIPTVAR) \
+	X(PCD_MULMAPVAR) X(PCD_MULWORLDVAR) X(PCD_DIVSCRIPTVAR) X(PCD_DIVMAPVAR) \
+	X(PCD_DIVWORLDVAR) X(PCD_MODSCRIPTVAR) X(PCD_MODMAPVAR) X(PCD_MODWORLDVAR) \
+	X(PCD_INCSCRIPTVAR) X(PCD_INCMAPVAR) X(PCD_INCWORLDVAR) X(PCD_DECSCRIPTVAR) \
+	X(PCD_DECMAPVAR) X(PCD_DECWORLDVAR) X(PCD_GOTO) X(PCD_IFGOTO) X(PCD_DROP) \
+	X(PCD_DELAY) X(PCD_DELAYDIRECT) X(PCD_RANDOM) X(PCD_RANDOMDIRECT) \
+	X(PCD_THINGCOUNT) X(PCD_THINGCOUNTDIRECT) X(PCD_TAGWAIT) \
+	X(PCD_TAGWAITDIRECT) X(PCD_POLYWAIT) X(PCD_POLYWAITDIRECT) \
+	X(PCD_CHANGEFLOOR) X(PCD_CHANGEFLOORDIRECT) X(PCD_CHANGECEILING) \
+	X(PCD_CHANGECEILINGDIRECT) X(PCD_RESTART) X(PCD_ANDLOGICAL) \
+	X(PCD_ORLOGICAL) X(PCD_ANDBITWISE) X(PCD_ORBITWISE) X(PCD_EORBITWISE) \
+	X(PCD_NEGATELOGICAL) X(PCD_LSHIFT) X(PCD_RSHIFT) X(PCD_UNARYMINUS) \
+	X(PCD_IFNOTGOTO) X(PCD_LINESIDE) X(PCD_SCRIPTWAIT) X(PCD_SCRIPTWAITDIRECT) \
+	X(PCD_CLEARLINESPECIAL) X(PCD_CASEGOTO) X(PCD_BEGINPRINT) X(PCD_ENDPRINT) \
+	X(PCD_PRINTSTRING) X(PCD_PRINTNUMBER) X(PCD_PRINTCHARACTER) \
+	X(PCD_PLAYERCOUNT) X(PCD_GAMETYPE) X(PCD_GAMESKILL) X(PCD_TIMER) \
+	X(PCD_SECTORSOUND) X(PCD_AMBIENTSOUND) X(PCD_SOUNDSEQUENCE) \
+	X(PCD_SETLINETEXTURE) X(PCD_SETLINEBLOCKING) X(PCD_SETLINESPECIAL) \
+	X(PCD_THINGSOUND) X(PCD_ENDPRINTBOLD) X(PCD_ACTIVATORSOUND) \
+	X(PCD_LOCALAMBIENTSOUND) X(PCD_SETLINEMONSTERBLOCKING) X(PCD_PLAYERHEALTH) \
+	X(PCD_PLAYERARMORPOINTS) X(PCD_PLAYERFRAGS) X(PCD_PRINTNAME) \
+	X(PCD_MUSICCHANGE) X(PCD_SINGLEPLAYER) X(PCD_FIXEDMUL) X(PCD_FIXEDDIV) \
+	X(PCD_SETGRAVITY) X(PCD_SETGRAVITYDIRECT) X(PCD_SETAIRCONTROL) \
+	X(PCD_SETAIRCONTROLDIRECT) X(PCD_CLEARINVENTORY) X(PCD_GIVEINVENTORY) \
+	X(PCD_GIVEINVENTORYDIRECT) X(PCD_TAKEINVENTORY) X(PCD_TAKEINVENTORYDIRECT) \
+	X(PCD_CHECKINVENTORY) X(PCD_CHECKINVENTORYDIRECT) X(PCD_SPAWN) \
+	X(PCD_SPAWNDIRECT) X(PCD_SPAWNSPOT) X(PCD_SPAWNSPOTDIRECT) X(PCD_SETMUSIC) \
+	X(PCD_SETMUSICDIRECT) X(PCD_LOCALSETMUSIC) X(PCD_LOCALSETMUSICDIRECT) \
+	X(PCD_PRINTFIXED) X(PCD_PRINTLOCALIZED) X(PCD_PUSHBYTES) X(PCD_PUSH2BYTES) \
+	X(PCD_PUSH3BYTES) X(PCD_PUSH4BYTES) X(PCD_PUSH5BYTES) \
+	X(PCD_SETTHINGSPECIAL) X(PCD_ASSIGNGLOBALVAR) X(PCD_PUSHGLOBALVAR) \
+	X(PCD_ADDGLOBALVAR) X(PCD_SUBGLOBALVAR) X(PCD_MULGLOBALVAR) \
+	X(PCD_DIVGLOBALVAR) X(PCD_MODGLOBALVAR) X(PCD_INCGLOBALVAR) \
+	X(PCD_DECGLOBALVAR) X(PCD_FADETO) X(PCD_FADERANGE) X(PCD_CANCELFADE) \
+	X(PCD_SETFLOORTRIGGER) X(PCD_SETCEILINGTRIGGER) X(PCD_GETACTORX) \
+	X(PCD_GETACTORY) X(PCD_GETACTORZ) X(PCD_CALL) X(PCD_CALLDISCARD) \
+	X(PCD_RETURNVOID) X(PCD_RETURNVAL) X(PCD_PUSHMAPARRAY) \
+	X(PCD_ASSIGNMAPARRAY) X(PCD_ADDMAPARRAY) X(PCD_SUBMAPARRAY) \
+	X(PCD_MULMAPARRAY) X(PCD_DIVMAPARRAY) X(PCD_MODMAPARRAY) X(PCD_INCMAPARRAY) \
+	X(PCD_DECMAPARRAY) X(PCD_DUP) X(PCD_SWAP) X(PCD_SIN) X(PCD_COS) \
+	X(PCD_VECTORANGLE) X(PCD_PUSHWORLDARRAY) X(PCD_ASSIGNWORLDARRAY) \
+	X(PCD_ADDWORLDARRAY) X(PCD_SUBWORLDARRAY) X(PCD_MULWORLDARRAY) \
+	X(PCD_DIVWORLDARRAY) X(PCD_MODWORLDARRAY) X(PCD_INCWORLDARRAY) \
+	X(PCD_DECWORLDARRAY) X(PCD_PUSHGLOBALARRAY) X(PCD_ASSIGNGLOBALARRAY) \
+	X(PCD_ADDGLOBALARRAY) X(PCD_SUBGLOBALARRAY) X(PCD_MULGLOBALARRAY) \
+	X(PCD_DIVGLOBALARRAY) X(PCD_MODGLOBALARRAY) X(PCD_INCGLOBALARRAY) \
+	X(PCD_DECGLOBALARRAY) X(PCD_PLAYERNUMBER) X(PCD_ACTIVATORTID) \
+	X(PCD_GETCVAR) X(PCD_GETACTORANGLE) X(PCD_GETLEVELINFO)
+#else
+#define PCODE(x)		case x
+#define PCODE_DEFAULT	default
+#define NEXTPCODE		break
+#endif
 #define STACK(a)	(Stack[sp - (a)])
 #define PushToStack(a)	(Stack[sp++] = (a))
 
@@ -1044,6 +1431,15 @@ DACSThinker::DACSThinker ()
 }
 
 DACSThinker::~DACSThinker ()
+{
+	DestroyScripts ();
+
+	// acsbench's scratch thinker goes away after the map's is put back
+	if (ActiveThinker == this)
+		ActiveThinker = NULL;
+}
+
+void DACSThinker::DestroyScripts ()
 {
 	DLevelScript *script = Scripts;
 	while (script)
@@ -1052,8 +1448,12 @@ DACSThinker::~DACSThinker ()
 		script->Destroy ();
 		script = next;
 	}
-	Scripts = NULL;
-	ActiveThinker = NULL;
+	Scripts = LastScript = NULL;
+
+	for (int i = 0; i < 1000; i++)
+		RunningScripts[i] = NULL;
+	for (int i = 0; i < NUM_WAITQUEUES; i++)
+		WaitQueues[i].clear ();
 }
 
 void DACSThinker::Serialize (FArchive &arc)
@@ -1091,11 +1491,94 @@ void DACSThinker::RunThink ()
 	while (script)
 	{
 		DLevelScript *next = script->next;
-		script->RunScript ();
+		if (!script->parked)
+			script->RunScript ();
 		script = next;
 	}
 }
 
+DACSThinker::EWaitQueue DACSThinker::WaitQueueFor (const DLevelScript *script)
+{
+	switch (script->state)
+	{
+	case DLevelScript::SCRIPT_TagWait:
+		return WAIT_Tag;
+	case DLevelScript::SCRIPT_PolyWait:
+		return WAIT_Poly;
+	case DLevelScript::SCRIPT_ScriptWaitPre:
+		return WAIT_ScriptStart;
+	default:
+		return WAIT_ScriptEnd;
+	}
+}
+
+//
+// DACSThinker::Park
+//
+// Takes a script that is waiting out of the running until something it is
+// waiting for happens. It stays in the script list so it runs in the same
+// order as before once it wakes.
+//
+void DACSThinker::Park (DLevelScript *script)
+{
+	if (script->parked)
+		return;
+
+	WaitQueues[WaitQueueFor (script)][script->statedata].push_back (script);
+	script->parked = true;
+}
+
+void DACSThinker::Unpark (DLevelScript *script)
+{
+	if (!script->parked)
+		return;
+
+	WaitQueue &queue = WaitQueues[WaitQueueFor (script)];
+	WaitQueue::iterator it = queue.find (script->statedata);
+
+	if (it != queue.end())
+	{
+		std::vector<DLevelScript *> &waiting = it->second;
+
+		waiting.erase (std::remove (waiting.begin(), waiting.end(), script), waiting.end());
+		if (waiting.empty())
+			queue.erase (it);
+	}
+	script->parked = false;
+}
+
+//
+// DACSThinker::Wake
+//
+// Lets every script waiting on key run again. Each one checks for itself
+// whether it is done waiting and parks again if it is not.
+//
+void DACSThinker::Wake (EWaitQueue queue, int key)
+{
+	WaitQueue::iterator it = WaitQueues[queue].find (key);
+
+	if (it == WaitQueues[queue].end())
+		return;
+
+	std::vector<DLevelScript *> &waiting = it->second;
+	for (size_t i = 0; i < waiting.size(); ++i)
+		waiting[i]->parked = false;
+
+	WaitQueues[queue].erase (it);
+}
+
+void P_WakeTagWaiters (int tag)
+{
+	if (DACSThinker::ActiveThinker)
+		DACSThinker::ActiveThinker->Wake (DACSThinker::WAIT_Tag, tag);
+}
+
+void P_WakePolyWaiters (int polynum)
+{
+	if (DACSThinker::ActiveThinker)
+		DACSThinker::ActiveThinker->Wake (DACSThinker::WAIT_Poly, polynum);
+}
+
 // FlashFader class - not sure where to put this so it goes here for now...
 class DFlashFader : public DThinker
 {
@@ -1389,6 +1872,7 @@ void DLevelScript::Serialize (FArchive &arc)
 DLevelScript::DLevelScript ()
 {
 	next = prev = NULL;
+	parked = false;
 	if (DACSThinker::ActiveThinker == NULL)
 		new DACSThinker;
 }
@@ -1483,7 +1967,7 @@ int DLevelScript::ThingCount (int type, int tid)
 	AActor *mobj = NULL;
 	int count = 0;
 
-	if (type >= NumSpawnableThings)
+	if (type < 0 || type >= NumSpawnableThings)
 	{
 		return 0;
 	}
@@ -1504,21 +1988,22 @@ int DLevelScript::ThingCount (int type, int tid)
 			mobj = mobj->FindByTID (tid);
 		}
 	}
+	else if (type == 0)
+	{
+		TThinkerIterator<AActor> iterator;
+
+		while (iterator.Next ())
+			count++;
+	}
 	else
 	{
 		AActor *actor;
-		TThinkerIterator<AActor> iterator;
+		FActorTypeIterator iterator((mobjtype_t)type);
 
 		while ( (actor = iterator.Next ()) )
 		{
-			if (type == 0)
-			{
-				count++;
-			}
-			else if (actor->type == type && actor->health > 0)
-			{
+			if (actor->health > 0)
 				count++;
-			}
 		}
 	}
 	return count;
@@ -2104,13 +2589,6 @@ void DLevelScript::DoFadeRange(AActor* who, int r1, int g1, int b1, int a1,
 	}
 }
 
-inline int getbyte (int *&pc)
-{
-	int res = *(BYTE *)pc;
-	pc = (int *)((BYTE *)pc+1);
-	return res;
-}
-
 void DLevelScript::RunScript ()
 {
 	DACSThinker *controller = DACSThinker::ActiveThinker;
@@ -2138,7 +2616,10 @@ void DLevelScript::RunScript ()
 
 		while ((secnum = P_FindSectorFromTag (statedata, secnum)) >= 0)
 			if (sectors[secnum].floordata || sectors[secnum].ceilingdata)
+			{
+				controller->Park (this);
 				return;
+			}
 
 		// If we got here, none of the tagged sectors were busy
 		state = SCRIPT_Running;
@@ -2151,18 +2632,31 @@ void DLevelScript::RunScript ()
 		{
 			state = SCRIPT_Running;
 		}
+		else
+		{
+			controller->Park (this);
+			return;
+		}
 		break;
 
 	case SCRIPT_ScriptWaitPre:
 		// Wait for a script to start running, then enter state scriptwait
 		if (controller->RunningScripts[statedata])
 			state = SCRIPT_ScriptWait;
+		else
+		{
+			controller->Park (this);
+			return;
+		}
 		break;
 
 	case SCRIPT_ScriptWait:
 		// Wait for a script to stop running, then enter state running
 		if (controller->RunningScripts[statedata])
+		{
+			controller->Park (this);
 			return;
+		}
 
 		state = SCRIPT_Running;
 		PutFirst ();
@@ -2174,7 +2668,7 @@ void DLevelScript::RunScript ()
 
 	int *pc = this->pc;
 	int sp = this->sp;
-	const ACSFormat fmt = level.behavior->GetFormat();
+	int *const code = level.behavior->GetCode();
 	int runaway = 0;	// used to prevent infinite loops
 	int pcd;
 	char work[4096], *workwhere = work;
@@ -2182,6 +2676,19 @@ void DLevelScript::RunScript ()
 //	int optstart = -1;
 	int temp;
 
+#ifdef ACS_THREADED
+	static const void *dispatch[PCODE_COMMAND_COUNT];
+
+	if (dispatch[0] == NULL)
+	{
+		for (int i = 0; i < PCODE_COMMAND_COUNT; ++i)
+			dispatch[i] = &&op_default;
+#define X(x)	dispatch[x] = &&op_##x;
+		ACS_PCODES(X)
+#undef X
+	}
+#endif
+
 	while (state == SCRIPT_Running)
 	{
 		if (++runaway > 500000)
@@ -2194,183 +2701,144 @@ void DLevelScript::RunScript ()
 		pcd = NEXTBYTE;
 		switch (pcd)
 		{
-		default:
+		PCODE_DEFAULT:
 			DPrintf("Unknown P-Code %d in script %d\n", pcd, script);
 			continue;
 			// fall through
-		case PCD_TERMINATE:
+		PCODE(PCD_TERMINATE):
 			state = SCRIPT_PleaseRemove;
-			break;
+			NEXTPCODE;
 
-		case PCD_NOP:
-			break;
+		PCODE(PCD_NOP):
+			NEXTPCODE;
 
-		case PCD_SUSPEND:
+		PCODE(PCD_SUSPEND):
 			state = SCRIPT_Suspended;
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHNUMBER:
+		PCODE(PCD_PUSHNUMBER):
 			PushToStack(NEXTWORD);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHBYTE:
-			PushToStack(*(BYTE*)pc);
-			pc = (int*)((BYTE*)pc + 1);
-			break;
-
-		case PCD_PUSH2BYTES:
-			Stack[sp] = ((BYTE*)pc)[0];
-			Stack[sp + 1] = ((BYTE*)pc)[1];
+		PCODE(PCD_PUSH2BYTES):
+			Stack[sp] = pc[0];
+			Stack[sp + 1] = pc[1];
 			sp += 2;
-			pc = (int*)((BYTE*)pc + 2);
-			break;
+			pc += 2;
+			NEXTPCODE;
 
-		case PCD_PUSH3BYTES:
-			Stack[sp] = ((BYTE*)pc)[0];
-			Stack[sp + 1] = ((BYTE*)pc)[1];
-			Stack[sp + 2] = ((BYTE*)pc)[2];
+		PCODE(PCD_PUSH3BYTES):
+			Stack[sp] = pc[0];
+			Stack[sp + 1] = pc[1];
+			Stack[sp + 2] = pc[2];
 			sp += 3;
-			pc = (int*)((BYTE*)pc + 3);
-			break;
+			pc += 3;
+			NEXTPCODE;
 
-		case PCD_PUSH4BYTES:
-			Stack[sp] = ((BYTE*)pc)[0];
-			Stack[sp + 1] = ((BYTE*)pc)[1];
-			Stack[sp + 2] = ((BYTE*)pc)[2];
-			Stack[sp + 3] = ((BYTE*)pc)[3];
+		PCODE(PCD_PUSH4BYTES):
+			Stack[sp] = pc[0];
+			Stack[sp + 1] = pc[1];
+			Stack[sp + 2] = pc[2];
+			Stack[sp + 3] = pc[3];
 			sp += 4;
-			pc = (int*)((BYTE*)pc + 4);
-			break;
-
-		case PCD_PUSH5BYTES:
-			Stack[sp] = ((BYTE*)pc)[0];
-			Stack[sp + 1] = ((BYTE*)pc)[1];
-			Stack[sp + 2] = ((BYTE*)pc)[2];
-			Stack[sp + 3] = ((BYTE*)pc)[3];
-			Stack[sp + 4] = ((BYTE*)pc)[4];
+			pc += 4;
+			NEXTPCODE;
+
+		PCODE(PCD_PUSH5BYTES):
+			Stack[sp] = pc[0];
+			Stack[sp + 1] = pc[1];
+			Stack[sp + 2] = pc[2];
+			Stack[sp + 3] = pc[3];
+			Stack[sp + 4] = pc[4];
 			sp += 5;
-			pc = (int*)((BYTE*)pc + 5);
-			break;
+			pc += 5;
+			NEXTPCODE;
 
-		case PCD_PUSHBYTES:
-			temp = *(BYTE*)pc;
-			pc = (int*)((BYTE*)pc + temp + 1);
-			for (temp = -temp; temp; temp++)
+		PCODE(PCD_PUSHBYTES):
+			for (temp = NEXTWORD; temp; temp--)
 			{
-				PushToStack(*((BYTE*)pc + temp));
+				PushToStack(NEXTWORD);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DUP:
+		PCODE(PCD_DUP):
 			Stack[sp] = Stack[sp - 1];
 			sp++;
-			break;
+			NEXTPCODE;
 
-		case PCD_SWAP:
+		PCODE(PCD_SWAP):
 			std::swap(Stack[sp - 2], Stack[sp - 1]);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC1:
+		PCODE(PCD_LSPEC1):
 			ActivateLineSpecial(NEXTBYTE, activationline, activator,
 						STACK(1), 0, 0, 0, 0);
 			sp -= 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC2:
+		PCODE(PCD_LSPEC2):
 			ActivateLineSpecial(NEXTBYTE, activationline, activator,
 						STACK(2), STACK(1), 0, 0, 0);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC3:
+		PCODE(PCD_LSPEC3):
 			ActivateLineSpecial(NEXTBYTE, activationline, activator,
 						STACK(3), STACK(2), STACK(1), 0, 0);
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC4:
+		PCODE(PCD_LSPEC4):
 			ActivateLineSpecial(NEXTBYTE, activationline, activator,
 						STACK(4), STACK(3), STACK(2),
 						STACK(1), 0);
 			sp -= 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5:
+		PCODE(PCD_LSPEC5):
 			ActivateLineSpecial(NEXTBYTE, activationline, activator,
 						STACK(5), STACK(4), STACK(3),
 						STACK(2), STACK(1));
 			sp -= 5;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC1DIRECT:
+		PCODE(PCD_LSPEC1DIRECT):
 			temp = NEXTBYTE;
 			ActivateLineSpecial(temp, activationline, activator,
 						pc[0], 0, 0, 0, 0);
 			pc += 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC2DIRECT:
+		PCODE(PCD_LSPEC2DIRECT):
 			temp = NEXTBYTE;
 			ActivateLineSpecial(temp, activationline, activator,
 						pc[0], pc[1], 0, 0, 0);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC3DIRECT:
+		PCODE(PCD_LSPEC3DIRECT):
 			temp = NEXTBYTE;
 			ActivateLineSpecial(temp, activationline, activator,
 						pc[0], pc[1], pc[2], 0, 0);
 			pc += 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC4DIRECT:
+		PCODE(PCD_LSPEC4DIRECT):
 			temp = NEXTBYTE;
 			ActivateLineSpecial(temp, activationline, activator,
 						pc[0], pc[1], pc[2], pc[3], 0);
 			pc += 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5DIRECT:
+		PCODE(PCD_LSPEC5DIRECT):
 			temp = NEXTBYTE;
 			ActivateLineSpecial(temp, activationline, activator,
 						pc[0], pc[1], pc[2], pc[3], pc[4]);
 			pc += 5;
-			break;
-
-		case PCD_LSPEC1DIRECTB:
-			ActivateLineSpecial(((BYTE *)pc)[0], activationline, activator,
-				((BYTE *)pc)[1], 0, 0, 0, 0);
-			pc = (int *)((BYTE *)pc + 2);
-			break;
-
-		case PCD_LSPEC2DIRECTB:
-			ActivateLineSpecial(((BYTE *)pc)[0], activationline, activator,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], 0, 0, 0);
-			pc = (int *)((BYTE *)pc + 3);
-			break;
-
-		case PCD_LSPEC3DIRECTB:
-			ActivateLineSpecial(((BYTE *)pc)[0], activationline, activator,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3], 0, 0);
-			pc = (int *)((BYTE *)pc + 4);
-			break;
-
-		case PCD_LSPEC4DIRECTB:
-			ActivateLineSpecial(((BYTE *)pc)[0], activationline, activator,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3],
-				((BYTE *)pc)[4], 0);
-			pc = (int *)((BYTE *)pc + 5);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSPEC5DIRECTB:
-			ActivateLineSpecial(((BYTE *)pc)[0], activationline, activator,
-				((BYTE *)pc)[1], ((BYTE *)pc)[2], ((BYTE *)pc)[3],
-				((BYTE *)pc)[4], ((BYTE *)pc)[5]);
-			pc = (int *)((BYTE *)pc + 6);
-			break;
-
-		case PCD_CALL:
-		case PCD_CALLDISCARD: {
+		PCODE(PCD_CALL):
+		PCODE(PCD_CALLDISCARD): {
 			int funcnum;
 			int i;
 			ScriptFunction* func;
@@ -2398,17 +2866,17 @@ void DLevelScript::RunScript ()
 				Stack[sp + i] = 0;
 			}
 			sp += i;
-			((CallReturn*)&Stack[sp])->ReturnAddress = level.behavior->PC2Ofs(pc);
+			((CallReturn*)&Stack[sp])->ReturnAddress = pc - code;
 			((CallReturn*)&Stack[sp])->ReturnFunction = activeFunction;
 			((CallReturn*)&Stack[sp])->bDiscardResult = (pcd == PCD_CALLDISCARD);
 			sp += sizeof(CallReturn) / sizeof(int);
-			pc = level.behavior->Ofs2PC(func->Address);
+			pc = level.behavior->GetFunctionCode(funcnum);
 			activeFunction = func;
 		}
-		break;
+		NEXTPCODE;
 
-		case PCD_RETURNVOID:
-		case PCD_RETURNVAL: {
+		PCODE(PCD_RETURNVOID):
+		PCODE(PCD_RETURNVAL): {
 			int value;
 			CallReturn* retState;
 
@@ -2422,7 +2890,7 @@ void DLevelScript::RunScript ()
 			}
 			sp -= sizeof(CallReturn) / sizeof(int);
 			retState = (CallReturn*)&Stack[sp];
-			pc = level.behavior->Ofs2PC(retState->ReturnAddress);
+			pc = code + retState->ReturnAddress;
 			sp -= activeFunction->ArgCount + activeFunction->LocalCount;
 			activeFunction = retState->ReturnFunction;
 			if (activeFunction == NULL)
@@ -2439,24 +2907,24 @@ void DLevelScript::RunScript ()
 				Stack[sp++] = value;
 			}
 		}
-		break;
+		NEXTPCODE;
 
-		case PCD_ADD:
+		PCODE(PCD_ADD):
 			STACK(2) = STACK(2) + STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBTRACT:
+		PCODE(PCD_SUBTRACT):
 			STACK(2) = STACK(2) - STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULTIPLY:
+		PCODE(PCD_MULTIPLY):
 			STACK(2) = STACK(2) * STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVIDE:
+		PCODE(PCD_DIVIDE):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -2466,9 +2934,9 @@ void DLevelScript::RunScript ()
 				STACK(2) = STACK(2) / STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODULUS:
+		PCODE(PCD_MODULUS):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2478,237 +2946,237 @@ void DLevelScript::RunScript ()
 				STACK(2) = STACK(2) % STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_EQ:
+		PCODE(PCD_EQ):
 			STACK(2) = (STACK(2) == STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_NE:
+		PCODE(PCD_NE):
 			STACK(2) = (STACK(2) != STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LT:
+		PCODE(PCD_LT):
 			STACK(2) = (STACK(2) < STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_GT:
+		PCODE(PCD_GT):
 			STACK(2) = (STACK(2) > STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LE:
+		PCODE(PCD_LE):
 			STACK(2) = (STACK(2) <= STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_GE:
+		PCODE(PCD_GE):
 			STACK(2) = (STACK(2) >= STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNSCRIPTVAR:
+		PCODE(PCD_ASSIGNSCRIPTVAR):
 			locals[NEXTBYTE] = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNMAPVAR:
+		PCODE(PCD_ASSIGNMAPVAR):
 			level.vars[NEXTBYTE] = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNWORLDVAR:
+		PCODE(PCD_ASSIGNWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNGLOBALVAR:
+		PCODE(PCD_ASSIGNGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNMAPARRAY:
+		PCODE(PCD_ASSIGNMAPARRAY):
 			level.behavior->SetArrayVal(level.vars[NEXTBYTE], STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNWORLDARRAY:
+		PCODE(PCD_ASSIGNWORLDARRAY):
 			ACS_WorldArrays[NEXTBYTE][STACK(2)] = STACK(1);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_ASSIGNGLOBALARRAY:
+		PCODE(PCD_ASSIGNGLOBALARRAY):
 			ACS_GlobalArrays[NEXTBYTE][STACK(2)] = STACK(1);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHSCRIPTVAR:
+		PCODE(PCD_PUSHSCRIPTVAR):
 			PushToStack(locals[NEXTBYTE]);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHMAPVAR:
+		PCODE(PCD_PUSHMAPVAR):
 			PushToStack(level.vars[NEXTBYTE]);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHWORLDVAR:
+		PCODE(PCD_PUSHWORLDVAR):
 			PushToStack(ACS_WorldVars[NEXTBYTE]);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHGLOBALVAR:
+		PCODE(PCD_PUSHGLOBALVAR):
 			PushToStack(ACS_GlobalVars[NEXTBYTE]);
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHMAPARRAY:
+		PCODE(PCD_PUSHMAPARRAY):
 			STACK(1) = level.behavior->GetArrayVal(level.vars[NEXTBYTE], STACK(1));
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHWORLDARRAY:
+		PCODE(PCD_PUSHWORLDARRAY):
 			STACK(1) = ACS_WorldArrays[NEXTBYTE][STACK(1)];
-			break;
+			NEXTPCODE;
 
-		case PCD_PUSHGLOBALARRAY:
+		PCODE(PCD_PUSHGLOBALARRAY):
 			STACK(1) = ACS_GlobalArrays[NEXTBYTE][STACK(1)];
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDSCRIPTVAR:
+		PCODE(PCD_ADDSCRIPTVAR):
 			locals[NEXTBYTE] += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDMAPVAR:
+		PCODE(PCD_ADDMAPVAR):
 			level.vars[NEXTBYTE] += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDWORLDVAR:
+		PCODE(PCD_ADDWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDGLOBALVAR:
+		PCODE(PCD_ADDGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] += STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDMAPARRAY: {
+		PCODE(PCD_ADDMAPARRAY): {
 			int a = level.vars[NEXTBYTE];
 			int i = STACK(2);
 			level.behavior->SetArrayVal(a, i,
 			                            level.behavior->GetArrayVal(a, i) + STACK(1));
 			sp -= 2;
 		}
-		break;
+		NEXTPCODE;
 
-		case PCD_ADDWORLDARRAY:
+		PCODE(PCD_ADDWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] += STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ADDGLOBALARRAY:
+		PCODE(PCD_ADDGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] += STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBSCRIPTVAR:
+		PCODE(PCD_SUBSCRIPTVAR):
 			locals[NEXTBYTE] -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBMAPVAR:
+		PCODE(PCD_SUBMAPVAR):
 			level.vars[NEXTBYTE] -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBWORLDVAR:
+		PCODE(PCD_SUBWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBGLOBALVAR:
+		PCODE(PCD_SUBGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] -= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBMAPARRAY: {
+		PCODE(PCD_SUBMAPARRAY): {
 			int a = level.vars[NEXTBYTE];
 			int i = STACK(2);
 			level.behavior->SetArrayVal(a, i,
 			                            level.behavior->GetArrayVal(a, i) - STACK(1));
 			sp -= 2;
 		}
-		break;
+		NEXTPCODE;
 
-		case PCD_SUBWORLDARRAY:
+		PCODE(PCD_SUBWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] -= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SUBGLOBALARRAY:
+		PCODE(PCD_SUBGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] -= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MULSCRIPTVAR:
+		PCODE(PCD_MULSCRIPTVAR):
 			locals[NEXTBYTE] *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULMAPVAR:
+		PCODE(PCD_MULMAPVAR):
 			level.vars[NEXTBYTE] *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULWORLDVAR:
+		PCODE(PCD_MULWORLDVAR):
 			ACS_WorldVars[NEXTBYTE] *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULGLOBALVAR:
+		PCODE(PCD_MULGLOBALVAR):
 			ACS_GlobalVars[NEXTBYTE] *= STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_MULMAPARRAY: {
+		PCODE(PCD_MULMAPARRAY): {
 			int a = level.vars[NEXTBYTE];
 			int i = STACK(2);
 			level.behavior->SetArrayVal(a, i,
 			                            level.behavior->GetArrayVal(a, i) * STACK(1));
 			sp -= 2;
 		}
-		break;
+		NEXTPCODE;
 
-		case PCD_MULWORLDARRAY:
+		PCODE(PCD_MULWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(2)] *= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MULGLOBALARRAY:
+		PCODE(PCD_MULGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(2)] *= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVSCRIPTVAR:
+		PCODE(PCD_DIVSCRIPTVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -2718,9 +3186,9 @@ void DLevelScript::RunScript ()
 				locals[NEXTBYTE] /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVMAPVAR:
+		PCODE(PCD_DIVMAPVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -2730,9 +3198,9 @@ void DLevelScript::RunScript ()
 				level.vars[NEXTBYTE] /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVWORLDVAR:
+		PCODE(PCD_DIVWORLDVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -2742,9 +3210,9 @@ void DLevelScript::RunScript ()
 				ACS_WorldVars[NEXTBYTE] /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVGLOBALVAR:
+		PCODE(PCD_DIVGLOBALVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -2754,9 +3222,9 @@ void DLevelScript::RunScript ()
 				ACS_GlobalVars[NEXTBYTE] /= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVMAPARRAY:
+		PCODE(PCD_DIVMAPARRAY):
 			{
 				if (STACK(1) == 0)
 				{
@@ -2771,9 +3239,9 @@ void DLevelScript::RunScript ()
 				    sp -= 2;
 			    }
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVWORLDARRAY:
+		PCODE(PCD_DIVWORLDARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -2784,9 +3252,9 @@ void DLevelScript::RunScript ()
 				ACS_WorldArrays[a][STACK(2)] /= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DIVGLOBALARRAY:
+		PCODE(PCD_DIVGLOBALARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_DivideBy0;
@@ -2797,9 +3265,9 @@ void DLevelScript::RunScript ()
 				ACS_GlobalArrays[a][STACK(2)] /= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODSCRIPTVAR:
+		PCODE(PCD_MODSCRIPTVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2809,9 +3277,9 @@ void DLevelScript::RunScript ()
 				locals[NEXTBYTE] %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODMAPVAR:
+		PCODE(PCD_MODMAPVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2821,9 +3289,9 @@ void DLevelScript::RunScript ()
 				level.vars[NEXTBYTE] %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODWORLDVAR:
+		PCODE(PCD_MODWORLDVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2833,9 +3301,9 @@ void DLevelScript::RunScript ()
 				ACS_WorldVars[NEXTBYTE] %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODGLOBALVAR:
+		PCODE(PCD_MODGLOBALVAR):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2845,9 +3313,9 @@ void DLevelScript::RunScript ()
 				ACS_GlobalVars[NEXTBYTE] %= STACK(1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODMAPARRAY:
+		PCODE(PCD_MODMAPARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2860,9 +3328,9 @@ void DLevelScript::RunScript ()
 											level.behavior->GetArrayVal(a, i) % STACK(1));
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODWORLDARRAY:
+		PCODE(PCD_MODWORLDARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2873,9 +3341,9 @@ void DLevelScript::RunScript ()
 				ACS_WorldArrays[a][STACK(2)] %= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_MODGLOBALARRAY:
+		PCODE(PCD_MODGLOBALARRAY):
 			if (STACK(1) == 0)
 			{
 				state = SCRIPT_ModulusBy0;
@@ -2886,25 +3354,25 @@ void DLevelScript::RunScript ()
 				ACS_GlobalArrays[a][STACK(2)] %= STACK(1);
 				sp -= 2;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_INCSCRIPTVAR:
+		PCODE(PCD_INCSCRIPTVAR):
 			++locals[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_INCMAPVAR:
+		PCODE(PCD_INCMAPVAR):
 			++level.vars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_INCWORLDVAR:
+		PCODE(PCD_INCWORLDVAR):
 			++ACS_WorldVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_INCGLOBALVAR:
+		PCODE(PCD_INCGLOBALVAR):
 			++ACS_GlobalVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_INCMAPARRAY:
+		PCODE(PCD_INCMAPARRAY):
 			{
 				int a = level.vars[NEXTBYTE];
 				int i = STACK(2);
@@ -2912,41 +3380,41 @@ void DLevelScript::RunScript ()
 					level.behavior->GetArrayVal (a, i) + 1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_INCWORLDARRAY:
+		PCODE(PCD_INCWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(1)] += 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_INCGLOBALARRAY:
+		PCODE(PCD_INCGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(1)] += 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DECSCRIPTVAR:
+		PCODE(PCD_DECSCRIPTVAR):
 			--locals[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_DECMAPVAR:
+		PCODE(PCD_DECMAPVAR):
 			--level.vars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_DECWORLDVAR:
+		PCODE(PCD_DECWORLDVAR):
 			--ACS_WorldVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_DECGLOBALVAR:
+		PCODE(PCD_DECGLOBALVAR):
 			--ACS_GlobalVars[NEXTBYTE];
-			break;
+			NEXTPCODE;
 
-		case PCD_DECMAPARRAY:
+		PCODE(PCD_DECMAPARRAY):
 			{
 				int a = level.vars[NEXTBYTE];
 				int i = STACK(2);
@@ -2954,184 +3422,173 @@ void DLevelScript::RunScript ()
 					level.behavior->GetArrayVal (a, i) - 1);
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DECWORLDARRAY:
+		PCODE(PCD_DECWORLDARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_WorldArrays[a][STACK(1)] -= 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_DECGLOBALARRAY:
+		PCODE(PCD_DECGLOBALARRAY):
 			{
 				int a = NEXTBYTE;
 				ACS_GlobalArrays[a][STACK(1)] -= 1;
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GOTO:
-			pc = level.behavior->Ofs2PC (*pc);
-			break;
+		PCODE(PCD_GOTO):
+			pc = code + *pc;
+			NEXTPCODE;
 
-		case PCD_IFGOTO:
+		PCODE(PCD_IFGOTO):
 			if (STACK(1))
-				pc = level.behavior->Ofs2PC (*pc);
+				pc = code + *pc;
 			else
 				pc++;
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_DROP:
+		PCODE(PCD_DROP):
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_DELAY:
+		PCODE(PCD_DELAY):
 			state = SCRIPT_Delayed;
 			statedata = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_DELAYDIRECT:
+		PCODE(PCD_DELAYDIRECT):
 			state = SCRIPT_Delayed;
 			statedata = NEXTWORD;
-			break;
+			NEXTPCODE;
 
-		case PCD_DELAYDIRECTB:
-			state = SCRIPT_Delayed;
-			statedata = *(BYTE *)pc;
-			pc = (int *)((BYTE *)pc + 1);
-			break;
-
-		case PCD_RANDOM:
+		PCODE(PCD_RANDOM):
 			STACK(2) = Random (STACK(2), STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RANDOMDIRECT:
+		PCODE(PCD_RANDOMDIRECT):
 			PushToStack (Random (pc[0], pc[1]));
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_RANDOMDIRECTB:
-			PushToStack (Random (((BYTE *)pc)[0], ((BYTE *)pc)[1]));
-			pc = (int *)((BYTE *)pc + 2);
-			break;
-
-		case PCD_THINGCOUNT:
+		PCODE(PCD_THINGCOUNT):
 			STACK(2) = ThingCount (STACK(2), STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGCOUNTDIRECT:
+		PCODE(PCD_THINGCOUNTDIRECT):
 			PushToStack (ThingCount (pc[0], pc[1]));
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_TAGWAIT:
+		PCODE(PCD_TAGWAIT):
 			state = SCRIPT_TagWait;
 			statedata = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_TAGWAITDIRECT:
+		PCODE(PCD_TAGWAITDIRECT):
 			state = SCRIPT_TagWait;
 			statedata = NEXTWORD;
-			break;
+			NEXTPCODE;
 
-		case PCD_POLYWAIT:
+		PCODE(PCD_POLYWAIT):
 			state = SCRIPT_PolyWait;
 			statedata = STACK(1);
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_POLYWAITDIRECT:
+		PCODE(PCD_POLYWAITDIRECT):
 			state = SCRIPT_PolyWait;
 			statedata = NEXTWORD;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGEFLOOR:
+		PCODE(PCD_CHANGEFLOOR):
 			ChangeFlat (STACK(2), STACK(1), 0);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGEFLOORDIRECT:
+		PCODE(PCD_CHANGEFLOORDIRECT):
 			ChangeFlat (pc[0], pc[1], 0);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGECEILING:
+		PCODE(PCD_CHANGECEILING):
 			ChangeFlat (STACK(2), STACK(1), 1);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHANGECEILINGDIRECT:
+		PCODE(PCD_CHANGECEILINGDIRECT):
 			ChangeFlat (pc[0], pc[1], 1);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_RESTART:
+		PCODE(PCD_RESTART):
 			pc = level.behavior->FindScript (script);
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDLOGICAL:
+		PCODE(PCD_ANDLOGICAL):
 			STACK(2) = (STACK(2) && STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORLOGICAL:
+		PCODE(PCD_ORLOGICAL):
 			STACK(2) = (STACK(2) || STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ANDBITWISE:
+		PCODE(PCD_ANDBITWISE):
 			STACK(2) = (STACK(2) & STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_ORBITWISE:
+		PCODE(PCD_ORBITWISE):
 			STACK(2) = (STACK(2) | STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_EORBITWISE:
+		PCODE(PCD_EORBITWISE):
 			STACK(2) = (STACK(2) ^ STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_NEGATELOGICAL:
+		PCODE(PCD_NEGATELOGICAL):
 			STACK(1) = !STACK(1);
-			break;
+			NEXTPCODE;
 
-		case PCD_LSHIFT:
+		PCODE(PCD_LSHIFT):
 			STACK(2) = (STACK(2) << STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_RSHIFT:
+		PCODE(PCD_RSHIFT):
 			STACK(2) = (STACK(2) >> STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_UNARYMINUS:
+		PCODE(PCD_UNARYMINUS):
 			STACK(1) = -STACK(1);
-			break;
+			NEXTPCODE;
 
-		case PCD_IFNOTGOTO:
+		PCODE(PCD_IFNOTGOTO):
 			if (!STACK(1))
-				pc = level.behavior->Ofs2PC (*pc);
+				pc = code + *pc;
 			else
 				pc++;
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_LINESIDE:
+		PCODE(PCD_LINESIDE):
 			PushToStack (lineSide);
-			break;
+			NEXTPCODE;
 
-		case PCD_SCRIPTWAIT:
+		PCODE(PCD_SCRIPTWAIT):
 			statedata = STACK(1);
 			if (controller->RunningScripts[statedata])
 				state = SCRIPT_ScriptWait;
@@ -3139,38 +3596,38 @@ void DLevelScript::RunScript ()
 				state = SCRIPT_ScriptWaitPre;
 			sp--;
 			PutLast ();
-			break;
+			NEXTPCODE;
 
-		case PCD_SCRIPTWAITDIRECT:
+		PCODE(PCD_SCRIPTWAITDIRECT):
 			state = SCRIPT_ScriptWait;
 			statedata = NEXTWORD;
 			PutLast ();
-			break;
+			NEXTPCODE;
 
-		case PCD_CLEARLINESPECIAL:
+		PCODE(PCD_CLEARLINESPECIAL):
 			if (activationline)
 				activationline->special = 0;
-			break;
+			NEXTPCODE;
 
-		case PCD_CASEGOTO:
+		PCODE(PCD_CASEGOTO):
 			if (STACK(1) == NEXTWORD)
 			{
-				pc = level.behavior->Ofs2PC (*pc);
+				pc = code + *pc;
 				sp--;
 			}
 			else
 			{
 				pc++;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_BEGINPRINT:
+		PCODE(PCD_BEGINPRINT):
 			workwhere = work;
 			work[0] = 0;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTSTRING:
-		case PCD_PRINTLOCALIZED:
+		PCODE(PCD_PRINTSTRING):
+		PCODE(PCD_PRINTLOCALIZED):
 			lookup = (pcd == PCD_PRINTSTRING ?
 				level.behavior->LookupString (STACK(1)) :
 				level.behavior->LocalizeString (STACK(1)));
@@ -3179,28 +3636,28 @@ void DLevelScript::RunScript ()
 				workwhere += snprintf(workwhere, 4096, "%s", lookup);
 			}
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTNUMBER:
+		PCODE(PCD_PRINTNUMBER):
 			workwhere += snprintf(workwhere, 4096, "%d", STACK(1));
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTCHARACTER:
+		PCODE(PCD_PRINTCHARACTER):
 			workwhere[0] = STACK(1);
 			workwhere[1] = 0;
 			workwhere++;
 			--sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_PRINTFIXED:
+		PCODE(PCD_PRINTFIXED):
 			workwhere += snprintf(workwhere, 4096, "%g", FIXED2FLOAT(STACK(1)));
 			--sp;
-			break;
+			NEXTPCODE;
 
 		// [BC] Print activator's name
 		// [RH] Fancied up a bit
-		case PCD_PRINTNAME:
+		PCODE(PCD_PRINTNAME):
 			{
 				player_t *player = NULL;
 
@@ -3238,10 +3695,10 @@ void DLevelScript::RunScript ()
 				}
 				sp--;
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ENDPRINT:
-		case PCD_ENDPRINTBOLD:
+		PCODE(PCD_ENDPRINT):
+		PCODE(PCD_ENDPRINTBOLD):
 		//case PCD_MOREHUDMESSAGE:
 			strbin (work);
 			if (pcd != PCD_MOREHUDMESSAGE)
@@ -3252,14 +3709,14 @@ void DLevelScript::RunScript ()
 			{
 //				optstart = -1;
 			}
-			break;
+			NEXTPCODE;
 
-		/*case PCD_OPTHUDMESSAGE:
+		/*PCODE(PCD_OPTHUDMESSAGE):
 			optstart = sp;
-			break;
+			NEXTPCODE;
 
-		case PCD_ENDHUDMESSAGE:
-		case PCD_ENDHUDMESSAGEBOLD:
+		PCODE(PCD_ENDHUDMESSAGE):
+		PCODE(PCD_ENDHUDMESSAGEBOLD):
 			if (optstart == -1)
 			{
 				optstart = sp;
@@ -3302,21 +3759,21 @@ void DLevelScript::RunScript ()
 			sp = optstart-6;
 			break;
         */
-		/*case PCD_SETFONT:
+		/*PCODE(PCD_SETFONT):
 			DoSetFont (STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETFONTDIRECT:
+		PCODE(PCD_SETFONTDIRECT):
 			DoSetFont (pc[0]);
 			pc++;
 			break;
         */
-		case PCD_PLAYERCOUNT:
+		PCODE(PCD_PLAYERCOUNT):
 			PushToStack (CountPlayers ());
-			break;
+			NEXTPCODE;
 
-		case PCD_GAMETYPE:
+		PCODE(PCD_GAMETYPE):
 		    if (sv_gametype == 3)
                 PushToStack (GAME_NET_CTF);
             else if (sv_gametype == 2)
@@ -3327,97 +3784,97 @@ void DLevelScript::RunScript ()
 				PushToStack (GAME_NET_COOPERATIVE);
 			else
 				PushToStack (GAME_SINGLE_PLAYER);
-			break;
+			NEXTPCODE;
 
-		case PCD_GAMESKILL:
+		PCODE(PCD_GAMESKILL):
 			PushToStack (sv_skill);
-			break;
+			NEXTPCODE;
 
 // [BC] Start ST PCD's
-		case PCD_PLAYERHEALTH:
+		PCODE(PCD_PLAYERHEALTH):
 			if (activator)
 				PushToStack (activator->health);
 			else
 				PushToStack (0);
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERARMORPOINTS:
+		PCODE(PCD_PLAYERARMORPOINTS):
 			if (activator && activator->player)
 				PushToStack (activator->player->armorpoints);
 			else
 				PushToStack (0);
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERFRAGS:
+		PCODE(PCD_PLAYERFRAGS):
 			if (activator && activator->player)
 				PushToStack (activator->player->fragcount);
 			else
 				PushToStack (0);
-			break;
+			NEXTPCODE;
 
-		case PCD_MUSICCHANGE:
+		PCODE(PCD_MUSICCHANGE):
 			ChangeMusic(pcd, activator, STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SINGLEPLAYER:
+		PCODE(PCD_SINGLEPLAYER):
 			PushToStack (!multiplayer);
-			break;
+			NEXTPCODE;
 // [BC] End ST PCD's
 
-		case PCD_TIMER:
+		PCODE(PCD_TIMER):
 			PushToStack (level.time);
-			break;
+			NEXTPCODE;
 
-		case PCD_SECTORSOUND:
+		PCODE(PCD_SECTORSOUND):
 			if (activationline)
 				StartSectorSound(pcd, activationline->frontsector, CHAN_BODY, STACK(2), STACK(1), ATTN_NORM);
 			else
 				StartSound(pcd, NULL, CHAN_BODY, STACK(2), STACK(1), ATTN_NORM);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_AMBIENTSOUND:
+		PCODE(PCD_AMBIENTSOUND):
 			StartSound(pcd, activator, CHAN_AUTO, STACK(2), STACK(1), ATTN_NONE);
-			break;
+			NEXTPCODE;
 
-		case PCD_LOCALAMBIENTSOUND:
+		PCODE(PCD_LOCALAMBIENTSOUND):
 			StartSound(pcd, activator, CHAN_AUTO, STACK(2), STACK(1), ATTN_NONE);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_ACTIVATORSOUND:
+		PCODE(PCD_ACTIVATORSOUND):
 			StartThingSound(pcd, activator, CHAN_AUTO, STACK(2), STACK(1), ATTN_NORM);
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SOUNDSEQUENCE:
+		PCODE(PCD_SOUNDSEQUENCE):
 			if (activationline)
 				StartSoundSequence(activationline->frontsector, STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETLINETEXTURE:
+		PCODE(PCD_SETLINETEXTURE):
 			SetLineTexture (STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETLINEBLOCKING:
+		PCODE(PCD_SETLINEBLOCKING):
 			SetLineBlocking(STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETLINEMONSTERBLOCKING:
+		PCODE(PCD_SETLINEMONSTERBLOCKING):
 			SetLineMonsterBlocking(STACK(2), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETLINESPECIAL:
+		PCODE(PCD_SETLINESPECIAL):
 			SetLineSpecial(STACK(7), STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 7;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETTHINGSPECIAL:
+		PCODE(PCD_SETTHINGSPECIAL):
 		{
 			FActorIterator iterator (STACK(7));
 			AActor *actor;
@@ -3426,9 +3883,9 @@ void DLevelScript::RunScript ()
 				SetThingSpecial(actor, STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 7;
 		}
-			break;
+			NEXTPCODE;
 
-		case PCD_THINGSOUND:
+		PCODE(PCD_THINGSOUND):
 		{
 			FActorIterator iterator(STACK(3));
 			AActor *spot;
@@ -3436,135 +3893,135 @@ void DLevelScript::RunScript ()
 				StartThingSound(pcd, spot, CHAN_BODY, STACK(2), STACK(1), ATTN_NORM);
 			sp -= 3;
 		}
-			break;
+			NEXTPCODE;
 
-		case PCD_FIXEDMUL:
+		PCODE(PCD_FIXEDMUL):
 			STACK(2) = FixedMul (STACK(2), STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_FIXEDDIV:
+		PCODE(PCD_FIXEDDIV):
 			STACK(2) = FixedDiv (STACK(2), STACK(1));
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETGRAVITY:
+		PCODE(PCD_SETGRAVITY):
 			level.gravity = (float)STACK(1) / 65536.f;
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETGRAVITYDIRECT:
+		PCODE(PCD_SETGRAVITYDIRECT):
 			level.gravity = (float)pc[0] / 65536.f;
 			pc++;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETAIRCONTROL:
+		PCODE(PCD_SETAIRCONTROL):
 			level.aircontrol = STACK(1);
 			sp--;
 			G_AirControlChanged ();
-			break;
+			NEXTPCODE;
 
-		case PCD_SETAIRCONTROLDIRECT:
+		PCODE(PCD_SETAIRCONTROLDIRECT):
 			level.aircontrol = pc[0];
 			pc++;
 			G_AirControlChanged ();
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWN:
+		PCODE(PCD_SPAWN):
 			STACK(6) = DoSpawn (STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 5;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNDIRECT:
+		PCODE(PCD_SPAWNDIRECT):
 			PushToStack (DoSpawn (pc[0], pc[1], pc[2], pc[3], pc[4], pc[5]));
 			pc += 6;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNSPOT:
+		PCODE(PCD_SPAWNSPOT):
 			STACK(4) = DoSpawnSpot (STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_SPAWNSPOTDIRECT:
+		PCODE(PCD_SPAWNSPOTDIRECT):
 			PushToStack (DoSpawnSpot (pc[0], pc[1], pc[2], pc[3]));
 			pc += 4;
-			break;
+			NEXTPCODE;
 
-		case PCD_CLEARINVENTORY:
+		PCODE(PCD_CLEARINVENTORY):
 			ClearInventory (activator);
-			break;
+			NEXTPCODE;
 
-		case PCD_GIVEINVENTORY:
+		PCODE(PCD_GIVEINVENTORY):
 			GiveInventory (activator, level.behavior->LookupString (STACK(2)), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_GIVEINVENTORYDIRECT:
+		PCODE(PCD_GIVEINVENTORYDIRECT):
 			GiveInventory (activator, level.behavior->LookupString (pc[0]), pc[1]);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_TAKEINVENTORY:
+		PCODE(PCD_TAKEINVENTORY):
 			TakeInventory (activator, level.behavior->LookupString (STACK(2)), STACK(1));
 			sp -= 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_TAKEINVENTORYDIRECT:
+		PCODE(PCD_TAKEINVENTORYDIRECT):
 			TakeInventory (activator, level.behavior->LookupString (pc[0]), pc[1]);
 			pc += 2;
-			break;
+			NEXTPCODE;
 
-		case PCD_CHECKINVENTORY:
+		PCODE(PCD_CHECKINVENTORY):
 			STACK(1) = CheckInventory (activator, level.behavior->LookupString (STACK(1)));
-			break;
+			NEXTPCODE;
 
-		case PCD_CHECKINVENTORYDIRECT:
+		PCODE(PCD_CHECKINVENTORYDIRECT):
 			PushToStack (CheckInventory (activator, level.behavior->LookupString (pc[0])));
 			pc += 1;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETMUSIC:
+		PCODE(PCD_SETMUSIC):
 			ChangeMusic(pcd, NULL, STACK(3), STACK(2));
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETMUSICDIRECT:
+		PCODE(PCD_SETMUSICDIRECT):
 			ChangeMusic(pcd, NULL, pc[0], pc[1]);
 			pc += 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LOCALSETMUSIC:
+		PCODE(PCD_LOCALSETMUSIC):
 			ChangeMusic(pcd, activator, STACK(3), STACK(2));
 			sp -= 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_LOCALSETMUSICDIRECT:
+		PCODE(PCD_LOCALSETMUSICDIRECT):
 			ChangeMusic(pcd, activator, pc[0], pc[1]);
 			pc += 3;
-			break;
+			NEXTPCODE;
 
-		case PCD_FADETO:
+		PCODE(PCD_FADETO):
 			DoFadeTo (activator, STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 5;
-			break;
+			NEXTPCODE;
 
-		case PCD_FADERANGE:
+		PCODE(PCD_FADERANGE):
 			DoFadeRange (activator, STACK(9), STACK(8), STACK(7), STACK(6),
 						 STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 9;
-			break;
+			NEXTPCODE;
 
-		case PCD_CANCELFADE:
+		PCODE(PCD_CANCELFADE):
 			CancelFade(activator);
-			break;
+			NEXTPCODE;
 
-		/*case PCD_PLAYMOVIE:
+		/*PCODE(PCD_PLAYMOVIE):
 			STACK(1) = I_PlayMovie (level.behavior->LookupString (STACK(1)));
 			break;
         */
-		case PCD_GETACTORX:
-		case PCD_GETACTORY:
-		case PCD_GETACTORZ:
+		PCODE(PCD_GETACTORX):
+		PCODE(PCD_GETACTORY):
+		PCODE(PCD_GETACTORZ):
 			{
 			    AActor *actor = SingleActorFromTID(STACK(1), activator);
 
@@ -3577,9 +4034,9 @@ void DLevelScript::RunScript ()
 					STACK(1) = (&actor->x)[pcd - PCD_GETACTORX];
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_GETACTORANGLE:
+		PCODE(PCD_GETACTORANGLE):
 			{
 				AActor *actor = SingleActorFromTID (STACK(1), activator);
 
@@ -3592,21 +4049,21 @@ void DLevelScript::RunScript ()
 					STACK(1) = actor->angle >> FRACBITS;
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETFLOORTRIGGER:
+		PCODE(PCD_SETFLOORTRIGGER):
 			new DPlaneWatcher (activator, activationline, lineSide, false, STACK(8),
 				STACK(7), STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 8;
-			break;
+			NEXTPCODE;
 
-		case PCD_SETCEILINGTRIGGER:
+		PCODE(PCD_SETCEILINGTRIGGER):
 			new DPlaneWatcher (activator, activationline, lineSide, true, STACK(8),
 				STACK(7), STACK(6), STACK(5), STACK(4), STACK(3), STACK(2), STACK(1));
 			sp -= 8;
-			break;
+			NEXTPCODE;
 
-		/*case PCD_STARTTRANSLATION:
+		/*PCODE(PCD_STARTTRANSLATION):
 			{
 				int i = STACK(1);
 				sp--;
@@ -3619,9 +4076,9 @@ void DLevelScript::RunScript ()
 					}
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_TRANSLATIONRANGE1:
+		PCODE(PCD_TRANSLATIONRANGE1):
 			{ // translation using palette shifting
 				int start = STACK(4);
 				int end = STACK(3);
@@ -3651,9 +4108,9 @@ void DLevelScript::RunScript ()
 					translation[i] = palcol >> FRACBITS;
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_TRANSLATIONRANGE2:
+		PCODE(PCD_TRANSLATIONRANGE2):
 			{ // translation using RGB values
 			  // (would HSV be a good idea too?)
 				int start = STACK(8);
@@ -3709,43 +4166,43 @@ void DLevelScript::RunScript ()
 					b += bs;
 				}
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_ENDTRANSLATION:
+		PCODE(PCD_ENDTRANSLATION):
 			// This might be useful for hardware rendering, but
 			// for software it is superfluous.
 			translation = NULL;
 			break;
         */
 
-		case PCD_SIN:
+		PCODE(PCD_SIN):
 			STACK(1) = finesine[(STACK(1)<<16)>>ANGLETOFINESHIFT];
-			break;
+			NEXTPCODE;
 
-		case PCD_COS:
+		PCODE(PCD_COS):
 			STACK(1) = finecosine[(STACK(1)<<16)>>ANGLETOFINESHIFT];
-			break;
+			NEXTPCODE;
 
-		case PCD_VECTORANGLE:
+		PCODE(PCD_VECTORANGLE):
 			STACK(2) = R_PointToAngle2 (0, 0, STACK(2), STACK(1)) >> 16;
 			sp--;
-			break;
+			NEXTPCODE;
 
-		case PCD_PLAYERNUMBER:
+		PCODE(PCD_PLAYERNUMBER):
 			if (activator == NULL || activator->player == NULL)
 				PushToStack(-1);
 			else
 				PushToStack(activator->player->GetPlayerNumber());
-			break;
+			NEXTPCODE;
 
-		case PCD_ACTIVATORTID:
+		PCODE(PCD_ACTIVATORTID):
 			if (activator == NULL)
 				PushToStack(0);
 			else
 				PushToStack(activator->tid);
-			break;
+			NEXTPCODE;
 
-		case PCD_GETCVAR: {
+		PCODE(PCD_GETCVAR): {
 			cvar_t *var, *prev;
 			var = cvar_t::FindCVar(level.behavior->LookupString(STACK(1)), &prev);
 			if (var == NULL)
@@ -3757,9 +4214,9 @@ void DLevelScript::RunScript ()
 				STACK(1) = (int)var->value();
 			}
 		}
-		break;
+		NEXTPCODE;
 
-		case PCD_GETLEVELINFO:
+		PCODE(PCD_GETLEVELINFO):
 			switch (STACK(1))
 			{
 			case LEVELINFO_PAR_TIME:
@@ -3796,9 +4253,9 @@ void DLevelScript::RunScript ()
 				STACK(1) = 0;
 				break;
 			}
-			break;
+			NEXTPCODE;
 
-		/*case PCD_CHECKWEAPON:
+		/*PCODE(PCD_CHECKWEAPON):
 			if (activator == NULL || activator->player == NULL)
 			{ // Non-players do not have ready weapons
 				STACK(1) = 0;
@@ -3808,9 +4265,9 @@ void DLevelScript::RunScript ()
 				STACK(1) = 0 == strcmp (level.behavior->LookupString (STACK(1)),
 					wpnlev1info[activator->player->readyweapon]->type->Name+1);
 			}
-			break;
+			NEXTPCODE;
 
-		case PCD_SETWEAPON:
+		PCODE(PCD_SETWEAPON):
 			if (activator == NULL || activator->player == NULL)
 			{
 				STACK(1) = 0;
@@ -3866,7 +4323,10 @@ void DLevelScript::RunScript ()
 			return;
 
 		if (controller->RunningScripts[script] == this)
+		{
 			controller->RunningScripts[script] = NULL;
+			controller->Wake (DACSThinker::WAIT_ScriptEnd, script);
+		}
 		this->Destroy ();
 	}
 }
@@ -3907,6 +4367,7 @@ DLevelScript::DLevelScript (AActor *who, line_t *where, int num, int *code, int
 	activator = who;
 	activationline = where;
 	lineSide = lineside;
+	parked = false;
 	if (delay) {
 		// From Hexen: Give the world some time to set itself up before
 		// running open scripts.
@@ -3918,13 +4379,25 @@ DLevelScript::DLevelScript (AActor *who, line_t *where, int num, int *code, int
 	}
 
 	if (!always)
+	{
 		DACSThinker::ActiveThinker->RunningScripts[num] = this;
+		DACSThinker::ActiveThinker->Wake (DACSThinker::WAIT_ScriptStart, num);
+	}
 
 	Link ();
 
 	DPrintf ("Script %d started.\n", num);
 }
 
+void DLevelScript::SetState (EScriptState newstate)
+{
+	// Whatever it was waiting for does not matter anymore
+	if (parked && DACSThinker::ActiveThinker)
+		DACSThinker::ActiveThinker->Unpark (this);
+
+	state = newstate;
+}
+
 static void SetScriptState (int script, DLevelScript::EScriptState state)
 {
 	DACSThinker *controller = DACSThinker::ActiveThinker;
@@ -4195,10 +4668,160 @@ void DACSThinker::DumpScriptStatus ()
 
 	while (script != NULL)
 	{
-		Printf (PRINT_HIGH,"%d: %s\n", script->script, stateNames[script->state]);
+		Printf (PRINT_HIGH,"%d: %s%s\n", script->script, stateNames[script->state],
+			script->parked ? " (parked)" : "");
 		script = script->next;
 	}
 }
 
+BEGIN_COMMAND (scriptwaits)
+{
+	if (DACSThinker::ActiveThinker == NULL)
+	{
+		Printf (PRINT_HIGH,"No scripts are running.\n");
+	}
+	else
+	{
+		DACSThinker::ActiveThinker->DumpWaitingScripts ();
+	}
+}
+END_COMMAND (scriptwaits)
+
+void DACSThinker::DumpWaitingScripts ()
+{
+	static const char *waitFormats[NUM_WAITQUEUES] =
+	{
+		"%d: Waiting for sectors tagged %d\n",
+		"%d: Waiting for polyobject %d\n",
+		"%d: Waiting for script %d to start\n",
+		"%d: Waiting for script %d to finish\n"
+	};
+	int parked = 0;
+
+	for (int i = 0; i < NUM_WAITQUEUES; ++i)
+	{
+		for (WaitQueue::const_iterator it = WaitQueues[i].begin(); it != WaitQueues[i].end(); ++it)
+		{
+			for (size_t j = 0; j < it->second.size(); ++j)
+			{
+				Printf (PRINT_HIGH, waitFormats[i], it->second[j]->script, it->first);
+				parked++;
+			}
+		}
+	}
+
+	Printf (PRINT_HIGH, "%d scripts parked\n", parked);
+}
+
+//
+// acsbench
+//
+// Times the interpreter by running a script from any BEHAVIOR lump in place
+// of the map's own, over and over. Delays are not waited out, the script is
+// just run again straight away.
+//
+// The script still acts on the live level, so this is refused while anyone
+// else could be playing. Scripts run against a scratch DACSThinker, so that
+// anything they start is destroyed along with the borrowed BEHAVIOR and the
+// map's own scripts are never touched.
+//
+BEGIN_COMMAND (acsbench)
+{
+	if (argc < 3)
+	{
+		Printf (PRINT_HIGH, "Usage: acsbench <lump> <script> [runs]\n");
+		return;
+	}
+
+	if (gamestate != GS_LEVEL)
+	{
+		Printf (PRINT_HIGH, "acsbench: Not in a level.\n");
+		return;
+	}
+
+	if (multiplayer && (!serverside || !players.empty ()))
+	{
+		Printf (PRINT_HIGH, "acsbench: Only available offline or on an empty server.\n");
+		return;
+	}
+
+	const int lumpnum = W_CheckNumForName (argv[1]);
+	if (lumpnum < 0 || W_LumpLength (lumpnum) < 8)
+	{
+		Printf (PRINT_HIGH, "acsbench: No BEHAVIOR lump named %s.\n", argv[1]);
+		return;
+	}
+
+	const int script = atoi (argv[2]);
+	const int runs = argc > 3 ? MAX (atoi (argv[3]), 1) : 1000;
+
+	// FBehavior fixes up the lump it is given and sets map variables, so
+	// hand it a copy and put the variables back afterwards.
+	const int len = W_LumpLength (lumpnum);
+	BYTE *object = new BYTE[len];
+	W_ReadLump (lumpnum, object);
+
+	SDWORD mapvars[NUM_MAPVARS];
+	int worldvars[NUM_WORLDVARS], globalvars[NUM_GLOBALVARS];
+	memcpy (mapvars, level.vars, sizeof(mapvars));
+	memcpy (worldvars, ACS_WorldVars, sizeof(worldvars));
+	memcpy (globalvars, ACS_GlobalVars, sizeof(globalvars));
+
+	FBehavior *mapbehavior = level.behavior;
+	level.behavior = new FBehavior (object, len);
+
+	DACSThinker *mapthinker = DACSThinker::ActiveThinker;
+	DACSThinker::ActiveThinker = NULL;
+	DACSThinker *scratch = new DACSThinker;
+
+	int *code = level.behavior->IsGood () ? level.behavior->FindScript (script) : NULL;
+
+	if (code == NULL)
+	{
+		Printf (PRINT_HIGH, "acsbench: %s has no script %d.\n", argv[1], script);
+	}
+	else
+	{
+		int tics = 0, unfinished = 0;
+		dtime_t start = I_GetTime ();
+
+		for (int run = 0; run < runs; ++run)
+		{
+			DLevelScript *ls = new DLevelScript (NULL, NULL, script, code, 0, 0, 0, 0, true, false);
+
+			for (int tic = 0; ls->GetState () != DLevelScript::SCRIPT_PleaseRemove; ++tic, ++tics)
+			{
+				// Give up on scripts still waiting after a minute of game time
+				if (tic == 60 * TICRATE)
+				{
+					ls->SetState (DLevelScript::SCRIPT_PleaseRemove);
+					unfinished++;
+				}
+				ls->RunScript ();
+			}
+		}
+
+		const double elapsed = (double)(I_GetTime () - start);
+
+		Printf (PRINT_HIGH, "%d runs of script %d (%d words of code) in %.2f ms, %.2f us per run\n",
+			runs, script, level.behavior->GetCodeSize (), elapsed / 1e6, elapsed / runs / 1e3);
+		Printf (PRINT_HIGH, "%d tics run, %d runs did not finish\n", tics, unfinished);
+	}
+
+	// Nothing may run the borrowed code once it is gone
+	scratch->DestroyScripts ();
+	scratch->Destroy ();
+	DACSThinker::ActiveThinker = mapthinker;
+
+	delete level.behavior;
+	level.behavior = mapbehavior;
+	delete[] object;
+
+	memcpy (level.vars, mapvars, sizeof(mapvars));
+	memcpy (ACS_WorldVars, worldvars, sizeof(worldvars));
+	memcpy (ACS_GlobalVars, globalvars, sizeof(globalvars));
+}
+END_COMMAND (acsbench)
+
 
 VERSION_CONTROL (p_acs_cpp, "$Id$")
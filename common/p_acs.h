@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <map>
+#include <vector>
+
 #include "dobject.h"
 #include "r_defs.h"
 
@@ -70,10 +73,13 @@ public:
 	const char *LookupString (DWORD index, DWORD ofs=0) const;
 	const char *LocalizeString (DWORD index) const;
 	void StartTypedScripts (WORD type, AActor *activator, int arg0=0, int arg1=0, int arg2=0, bool always = true) const;
-	DWORD PC2Ofs (int *pc) const { return (BYTE *)pc - Data; }
-	int *Ofs2PC (DWORD ofs) const { return (int *)(Data + ofs); }
+	DWORD PC2Ofs (int *pc) const;
+	int *Ofs2PC (DWORD ofs) const;
+	int *GetCode () const { return Code; }
+	int GetCodeSize () const { return CodeSize; }
 	ACSFormat GetFormat() const { return Format; }
 	ScriptFunction *GetFunction (int funcnum) const;
+	int *GetFunctionCode (int funcnum) const { return Code + FunctionCode[funcnum]; }
 	int GetArrayVal (int arraynum, int index) const;
 	void SetArrayVal (int arraynum, int index, int value);
 
@@ -94,7 +100,17 @@ private:
 	DWORD LanguageNeutral;
 	DWORD Localized;
 
+	// Scripts do not run from Data but from a translation of it, where every
+	// p-code and operand is one native word and jumps hold indices into Code.
+	// Saved games still refer to the p-codes by their offset into Data.
+	int *Code;
+	int CodeSize;
+	DWORD *CodeOfs;					// Offset into Data of every word in Code
+	std::map<DWORD, int> CodeIndex;	// Offset into Data -> index into Code
+	int *FunctionCode;				// Index into Code of every function
+
 	static int STACK_ARGS SortScripts (const void *a, const void *b);
+	void TranslateCode ();
 	void AddLanguage (DWORD lang);
 	DWORD FindLanguage (DWORD lang, bool ignoreregion) const;
 	DWORD *CheckIfInList (DWORD lang);
@@ -457,8 +473,9 @@ public:
 
 	void RunScript ();
 
-	inline void SetState (EScriptState newstate) { state = newstate; }
+	void SetState (EScriptState newstate);
 	inline EScriptState GetState () { return state; }
+	inline bool IsParked () const { return parked; }
 
 	void *operator new (size_t size);
 	void operator delete (void *block);
@@ -475,6 +492,7 @@ protected:
 	line_t			*activationline;
 	int				lineSide;
 	int				stringstart;
+	bool			parked;		// On one of DACSThinker's wait queues
 
 	inline void PushToStack (int val);
 
@@ -531,16 +549,39 @@ public:
 	~DACSThinker ();
 
 	void RunThink ();
+	void DestroyScripts ();
 
 	DLevelScript *RunningScripts[1000];	// Array of all synchronous scripts
 	static DACSThinker *ActiveThinker;
 
     void DumpScriptStatus();
+	void DumpWaitingScripts();
+
+	// Scripts waiting on something are parked in a queue keyed by what they
+	// wait for, and skipped until an event for that key wakes them up to
+	// check again.
+	enum EWaitQueue
+	{
+		WAIT_Tag,			// Movers in sectors with a tag
+		WAIT_Poly,			// A polyobject's mover
+		WAIT_ScriptStart,	// A script to start
+		WAIT_ScriptEnd,		// A script to finish
+		NUM_WAITQUEUES
+	};
+
+	void Park (DLevelScript *script);
+	void Unpark (DLevelScript *script);
+	void Wake (EWaitQueue queue, int key);
 
 private:
 	DLevelScript *LastScript;
 	DLevelScript *Scripts;				// List of all running scripts
 
+	typedef std::map<int, std::vector<DLevelScript *> > WaitQueue;
+	WaitQueue WaitQueues[NUM_WAITQUEUES];
+
+	static EWaitQueue WaitQueueFor (const DLevelScript *script);
+
 	friend class DLevelScript;
 };
 
@@ -42,6 +42,8 @@
 #include "d_dehacked.h"
 #include "g_skill.h"
 #include "p_mapformat.h"
+#include "c_dispatch.h"
+#include "stats.h"
 
 
 EXTERN_CVAR(sv_allowexit)
@@ -112,56 +114,230 @@ extern bool isFast;
 //
 
 
+//
+// SOUND PROPAGATION
+//
+// The sector graph for sound is built once per level: for every sector, the
+// two-sided lines leading out of it and the sector on the other side. Each
+// line's opening is cached and only re-tested when one of the sectors it
+// borders moves. The result of a flood from a given sector only changes when
+// a line opening or a line flag changes, so the flood is memoized per origin
+// sector until then.
+//
+
+struct soundedge_t
+{
+	line_t*		line;
+	int			other;		// sector on the far side
+};
+
+struct soundflood_t
+{
+	unsigned int	generation;
+	std::vector<std::pair<int, int> > reached;	// (sector, soundtraversed)
+};
+
+static std::vector<soundedge_t>		soundedges;
+static std::vector<int>				soundedgestart;		// numsectors + 1 entries
+static std::vector<byte>			soundlineopen;
+static std::vector<byte>			soundsectordirty;	// lines need re-testing
+static std::vector<int>				sounddirtysectors;
+static std::vector<soundflood_t>	soundfloods;
+static size_t						soundfloodentries;	// sum of reached sizes
+static unsigned int					soundgeneration = 1;
+
+// Upper bound on memoized (sector, soundtraversed) pairs across all origins.
+// Past this the memo is dropped and refilled by later alerts.
+static const size_t MAX_SOUNDFLOOD_ENTRIES = 1 << 18;
+
+static unsigned int soundflood_alerts, soundflood_hits, soundflood_misses;
+
+extern sector_t *openbottomsec;
+
+//
+// P_SoundLineOpen
+//
+// Returns true if sound can pass through a two-sided line. Leaves the
+// P_LineOpening globals untouched.
+//
+static bool P_SoundLineOpen(const line_t* line)
+{
+	const fixed_t savetop = opentop, savebottom = openbottom, saverange = openrange;
+	const fixed_t savelowfloor = lowfloor;
+	sector_t* const savebottomsec = openbottomsec;
+
+	// [SL] 2012-02-08 - FIXME: Currently only checks for a line opening at
+	// midpoint of a sloped linedef.  P_RecursiveSound() in ZDoom 1.23 causes
+	// demo desyncs.
+	P_LineOpening(line, (line->v1->x >> 1) + (line->v2->x >> 1),
+						(line->v1->y >> 1) + (line->v2->y >> 1));
+	const bool open = openrange > 0;
+
+	opentop = savetop;
+	openbottom = savebottom;
+	openrange = saverange;
+	lowfloor = savelowfloor;
+	openbottomsec = savebottomsec;
+
+	return open;
+}
+
+//
+// P_InitSoundGraph
+//
+// Builds the sound propagation graph and line opening cache for the current
+// level. Must be called again whenever sector heights are restored wholesale,
+// such as when loading a savegame.
+//
+void P_InitSoundGraph()
+{
+	soundedges.clear();
+	soundedgestart.assign(numsectors + 1, 0);
+	soundlineopen.assign(numlines, 0);
+	soundsectordirty.assign(numsectors, 0);
+	sounddirtysectors.clear();
+	soundfloods.assign(numsectors, soundflood_t());
+	soundfloodentries = 0;
+
+	for (int i = 0; i < numsectors; i++)
+	{
+		const sector_t* sec = &sectors[i];
+		soundedgestart[i] = soundedges.size();
+
+		for (int j = 0; j < sec->linecount; j++)
+		{
+			line_t* check = sec->lines[j];
+			if (check->sidenum[1] == R_NOSIDE)
+				continue;	// never passes sound, even if flagged two-sided
+
+			soundedge_t edge;
+			edge.line = check;
+			if (sides[check->sidenum[0]].sector == sec)
+				edge.other = sides[check->sidenum[1]].sector - sectors;
+			else
+				edge.other = sides[check->sidenum[0]].sector - sectors;
+			soundedges.push_back(edge);
+		}
+	}
+	soundedgestart[numsectors] = soundedges.size();
+
+	for (int i = 0; i < numlines; i++)
+	{
+		if (lines[i].sidenum[1] != R_NOSIDE)
+			soundlineopen[i] = P_SoundLineOpen(&lines[i]);
+	}
+
+	soundgeneration++;
+}
+
+//
+// P_SoundGraphSectorMoved
+//
+// Called by P_ChangeSector when the simulation moves the floor or ceiling of
+// a sector. Only marks the sector; its line openings are re-tested by the
+// next P_NoiseAlert.
+//
+void P_SoundGraphSectorMoved(const sector_t* sec)
+{
+	if (soundsectordirty.size() != (size_t)numsectors)
+		return;		// level is still being set up
+
+	const ptrdiff_t secnum = sec - sectors;
+	if (secnum < 0 || secnum >= numsectors || soundsectordirty[secnum])
+		return;
+
+	soundsectordirty[secnum] = 1;
+	sounddirtysectors.push_back(secnum);
+}
+
+//
+// P_RefreshSoundGraph
+//
+// Re-tests the line openings of every sector that moved since the last
+// noise alert and drops the memoized floods if any of them opened or closed.
+//
+static void P_RefreshSoundGraph()
+{
+	for (size_t i = 0; i < sounddirtysectors.size(); i++)
+	{
+		const int secnum = sounddirtysectors[i];
+		const sector_t* sec = &sectors[secnum];
+
+		soundsectordirty[secnum] = 0;
+
+		for (int j = 0; j < sec->linecount; j++)
+		{
+			const line_t* check = sec->lines[j];
+			if (check->sidenum[1] == R_NOSIDE)
+				continue;
+
+			const byte open = P_SoundLineOpen(check);
+			byte& cached = soundlineopen[check - lines];
+			if (cached != open)
+			{
+				cached = open;
+				soundgeneration++;
+			}
+		}
+	}
+
+	sounddirtysectors.clear();
+}
+
+//
+// P_SoundGraphLinesChanged
+//
+// Called when line flags change, since ML_TWOSIDED and ML_SOUNDBLOCK decide
+// which edges sound may cross.
+//
+void P_SoundGraphLinesChanged()
+{
+	soundgeneration++;
+}
+
+//
+// P_RecursiveSound
 //
 // Called by P_NoiseAlert.
 // Recursively traverse adjacent sectors,
 // sound blocking lines cut off traversal.
+// Every sector reached for the first time is appended to reached.
 //
-
-void P_RecursiveSound (sector_t *sec, int soundblocks, AActor *soundtarget)
+static void P_RecursiveSound(int secnum, int soundblocks,
+                             std::vector<std::pair<int, int> >& reached)
 {
-	int 		i;
-	line_t* 	check;
-	sector_t*	other;
+	sector_t* sec = &sectors[secnum];
 
-	// wake up all monsters in this sector
 	if (sec->validcount == validcount
 		&& sec->soundtraversed <= soundblocks+1)
 	{
 		return; 		// already flooded
 	}
 
+	if (sec->validcount != validcount)
+		reached.push_back(std::make_pair(secnum, 0));
+
 	sec->validcount = validcount;
 	sec->soundtraversed = soundblocks+1;
-	sec->soundtarget = soundtarget->ptr();
 
-	for (i=0 ;i<sec->linecount ; i++)
+	for (int i = soundedgestart[secnum]; i < soundedgestart[secnum + 1]; i++)
 	{
-		check = sec->lines[i];
-		if (! (check->flags & ML_TWOSIDED) )
-			continue;
+		const soundedge_t& edge = soundedges[i];
+		const line_t* check = edge.line;
 
-		if ( sides[ check->sidenum[0] ].sector == sec)
-			other = sides[ check->sidenum[1] ] .sector;
-		else
-			other = sides[ check->sidenum[0] ].sector;
-
-		// [SL] 2012-02-08 - FIXME: Currently only checks for a line opening at
-		// midpoint of a sloped linedef.  P_RecursiveSound() in ZDoom 1.23 causes
-		// demo desyncs.
-		P_LineOpening(check, (check->v1->x >> 1) + (check->v2->x >> 1),
-							 (check->v1->y >> 1) + (check->v2->y >> 1));
+		if (!(check->flags & ML_TWOSIDED))
+			continue;
 
-		if (openrange <= 0)
+		if (!soundlineopen[check - lines])
 			continue;	// closed door
 
 		if (check->flags & ML_SOUNDBLOCK)
 		{
 			if (!soundblocks)
-				P_RecursiveSound (other, 1, soundtarget);
+				P_RecursiveSound (edge.other, 1, reached);
 		}
 		else
-			P_RecursiveSound (other, soundblocks, soundtarget);
+			P_RecursiveSound (edge.other, soundblocks, reached);
 	}
 }
 
@@ -177,10 +353,71 @@ void P_NoiseAlert (AActor *target, AActor *emmiter)
 	if (target->player && (!multiplayer && (target->player->cheats & CF_NOTARGET)))
 		return;
 
-	validcount++;
-	P_RecursiveSound (emmiter->subsector->sector, 0, target);
+	BEGIN_STAT(SoundFlood);
+
+	if (soundfloods.size() != (size_t)numsectors)
+		P_InitSoundGraph();
+
+	P_RefreshSoundGraph();
+
+	const int origin = emmiter->subsector->sector - sectors;
+	soundflood_t& flood = soundfloods[origin];
+
+	soundflood_alerts++;
+
+	if (flood.generation != soundgeneration)
+	{
+		// flood the sector graph and remember where the sound got to
+		soundflood_misses++;
+
+		soundfloodentries -= flood.reached.size();
+		if (soundfloodentries >= MAX_SOUNDFLOOD_ENTRIES)
+		{
+			for (size_t i = 0; i < soundfloods.size(); i++)
+				std::vector<std::pair<int, int> >().swap(soundfloods[i].reached);
+			soundfloodentries = 0;
+			soundgeneration++;
+		}
+
+		validcount++;
+		flood.reached.clear();
+		P_RecursiveSound (origin, 0, flood.reached);
+		soundfloodentries += flood.reached.size();
+
+		for (size_t i = 0; i < flood.reached.size(); i++)
+			flood.reached[i].second = sectors[flood.reached[i].first].soundtraversed;
+
+		flood.generation = soundgeneration;
+	}
+	else
+	{
+		soundflood_hits++;
+	}
+
+	// wake up all monsters in the reached sectors
+	for (size_t i = 0; i < flood.reached.size(); i++)
+	{
+		sector_t* sec = &sectors[flood.reached[i].first];
+		sec->soundtraversed = flood.reached[i].second;
+		sec->soundtarget = target->ptr();
+	}
+
+	END_STAT(SoundFlood);
 }
 
+BEGIN_COMMAND(soundfloodstats)
+{
+	Printf(PRINT_HIGH, "%u noise alerts: %u floods, %u cached (%u%%)\n",
+	       soundflood_alerts, soundflood_misses, soundflood_hits,
+	       soundflood_alerts ? soundflood_hits * 100 / soundflood_alerts : 0);
+	Printf(PRINT_HIGH, "sound graph: %d sectors, %u edges\n", numsectors,
+	       (unsigned int)soundedges.size());
+
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+		soundflood_alerts = soundflood_hits = soundflood_misses = 0;
+}
+END_COMMAND(soundfloodstats)
+
 
 //
 // P_CheckRange
@@ -368,6 +605,7 @@ BOOL P_Move (AActor *actor)
 	{
 		actor->x = origx;
 		actor->y = origy;
+		actor->bmapnode.Refresh();
 		movefactor *= FRACUNIT / ORIG_FRICTION_FACTOR / 4;
 		actor->momx += FixedMul (deltax, movefactor);
 		actor->momy += FixedMul (deltay, movefactor);
@@ -795,14 +1033,14 @@ void A_KeenDie (AActor *actor)
 {
 	A_Fall (actor);
 
-	// scan the remaining thinkers
+	// scan the remaining actors of this type
 	// to see if all Keens are dead
 	AActor *other;
-	TThinkerIterator<AActor> iterator;
+	FActorTypeIterator iterator(actor->type);
 
 	while ( (other = iterator.Next ()) )
 	{
-		if (other != actor && other->type == actor->type && other->health > 0)
+		if (other != actor && other->health > 0)
 		{
 			// other Keen not dead
 			return;
@@ -886,21 +1124,16 @@ void A_Look (AActor *actor)
 	}
 	else if (actor->info->seesound)
 	{
-		char sound[MAX_SNDNAME];
+		const mobjsounds_t& sounds = mobjsounds[actor->type];
+		int sound = sounds.see;
 
-		strcpy (sound, actor->info->seesound);
-
-		if (sound[strlen(sound)-1] == '1')
-		{
-			sound[strlen(sound)-1] = P_Random(actor)%3 + '1';
-			if (S_FindSound (sound) == -1)
-				sound[strlen(sound)-1] = '1';
-		}
+		if (sounds.numseevariants > 1)
+			sound = sounds.seevariants[P_Random(actor) % sounds.numseevariants];
 
 		if (!co_zdoomsound && (actor->flags2 & MF2_BOSS || actor->flags3 & MF3_FULLVOLSOUNDS))
-			S_Sound(CHAN_VOICE, sound, 1, ATTN_NORM);
+			S_MobjSound(CHAN_VOICE, actor->info->seesound, sound, 1, ATTN_NORM);
 		else
-			S_Sound (actor, CHAN_VOICE, sound, 1, ATTN_NORM);
+			S_MobjSound(actor, CHAN_VOICE, actor->info->seesound, sound, 1, ATTN_NORM);
 	}
 
 	if (actor->target)
@@ -1001,7 +1234,7 @@ void A_Chase (AActor *actor)
 	if (actor->info->meleestate && P_CheckMeleeRange (actor))
 	{
 		if (actor->info->attacksound)
-			S_Sound (actor, CHAN_WEAPON, actor->info->attacksound, 1, ATTN_NORM);
+			S_MobjSound(actor, CHAN_WEAPON, actor->info->attacksound, mobjsounds[actor->type].attack, 1, ATTN_NORM);
 
 		if (serverside)
 			P_SetMobjState (actor, actor->info->meleestate, true);
@@ -1045,7 +1278,7 @@ void A_Chase (AActor *actor)
 	// make active sound
 	if (actor->info->activesound && P_Random (actor) < 3)
 	{
-		S_Sound (actor, CHAN_VOICE, actor->info->activesound, 1, ATTN_IDLE);
+		S_MobjSound(actor, CHAN_VOICE, actor->info->activesound, mobjsounds[actor->type].active, 1, ATTN_IDLE);
 	}
 }
 
@@ -1322,6 +1555,7 @@ void A_SkelMissile (AActor *actor)
 
 		mo->x += mo->momx;
 		mo->y += mo->momy;
+		mo->bmapnode.Refresh();
 		mo->tracer = actor->target;
 	}
 }
@@ -1555,6 +1789,7 @@ void A_VileChase (AActor *actor)
 					if ((co_novileghosts)) {
 						corpsehit->height = P_ThingInfoHeight(info);	// [RH] Use real mobj height
 						corpsehit->radius = info->radius;	// [RH] Use real radius
+						corpsehit->bmapnode.Refresh();
 					} else {
 						corpsehit->height <<= 2;
 					}
@@ -1679,6 +1914,7 @@ void A_VileAttack (AActor *actor)
 	// move the fire between the vile and the player
 	fire->x = actor->target->x - FixedMul (24*FRACUNIT, finecosine[an]);
 	fire->y = actor->target->y - FixedMul (24*FRACUNIT, finesine[an]);
+	fire->bmapnode.Refresh();
 	P_RadiusAttack(fire, actor, 70, 70, true, MOD_VILEFIRE);
 }
 
@@ -1796,6 +2032,7 @@ void A_Mushroom(AActor* actor)
 				new AActor(actor->x, actor->y, actor->z, MT_UNKNOWNTHING);
 			target->x += i << FRACBITS; // Aim in many directions from source
 			target->y += j << FRACBITS;
+			target->bmapnode.Refresh();
 			target->z += P_AproxDistance(i, j) * misc1;             // Aim fairly high
 			AActor* mo = P_SpawnMissile(actor, target, MT_FATSHOT); // Launch fireball
 			if (mo != NULL)
@@ -1830,7 +2067,7 @@ void A_SkullAttack (AActor *actor)
 	dest = actor->target;
 	actor->flags |= MF_SKULLFLY;
 
-	S_Sound (actor, CHAN_VOICE, actor->info->attacksound, 1, ATTN_NORM);
+	S_MobjSound(actor, CHAN_VOICE, actor->info->attacksound, mobjsounds[actor->type].attack, 1, ATTN_NORM);
 	A_FaceTarget (actor);
 	an = actor->angle >> ANGLETOFINESHIFT;
 	actor->momx = FixedMul (SKULLSPEED, finecosine[an]);
@@ -1856,7 +2093,7 @@ void A_BetaSkullAttack(AActor* actor)
 	// [FG] fix crash when attack sound is missing
 	if (actor->info->attacksound)
 	{
-		S_Sound(actor, CHAN_VOICE, actor->info->attacksound, 1, ATTN_NORM);
+		S_MobjSound(actor, CHAN_VOICE, actor->info->attacksound, mobjsounds[actor->type].attack, 1, ATTN_NORM);
 	}
 	A_FaceTarget(actor);
 	int damage = (P_Random(actor) % 8 + 1) * actor->info->damage;
@@ -1987,6 +2224,7 @@ void A_MonsterProjectile(AActor* actor)
 	mo->x += FixedMul(spawnofs_xy, finecosine[an]);
 	mo->y += FixedMul(spawnofs_xy, finesine[an]);
 	mo->z += spawnofs_z;
+	mo->bmapnode.Refresh();
 
 	// always set the 'tracer' field, so this pointer
 	// can be used to fire seeker missiles at will.
@@ -2018,7 +2256,7 @@ void A_MonsterBulletAttack(AActor* actor)
 	damagemod = actor->state->args[4];
 
 	A_FaceTarget(actor);
-	S_Sound(actor, CHAN_WEAPON, actor->info->attacksound, 1, ATTN_NORM);
+	S_MobjSound(actor, CHAN_WEAPON, actor->info->attacksound, mobjsounds[actor->type].attack, 1, ATTN_NORM);
 
 	aimslope = P_AimLineAttack(actor, actor->angle, MISSILERANGE);
 
@@ -2182,6 +2420,7 @@ bool P_HealCorpse(AActor* actor, int radius, int healstate, int healsound)
 						corpsehit->height =
 						    P_ThingInfoHeight(info);      // [RH] Use real mobj height
 						corpsehit->radius = info->radius; // [RH] Use real radius
+						corpsehit->bmapnode.Refresh();
 					}
 					else
 					{
@@ -2495,15 +2734,7 @@ void A_PainShootSkull (AActor *actor, angle_t angle)
 		return;
 
 	// count total number of skull currently on the level
-	count = 0;
-
-	TThinkerIterator<AActor> iterator;
-
-	while ( (other = iterator.Next ()) )
-	{
-		if (other->type == MT_SKULL)
-			count++;
-	}
+	count = AActor::CountOfType(MT_SKULL);
 
 	// if there are already 20 skulls on the level,
 	// don't spit another one
@@ -2589,31 +2820,20 @@ void A_PainDie (AActor *actor)
 
 void A_Scream (AActor *actor)
 {
-    char sound[MAX_SNDNAME];
-
 	if (actor->info->deathsound == NULL)
         return;
 
+	// zombiemen and imps pick one of their death sounds at random
+	const mobjsounds_t& sounds = mobjsounds[actor->type];
+	int sound = sounds.death;
 
-	strcpy (sound, actor->info->deathsound);
-
-    if (stricmp(sound, "grunt/death1") == 0 ||
-        stricmp(sound, "shotguy/death1") == 0 ||
-        stricmp(sound, "chainguy/death1") == 0)
-    {
-        sound[strlen(sound)-1] = P_Random(actor) % 3 + '1';
-    }
-
-    if (stricmp(sound, "imp/death1") == 0 ||
-        stricmp(sound, "imp/death2") == 0)
-    {
-        sound[strlen(sound)-1] = P_Random(actor) % 2 + '1';
-    }
+	if (sounds.numdeathvariants > 1)
+		sound = sounds.deathvariants[P_Random(actor) % sounds.numdeathvariants];
 
 	if (!co_zdoomsound && (actor->flags2 & MF2_BOSS || actor->flags3 & MF3_FULLVOLSOUNDS))
-		S_Sound(CHAN_VOICE, sound, 1, ATTN_NORM);
+		S_MobjSound(CHAN_VOICE, actor->info->deathsound, sound, 1, ATTN_NORM);
 	else
-	    S_Sound (actor, CHAN_VOICE, sound, 1, ATTN_NORM);
+	    S_MobjSound(actor, CHAN_VOICE, actor->info->deathsound, sound, 1, ATTN_NORM);
 }
 
 
@@ -2628,7 +2848,7 @@ void A_XScream (AActor *actor)
 void A_Pain (AActor *actor)
 {
 	if (actor->info->painsound)
-		S_Sound (actor, CHAN_VOICE, actor->info->painsound, 1, ATTN_NORM);
+		S_MobjSound(actor, CHAN_VOICE, actor->info->painsound, mobjsounds[actor->type].pain, 1, ATTN_NORM);
 }
 
 
@@ -2728,13 +2948,13 @@ void A_BossDeath(AActor *actor)
 		if (ba == level.bossactions.end())
 			return;
 
-		// scan the remaining thinkers to see if all bosses are dead
-		TThinkerIterator<AActor> iterator;
+		// scan the remaining actors of this type to see if all bosses are dead
+		FActorTypeIterator iterator(actor->type);
 		AActor* other;
 
 		while ((other = iterator.Next()))
 		{
-			if (other != actor && other->type == actor->type && other->health > 0)
+			if (other != actor && other->health > 0)
 			{
 				// other boss not dead
 				return;
@@ -2802,7 +3022,7 @@ struct brain_s brain;   // killough 3/26/98: global state of boss brain
 void P_SpawnBrainTargets (void)	// killough 3/26/98: renamed old function
 {
 	AActor *other;
-	TThinkerIterator<AActor> iterator;
+	FActorTypeIterator iterator(MT_BOSSTARGET);
 
 	// find all the target spots
 	numbraintargets = 0;
@@ -2811,16 +3031,14 @@ void P_SpawnBrainTargets (void)	// killough 3/26/98: renamed old function
 
 	while ( (other = iterator.Next ()) )
 	{
-		if (other->type == MT_BOSSTARGET)
-		{	// killough 2/7/98: remove limit on icon landings:
-			if (numbraintargets >= numbraintargets_alloc)
-			{
-				braintargets = (AActor **)Realloc (braintargets,
-					(numbraintargets_alloc = numbraintargets_alloc ?
-					 numbraintargets_alloc*2 : 32) *sizeof *braintargets);
-			}
-			braintargets[numbraintargets++] = other;
+		// killough 2/7/98: remove limit on icon landings:
+		if (numbraintargets >= numbraintargets_alloc)
+		{
+			braintargets = (AActor **)Realloc (braintargets,
+				(numbraintargets_alloc = numbraintargets_alloc ?
+				 numbraintargets_alloc*2 : 32) *sizeof *braintargets);
 		}
+		braintargets[numbraintargets++] = other;
 	}
 }
 
@@ -3044,6 +3262,7 @@ void A_Gibify(AActor *mo) // denis - squash thing
 	mo->flags &= ~MF_SOLID;
 	mo->height = 0;
 	mo->radius = 0;
+	mo->bmapnode.Refresh();
 }
 
 //
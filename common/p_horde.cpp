@@ -153,18 +153,13 @@ static void ActivateMonsters(AActors& mobjs)
 		// Play the see sound if we have one.
 		if (mo->info->seesound)
 		{
-			char sound[MAX_SNDNAME];
+			const mobjsounds_t& sounds = mobjsounds[mo->type];
+			int sound = sounds.see;
 
-			strcpy(sound, mo->info->seesound);
+			if (sounds.numseevariants > 1)
+				sound = sounds.seevariants[P_Random(mo) % sounds.numseevariants];
 
-			if (sound[strlen(sound) - 1] == '1')
-			{
-				sound[strlen(sound) - 1] = P_Random(mo) % 3 + '1';
-				if (S_FindSound(sound) == -1)
-					sound[strlen(sound) - 1] = '1';
-			}
-
-			S_NetSound(mo, CHAN_VOICE, sound, ATTN_NORM);
+			S_NetSoundID(mo, CHAN_VOICE, sound, ATTN_NORM);
 		}
 	}
 }
@@ -580,6 +580,11 @@ void DGlow::RunThink ()
 }
 
 
+int DGlow::ParallelKey () const
+{
+	return m_Sector - sectors;
+}
+
 DGlow::DGlow (sector_t *sector)
 	: DLighting (sector)
 {
@@ -720,6 +725,11 @@ void DPhased::RunThink ()
 		m_Phase--;
 }
 
+int DPhased::ParallelKey () const
+{
+	return m_Sector - sectors;
+}
+
 int DPhased::PhaseHelper (sector_t *sector, int index, int light, sector_t *prev)
 {
 	if (!sector)
@@ -1425,6 +1425,8 @@ FUNC(LS_Line_SetBlocking)
 			lines[s].flags = (lines[s].flags & ~clearflags) | setflags;
 		}
 
+		P_SoundGraphLinesChanged();
+
 		return true;
 	}
 	return false;
@@ -144,6 +144,9 @@ BOOL	P_DeactivateMobj (AActor *mobj);
 // P_ENEMY
 //
 void	P_NoiseAlert (AActor* target, AActor* emmiter);
+void	P_InitSoundGraph();
+void	P_SoundGraphSectorMoved(const sector_t* sec);
+void	P_SoundGraphLinesChanged();
 void	P_SpawnBrainTargets(void);	// killough 3/26/98: spawn icon landings
 
 extern struct brain_s {				// killough 3/26/98: global state of boss brain
@@ -179,6 +182,9 @@ extern TArray<intercept_t> intercepts;
 
 typedef BOOL (*traverser_t) (intercept_t *in);
 
+void P_StartInterceptOrder();
+intercept_t* P_NextIntercept();
+
 subsector_t* P_PointInSubsector(fixed_t x, fixed_t y);
 fixed_t P_AproxDistance (fixed_t dx, fixed_t dy);
 fixed_t P_AproxDistance2 (fixed_t *pos_array, fixed_t x, fixed_t y);
@@ -204,6 +210,20 @@ void P_LineOpening (const line_t *linedef, fixed_t x, fixed_t y, fixed_t refx=MI
 BOOL P_BlockLinesIterator (int x, int y, BOOL(*func)(line_t*) );
 BOOL P_BlockThingsIterator (int x, int y, BOOL(*func)(AActor*), AActor *start=NULL);
 
+// A compact copy of an actor's blockmap position, stored per mapblock next
+// to the blocklinks chain so that things can be rejected without touching
+// the AActor.  x, y and radius are as of the last LinkToWorld.
+struct blockthing_t
+{
+	AActor*	mo;
+	fixed_t	x;
+	fixed_t	y;
+	fixed_t	radius;
+};
+
+void P_InitBlockThings();
+BOOL P_BlockThingsFilterIterator (int x, int y, BOOL(*func)(AActor*), bool(*reject)(const blockthing_t&));
+
 #define PT_ADDLINES 	1
 #define PT_ADDTHINGS	2
 #define PT_EARLYOUT 	4
@@ -219,6 +239,10 @@ P_PathTraverse
   int			flags,
   BOOL		(*trav) (intercept_t *));
 
+void P_StartFanTrace (fixed_t x1, fixed_t y1, const fixed_t *x2, const fixed_t *y2, int count,
+                      bool (*filter)(AActor *));
+BOOL P_FanPathTraverse (int tracer, BOOL (*trav) (intercept_t *));
+
 // [ML] 2/1/10: Break out P_PointToAngle from R_PointToAngle2 (from EE)
 angle_t P_PointToAngle(fixed_t xo, fixed_t yo, fixed_t x, fixed_t y);
 
@@ -303,9 +327,12 @@ extern	sector_t* CameraSector;
 
 // [RH] Means of death
 void	P_RadiusAttack (AActor *spot, AActor *source, int damage, int distance, bool hurtSelf, int mod);
+void	P_RunSplashes ();
 
 void	P_DelSeclist(msecnode_t *);							// phares 3/16/98
 void	P_CreateSecNodeList(AActor*,fixed_t,fixed_t);		// phares 3/14/98
+void	P_ClearSecNodes();
+void	P_InvalidateSecNodes();
 int		P_GetMoveFactor(const AActor *mo, int *frictionp);	// phares  3/6/98
 int		P_GetFriction(const AActor *mo, int *frictionfactor);
 BOOL	Check_Sides(AActor *, int, int);					// phares
@@ -399,6 +426,7 @@ class DPolyAction : public DThinker
 	DECLARE_SERIAL (DPolyAction, DThinker)
 public:
 	DPolyAction (int polyNum);
+	virtual void Destroy ();
 protected:
 	DPolyAction ();
 	int m_PolyObj;
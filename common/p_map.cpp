@@ -32,6 +32,7 @@
 
 #include "p_local.h"
 #include "p_lnspec.h"
+#include "c_dispatch.h"
 #include "c_effect.h"
 #include "p_mobj.h"
 #include "svc_message.h"
@@ -50,6 +51,7 @@
 #include "p_mapformat.h"
 #include <math.h>
 #include <set>
+#include <map>
 
 bool P_ShouldClipPlayer(AActor* projectile, AActor* player);
 
@@ -102,12 +104,27 @@ EXTERN_CVAR (co_blockmapfix)
 EXTERN_CVAR (co_boomsectortouch)
 EXTERN_CVAR (sv_friendlyfire)
 EXTERN_CVAR (sv_unblockplayers)
+EXTERN_CVAR (sv_splashbatching)
 
 CVAR_FUNC_IMPL (sv_gravity)
 {
 	level.gravity = var;
 }
 
+//
+// PIT_RejectThing
+//
+// Thing record filter for P_BlockThingsFilterIterator that discards things
+// too far from tmx, tmy to touch tmthing.  This is the distance check shared
+// by PIT_StompThing, PIT_CheckThing and PIT_CheckOnmobjZ, all of which ignore
+// such things without side effects.
+//
+static bool PIT_RejectThing(const blockthing_t& rec)
+{
+	fixed_t blockdist = rec.radius + tmthing->radius;
+	return abs(rec.x - tmx) >= blockdist || abs(rec.y - tmy) >= blockdist;
+}
+
 //
 // TELEPORT MOVE
 //
@@ -244,7 +261,7 @@ BOOL P_TeleportMove (AActor *thing, fixed_t x, fixed_t y, fixed_t z, BOOL telefr
 
 	for (bx=xl ; bx<=xh ; bx++)
 		for (by=yl ; by<=yh ; by++)
-			if (!P_BlockThingsIterator(bx,by,PIT_StompThing))
+			if (!P_BlockThingsFilterIterator(bx,by,PIT_StompThing,PIT_RejectThing))
 				return false;
 
 	// the move is ok,
@@ -663,7 +680,7 @@ static BOOL PIT_CheckThing (AActor *thing)
 			if (!(thing->flags & MF_NOBLOOD))
 				P_SpawnBlood(tmthing->x, tmthing->y, tmthing->z, damage);
 			if (tmthing->info->ripsound)
-				S_Sound(tmthing, CHAN_VOICE, tmthing->info->ripsound, 1, ATTN_NORM);
+				S_MobjSound(tmthing, CHAN_VOICE, tmthing->info->ripsound, mobjsounds[tmthing->type].rip, 1, ATTN_NORM);
 
 			P_DamageMobj(thing, tmthing, tmthing->target, damage, MOD_UNKNOWN);
 			if (thing->flags2 & MF2_PUSHABLE && !(tmthing->flags2 & MF2_CANNOTPUSH))
@@ -947,7 +964,8 @@ bool P_CheckPosition (AActor *thing, fixed_t x, fixed_t y)
 				AActor *robin = NULL;
 				do
 				{
-					if (!P_BlockThingsIterator (bx, by, PIT_CheckThing, robin))
+					if (robin ? !P_BlockThingsIterator (bx, by, PIT_CheckThing, robin) :
+					            !P_BlockThingsFilterIterator (bx, by, PIT_CheckThing, PIT_RejectThing))
 					{ // [RH] If a thing can be stepped up on, we need to continue checking
 					  // other things in the blocks and see if we hit something that is
 					  // definitely blocking. Otherwise, we need to check the lines, or we
@@ -1006,7 +1024,7 @@ bool P_CheckPosition (AActor *thing, fixed_t x, fixed_t y)
 		// vanilla Doom's check for blocking things
 		for (int bx=xl ; bx<=xh ; bx++)
 			for (int by=yl ; by<=yh ; by++)
-				if (!P_BlockThingsIterator(bx,by,PIT_CheckThing))
+				if (!P_BlockThingsFilterIterator(bx,by,PIT_CheckThing,PIT_RejectThing))
 					return false;
 
 		if (tmflags & MF_NOCLIP)
@@ -1080,7 +1098,7 @@ bool P_TestMobjZ (AActor *actor)
 
 	for (bx = xl; bx <= xh; bx++)
 		for (by = yl; by <= yh; by++)
-			if (!P_BlockThingsIterator (bx, by, PIT_CheckOnmobjZ))
+			if (!P_BlockThingsFilterIterator (bx, by, PIT_CheckOnmobjZ, PIT_RejectThing))
 				return false;
 
 	return true;
@@ -2264,18 +2282,13 @@ BOOL PTR_ShootTraverse (intercept_t* in)
 EXTERN_CVAR(sv_freelook)
 
 //
-// P_AimLineAttack
+// P_StartAim
 //
-fixed_t P_AimLineAttack (AActor *t1, angle_t angle, fixed_t distance)
+// Sets up the aiming globals for an aim trace from t1.
+//
+static void P_StartAim (AActor *t1, fixed_t distance)
 {
-	fixed_t x2;
-	fixed_t y2;
-
-	angle >>= ANGLETOFINESHIFT;
 	shootthing = t1;
-
-	x2 = t1->x + (distance>>FRACBITS)*finecosine[angle];
-	y2 = t1->y + (distance>>FRACBITS)*finesine[angle];
 	shootz = t1->z + (t1->height>>1) + 8*FRACUNIT;
 
 	// can't shoot outside view angles
@@ -2297,6 +2310,22 @@ fixed_t P_AimLineAttack (AActor *t1, angle_t angle, fixed_t distance)
 
 	attackrange = distance;
 	linetarget = NULL;
+}
+
+//
+// P_AimLineAttack
+//
+fixed_t P_AimLineAttack (AActor *t1, angle_t angle, fixed_t distance)
+{
+	fixed_t x2;
+	fixed_t y2;
+
+	angle >>= ANGLETOFINESHIFT;
+
+	x2 = t1->x + (distance>>FRACBITS)*finecosine[angle];
+	y2 = t1->y + (distance>>FRACBITS)*finesine[angle];
+
+	P_StartAim (t1, distance);
 
 	P_PathTraverse (t1->x, t1->y, x2, y2, PT_ADDLINES|PT_ADDTHINGS, PTR_AimTraverse);
 
@@ -2306,11 +2335,26 @@ fixed_t P_AimLineAttack (AActor *t1, angle_t angle, fixed_t distance)
 	return 0;
 }
 
+//
+// PIT_AimCandidate
+//
+// Fan trace filter for PTR_AimTraverse, which skips the shooter and
+// anything that isn't shootable without doing anything else.
+//
+static bool PIT_AimCandidate (AActor *thing)
+{
+	return thing != shootthing && (thing->flags & MF_SHOOTABLE);
+}
+
 /**
  * A function created especially for implementing player autoaim.  First
  * attempts to shoot a tracer straight ahead, then tries progressively wider
  * and wider tracers in a short cone.
  *
+ * The tracers after the first one are run as a fan trace, which gathers the
+ * shootable things along all of them once.  They are tried in the same order
+ * and give the same result as separate P_AimLineAttack calls.
+ *
  * @param  actor    Source actor.
  * @param  angle    Angle of shot.  Set to the 'correct' angle on return.
  * @param  spread   Maximum spread angle of shot, plus or minus 0 degrees.
@@ -2328,27 +2372,42 @@ fixed_t P_AutoAimLineAttack(AActor* actor, angle_t& angle, const angle_t spread,
 	if (linetarget)
 		return slope;
 
+	if (tracers <= 0)
+		return 0;
+
 	angle_t originangle = angle;
 	angle_t testspread = spread / tracers;
 
+	// the tracers alternate to either side of the shot, widening each time
+	std::vector<angle_t> angles(tracers * 2);
+	std::vector<fixed_t> x2(tracers * 2), y2(tracers * 2);
+
 	for (int i = 1;i <= tracers;i++)
 	{
-		angle = originangle;
-		if (i == tracers)
-			angle += spread;
-		else
-			angle += testspread * i;
-		slope = P_AimLineAttack(actor, angle, distance);
-		if (linetarget)
-			return slope;
+		angle_t offset = (i == tracers) ? spread : testspread * i;
+		angles[i * 2 - 2] = originangle + offset;
+		angles[i * 2 - 1] = originangle - offset;
+	}
+
+	for (size_t i = 0; i < angles.size(); i++)
+	{
+		int an = angles[i] >> ANGLETOFINESHIFT;
+		x2[i] = actor->x + (distance>>FRACBITS)*finecosine[an];
+		y2[i] = actor->y + (distance>>FRACBITS)*finesine[an];
+	}
+
+	shootthing = actor;
+	P_StartFanTrace(actor->x, actor->y, &x2[0], &y2[0], angles.size(), PIT_AimCandidate);
+
+	for (size_t i = 0; i < angles.size(); i++)
+	{
+		angle = angles[i];
+
+		P_StartAim(actor, distance);
+		P_FanPathTraverse(i, PTR_AimTraverse);
 
-		if (i == tracers)
-			angle -= spread * 2;
-		else
-			angle -= testspread * i * 2;
-		slope = P_AimLineAttack(actor, angle, distance);
 		if (linetarget)
-			return slope;
+			return aimslope;
 	}
 
 	return 0;
@@ -2893,6 +2952,7 @@ static int			bombdistance;
 static float		bombdistancefloat;
 static bool			DamageSource;
 static int			bombmod;
+static fixed_t		bombreach;		// 0 if things can't be rejected by their records
 
 // [RH] Damage scale to apply to thing that shot the missile. (co_zdoomphys)
 static float selfthrustscale;
@@ -2916,6 +2976,8 @@ static bool P_SplashImmune(AActor* target, AActor* spot)
 	    mobjinfo[target->type].splash_group == mobjinfo[spot->type].splash_group;
 }
 
+static bool P_SplashSight(AActor* thing);
+
 static BOOL PIT_DoomRadiusAttack(AActor* thing)
 {
 	if (!serverside || !(thing->flags & (MF_SHOOTABLE | MF_BOUNCES)))
@@ -2950,7 +3012,7 @@ static BOOL PIT_DoomRadiusAttack(AActor* thing)
 		return true; // out of range
 	}
 
-	if (P_CheckSight(thing, bombspot))
+	if (P_SplashSight(thing))
 	{
 		int damage;
 
@@ -3039,7 +3101,7 @@ static BOOL PIT_ZDoomRadiusAttack(AActor* thing)
 	if (thing == bombsource)
 		points *= sv_splashfactor;
 
-	if (points > 0.0f && P_CheckSight(thing, bombspot))
+	if (points > 0.0f && P_SplashSight(thing))
 	{
 		// OK to damage; target is in direct path
 
@@ -3077,10 +3139,144 @@ static BOOL PIT_ZDoomRadiusAttack(AActor* thing)
 }
 
 //
-// P_RadiusAttack
-// Source is the creature that caused the explosion at spot.
+// Splash batching
 //
-void P_RadiusAttack(AActor *spot, AActor *source, int damage, int distance,
+// With sv_splashbatching enabled, P_RadiusAttack queues explosions instead
+// of applying them, and P_RunSplashes applies the whole queue at the end of
+// the tic, in the order the explosions happened.  Each explosion walks the
+// mapblocks the same way as an immediate one, so things are damaged in the
+// same order, and the blocks' thing records let far away things be skipped
+// without touching them.  A thing's line of sight to explosions from the
+// same subsector is only checked once as long as the thing doesn't move,
+// and the damage lands at the end of the tic, so this is not vanilla
+// behavior.
+//
+// A queued explosion holds a counted reference to its spot and source so they
+// are not freed before the batch runs, and it goes off where the spot was
+// when it exploded.  Things destroyed since then are skipped.
+//
+struct splash_t
+{
+	AActor::AActorPtrCounted	spot;
+	AActor::AActorPtrCounted	source;
+	fixed_t				x, y, z;
+	subsector_t*		subsector;
+	int					damage;
+	int					distance;
+	bool				hurtSource;
+	int					mod;
+};
+
+static std::vector<splash_t> splashqueue;
+static bool splashbatch = false;	// applying splashqueue
+
+// sight from a thing to an explosion in a subsector, per batch
+typedef std::pair<AActor*, subsector_t*> SplashSightKey;
+
+struct splashsight_t
+{
+	fixed_t				x, y, z;	// where the thing was
+	bool				sight;
+};
+
+static std::map<SplashSightKey, splashsight_t> splashsight;
+
+static unsigned int splash_explosions = 0;
+static unsigned int splash_batches = 0;
+static unsigned int splash_sightchecks = 0;
+static unsigned int splash_sighthits = 0;
+
+//
+// P_SplashGone
+//
+// Returns true if a thing has been destroyed but not freed yet, either
+// because it is still referenced or because the frame hasn't ended.
+//
+static bool P_SplashGone(AActor* thing)
+{
+	return (thing->ObjectFlags & OF_MassDestruction) || thing->WasDestroyed();
+}
+
+//
+// P_SplashSight
+//
+// Line of sight from thing to the current explosion.
+//
+static bool P_SplashSight(AActor* thing)
+{
+	if (!splashbatch)
+		return P_CheckSight(thing, bombspot);
+
+	const SplashSightKey key(thing, bombspot->subsector);
+	std::map<SplashSightKey, splashsight_t>::iterator it = splashsight.find(key);
+	if (it != splashsight.end() && it->second.x == thing->x && it->second.y == thing->y &&
+	    it->second.z == thing->z)
+	{
+		splash_sighthits++;
+		return it->second.sight;
+	}
+
+	splash_sightchecks++;
+	splashsight_t& cached = splashsight[key];
+	cached.x = thing->x;
+	cached.y = thing->y;
+	cached.z = thing->z;
+	cached.sight = P_CheckSight(thing, bombspot);
+	return cached.sight;
+}
+
+//
+// PIT_RejectRadiusThing
+//
+// Thing record filter for the radius attack functions.  A thing whose box is
+// bombreach or more from the explosion is out of range for both the Doom and
+// the ZDoom damage formulas, and the attack functions only log a WDL event
+// for it, so it can be skipped when that event can't be logged.
+//
+static bool PIT_RejectRadiusThing(const blockthing_t& rec)
+{
+	// damage to the source is scaled by sv_splashfactor
+	if (rec.mo == bombsource)
+		return false;
+
+	fixed_t dx = abs(rec.x - bombspot->x);
+	fixed_t dy = abs(rec.y - bombspot->y);
+
+	return MAX(dx, dy) - rec.radius >= bombreach;
+}
+
+static std::vector<AActor*>* splashtargets;
+
+static BOOL PIT_AddSplashTarget(AActor* thing)
+{
+	splashtargets->push_back(thing);
+	return true;
+}
+
+//
+// P_SplashBlockThings
+//
+// Appends the things in a mapblock to targets, in blocklinks order.
+//
+static void P_SplashBlockThings(int x, int y, std::vector<AActor*>& targets)
+{
+	const int index = y * bmapwidth + x;
+
+	if (bombreach)
+	{
+		splashtargets = &targets;
+		P_BlockThingsFilterIterator(x, y, PIT_AddSplashTarget, PIT_RejectRadiusThing);
+		return;
+	}
+
+	for (AActor* mobj = blocklinks[index]; mobj; mobj = mobj->bmapnode.Next(x, y))
+		targets.push_back(mobj);
+}
+
+//
+// P_ApplyRadiusAttack
+//
+static void P_ApplyRadiusAttack(AActor *spot, AActor *source, int damage, int distance,
 	bool hurtSource, int mod)
 {
 	fixed_t dist = (distance+MAXRADIUS)<<FRACBITS;
@@ -3107,42 +3303,141 @@ void P_RadiusAttack(AActor *spot, AActor *source, int damage, int distance,
 	BOOL (*pAttackFunc)(AActor*) = co_zdoomphys ?
 		PIT_ZDoomRadiusAttack : PIT_DoomRadiusAttack;
 
+	// Both formulas do no damage once the distance to the thing's box
+	// reaches bombdistance + bombdistance / bombdamage map units.
+	bombreach = 0;
+	if (damage > 0 && distance > 0 && distance < 8192 &&
+	    !(bombsource && bombsource->player && M_IsWDLRecording()))
+	{
+		bombreach = (distance + distance / damage + 2) << FRACBITS;
+	}
+
 	if (co_blockmapfix)
 	{
 		// [SL] 2012-12-03 - With co_blockmapfix, an actor can get radius
 		// damage more than once since an actor can be in more than one block.
 		// So we make a list of unique actors in the surrounding blocks and
 		// then call the radius attack function once for each actor.
+		//
+		// The list is kept sorted by address, the order the std::set that
+		// used to hold it was visited in.
 
-		std::set<AActor*> actorset;
+		std::vector<AActor*> targets;
 		for (int y=yl ; y<=yh ; y++)
-		{
 			for (int x=xl ; x<=xh ; x++)
-			{
-				AActor *mobj = blocklinks[y*bmapwidth+x];
-				while (mobj)
-				{
-					actorset.insert(mobj);
-					mobj = mobj->bmapnode.Next(x, y);
-				}
-			}
-		}
+				P_SplashBlockThings(x, y, targets);
+
+		std::sort(targets.begin(), targets.end());
+		targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
 
-		std::set<AActor*>::iterator itr = actorset.begin();
-		while (itr != actorset.end())
+		for (size_t i = 0; i < targets.size(); i++)
 		{
-			pAttackFunc(*itr);
-			++itr;
+			if (!P_SplashGone(targets[i]))
+				pAttackFunc(targets[i]);
 		}
 	}
 	else
 	{
 		for (int y=yl ; y<=yh ; y++)
+		{
 			for (int x=xl ; x<=xh ; x++)
-				P_BlockThingsIterator (x, y, pAttackFunc);
+			{
+				if (bombreach)
+					P_BlockThingsFilterIterator (x, y, pAttackFunc, PIT_RejectRadiusThing);
+				else
+					P_BlockThingsIterator (x, y, pAttackFunc);
+			}
+		}
 	}
 }
 
+//
+// P_RadiusAttack
+// Source is the creature that caused the explosion at spot.
+//
+void P_RadiusAttack(AActor *spot, AActor *source, int damage, int distance,
+	bool hurtSource, int mod)
+{
+	splash_explosions++;
+
+	if (sv_splashbatching && serverside && !splashbatch)
+	{
+		splash_t splash;
+		splash.spot = spot->ptr();
+		if (source)
+			splash.source = source->ptr();
+		splash.x = spot->x;
+		splash.y = spot->y;
+		splash.z = spot->z;
+		splash.subsector = spot->subsector;
+		splash.damage = damage;
+		splash.distance = distance;
+		splash.hurtSource = hurtSource;
+		splash.mod = mod;
+		splashqueue.push_back(splash);
+		return;
+	}
+
+	P_ApplyRadiusAttack(spot, source, damage, distance, hurtSource, mod);
+}
+
+//
+// P_RunSplashes
+//
+// Applies the explosions queued by P_RadiusAttack during this tic.
+//
+void P_RunSplashes()
+{
+	if (splashqueue.empty())
+		return;
+
+	splash_batches++;
+	splashbatch = true;
+
+	// explosions caused by this batch are applied right away
+	for (size_t i = 0; i < splashqueue.size(); i++)
+	{
+		splash_t& splash = splashqueue[i];
+		AActor* spot = splash.spot;
+
+		// a source that is gone can't be blamed for the damage
+		AActor* source = splash.source;
+		if (source && P_SplashGone(source))
+			source = NULL;
+
+		// put the spot back where it exploded for the attack
+		const fixed_t x = spot->x, y = spot->y, z = spot->z;
+		subsector_t* subsector = spot->subsector;
+		spot->x = splash.x;
+		spot->y = splash.y;
+		spot->z = splash.z;
+		spot->subsector = splash.subsector;
+
+		P_ApplyRadiusAttack(spot, source, splash.damage, splash.distance,
+		                    splash.hurtSource, splash.mod);
+
+		spot->x = x;
+		spot->y = y;
+		spot->z = z;
+		spot->subsector = subsector;
+	}
+
+	splashbatch = false;
+	splashqueue.clear();
+	splashsight.clear();
+}
+
+BEGIN_COMMAND(splashstats)
+{
+	Printf(PRINT_HIGH, "%u explosions in %u batches\n", splash_explosions, splash_batches);
+	Printf(PRINT_HIGH, "batched sight: %u checks, %u reused\n", splash_sightchecks,
+	       splash_sighthits);
+
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+		splash_explosions = splash_batches = splash_sightchecks = splash_sighthits = 0;
+}
+END_COMMAND(splashstats)
+
 
 
 //
@@ -3185,6 +3480,7 @@ BOOL PIT_ChangeSector (AActor *thing)
 		if ((demoplayback)) {
 			thing->height = 0;
 			thing->radius = 0;
+			thing->bmapnode.Refresh();
 		}
 
 		// keep checking
@@ -3243,6 +3539,8 @@ bool P_ChangeSector (sector_t *sector, int crunch)
 	nofit = false;
 	crushchange = crunch;
 
+	P_SoundGraphSectorMoved(sector);
+
 	// [ML] co_boomsectortouch now part of co_boomphys
 	if (co_boomphys)
 	{
@@ -3293,6 +3591,25 @@ bool P_ChangeSector (sector_t *sector, int crunch)
 
 msecnode_t *headsecnode = NULL;
 
+// Nodes are allocated SECNODE_SLAB at a time and carved into the freelist,
+// so the sector links of a level live in a few contiguous blocks instead of
+// one zone allocation per node. The slabs are PU_LEVEL and go away with the
+// level, when headsecnode is reset.
+
+static const int SECNODE_SLAB = 256;
+
+// Bumped whenever lines move (polyobjects), which invalidates the position
+// each thing's touching_sectorlist was last built for.
+static unsigned int secnodegeneration = 1;
+
+static unsigned int secnode_slabs = 0;
+static unsigned int secnode_rebuilds = 0;
+static unsigned int secnode_kept = 0;
+static unsigned int secnode_tics = 0;
+static unsigned int secnode_peak = 0;
+static unsigned int secnode_ticrebuilds = 0;
+static int secnode_lasttic = -1;
+
 // P_GetSecnode() retrieves a node from the freelist. The calling routine
 // should make sure it sets all fields properly.
 
@@ -3300,13 +3617,20 @@ msecnode_t *P_GetSecnode()
 {
 	msecnode_t *node;
 
-	if (headsecnode)
+	if (!headsecnode)
 	{
-		node = headsecnode;
-		headsecnode = headsecnode->m_snext;
+		msecnode_t *slab = (msecnode_t *)Z_Malloc(sizeof(*slab) * SECNODE_SLAB, PU_LEVEL, NULL);
+
+		for (int i = 0; i < SECNODE_SLAB - 1; i++)
+			slab[i].m_snext = &slab[i + 1];
+		slab[SECNODE_SLAB - 1].m_snext = NULL;
+
+		headsecnode = slab;
+		secnode_slabs++;
 	}
-	else
-		node = (msecnode_t *)Z_Malloc (sizeof(*node), PU_LEVEL, NULL);
+
+	node = headsecnode;
+	headsecnode = headsecnode->m_snext;
 	return node;
 }
 
@@ -3484,6 +3808,35 @@ void P_CreateSecNodeList (AActor *thing, fixed_t x, fixed_t y)
 	int by;
 	msecnode_t *node;
 
+	if (secnode_lasttic != gametic)
+	{
+		if (secnode_ticrebuilds > secnode_peak)
+			secnode_peak = secnode_ticrebuilds;
+		secnode_ticrebuilds = 0;
+		secnode_lasttic = gametic;
+		secnode_tics++;
+	}
+
+	// The sectors a thing touches only change when its box crosses a line,
+	// so a thing relinked where its list was last built (and with no line
+	// moved since) gets exactly the list it is handing back. Keep it.
+
+	if (sector_list && sector_list->m_thing == thing &&
+	    thing->secnodegen == secnodegeneration && thing->secnodex == x &&
+	    thing->secnodey == y && thing->secnoderadius == thing->radius)
+	{
+		secnode_kept++;
+		return;
+	}
+
+	secnode_rebuilds++;
+	secnode_ticrebuilds++;
+
+	thing->secnodex = x;
+	thing->secnodey = y;
+	thing->secnoderadius = thing->radius;
+	thing->secnodegen = secnodegeneration;
+
 	// First, clear out the existing m_thing fields. As each node is
 	// added or verified as needed, m_thing will be set properly. When
 	// finished, delete all nodes where m_thing is still NULL. These
@@ -3552,6 +3905,51 @@ void P_CreateSecNodeList (AActor *thing, fixed_t x, fixed_t y)
 	tmbbox[3] = last_tmbbox[3];
 }
 
+//
+// P_ClearSecNodes
+//
+// Forgets the freelist and its slabs, which Z_FreeTags has already
+// released along with the previous level.
+//
+void P_ClearSecNodes()
+{
+	headsecnode = NULL;
+	secnode_slabs = 0;
+}
+
+//
+// P_InvalidateSecNodes
+//
+// Called when lines have moved, forcing every thing to rebuild its sector
+// list the next time it is linked.
+//
+void P_InvalidateSecNodes()
+{
+	if (++secnodegeneration == 0)
+		secnodegeneration = 1;
+}
+
+BEGIN_COMMAND(secnodestats)
+{
+	if (secnode_ticrebuilds > secnode_peak)
+		secnode_peak = secnode_ticrebuilds;
+
+	const unsigned int links = secnode_rebuilds + secnode_kept;
+	Printf(PRINT_HIGH, "%u sector list links: %u rebuilt, %u kept (%u%%)\n", links,
+	       secnode_rebuilds, secnode_kept,
+	       links ? (unsigned int)((uint64_t)secnode_kept * 100 / links) : 0);
+	Printf(PRINT_HIGH, "%.1f rebuilds per tic, peak %u, %u node slabs this level\n",
+	       secnode_tics ? (double)secnode_rebuilds / secnode_tics : 0.0, secnode_peak,
+	       secnode_slabs);
+
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+	{
+		secnode_rebuilds = secnode_kept = secnode_tics = 0;
+		secnode_peak = secnode_ticrebuilds = 0;
+	}
+}
+END_COMMAND(secnodestats)
+
 //
 // P_InvertPlane
 //
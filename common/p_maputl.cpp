@@ -27,6 +27,8 @@
 
 #include "odamex.h"
 
+#include "c_dispatch.h"
+#include "i_system.h"
 #include "m_bbox.h"
 
 #include "p_local.h"
@@ -96,6 +98,105 @@ subsector_t* P_PointInSubsector(fixed_t x, fixed_t y)
 }
 
 
+//
+// Per-mapblock thing records
+//
+// Each mapblock keeps an array of blockthing_t records in the same order
+// as its blocklinks chain (the array is appended to where the chain is pushed
+// onto, so it is walked from the back).  Each actor remembers the index of
+// its record in every block it is linked into, so unlinking just clears the
+// record.  Cleared records are dropped from the back right away and the
+// array is compacted once they make up half of it, which keeps the order.
+// changes is bumped whenever the array is modified so that iterators can
+// tell if a callback linked or unlinked things in the block they are walking.
+//
+struct blockthings_t
+{
+	std::vector<blockthing_t>	things;
+	size_t						dead;		// cleared records in things
+	unsigned int				changes;
+
+	blockthings_t() : dead(0), changes(0) { }
+};
+
+static std::vector<blockthings_t> blockthings;
+
+static unsigned int blockthings_scanned = 0;
+static unsigned int blockthings_rejected = 0;
+static unsigned int blockthings_fallbacks = 0;
+
+//
+// P_InitBlockThings
+//
+// Clears the thing records for all mapblocks.  Called after the blockmap for
+// a new level is loaded.
+//
+void P_InitBlockThings()
+{
+	blockthings.clear();
+	blockthings.resize(bmapwidth * bmapheight);
+}
+
+static size_t P_AddBlockThing(AActor* mo, int bmx, int bmy)
+{
+	blockthings_t& block = blockthings[bmy * bmapwidth + bmx];
+
+	blockthing_t rec;
+	rec.mo = mo;
+	rec.x = mo->x;
+	rec.y = mo->y;
+	rec.radius = mo->radius;
+
+	block.things.push_back(rec);
+	block.changes++;
+
+	return block.things.size() - 1;
+}
+
+static void P_RemoveBlockThing(AActor* mo, int bmx, int bmy, size_t slot)
+{
+	size_t index = bmy * bmapwidth + bmx;
+	if (bmx < 0 || bmx >= bmapwidth || bmy < 0 || index >= blockthings.size())
+		return;
+
+	blockthings_t& block = blockthings[index];
+	std::vector<blockthing_t>& things = block.things;
+
+	// the records were cleared by a level change since mo was linked
+	if (slot >= things.size() || things[slot].mo != mo)
+		return;
+
+	things[slot].mo = NULL;
+	block.dead++;
+	block.changes++;
+
+	while (!things.empty() && things.back().mo == NULL)
+	{
+		things.pop_back();
+		block.dead--;
+	}
+
+	if (block.dead > 8 && block.dead * 2 > things.size())
+	{
+		size_t live = 0;
+		for (size_t i = 0; i < things.size(); i++)
+		{
+			if (things[i].mo == NULL)
+				continue;
+
+			if (live != i)
+			{
+				things[live] = things[i];
+				things[live].mo->bmapnode.SetSlot(bmx, bmy, live);
+			}
+			live++;
+		}
+
+		things.resize(live);
+		block.dead = 0;
+	}
+}
+
 AActor::ActorBlockMapListNode::ActorBlockMapListNode(AActor *mo) :
 	actor(mo)
 {
@@ -155,6 +256,8 @@ void AActor::ActorBlockMapListNode::Link()
 				
 		        prev[thisidx] = headptr;
 		        *headptr = actor;
+
+				slot[thisidx] = P_AddBlockThing(actor, bmx, bmy);
 			}
 		}
 	}
@@ -188,10 +291,46 @@ void AActor::ActorBlockMapListNode::Unlink()
 				size_t nextidx = nextactor->bmapnode.getIndex(bmx, bmy);
 				nextactor->bmapnode.prev[nextidx] = prevactor;
 			}
+
+			P_RemoveBlockThing(actor, bmx, bmy, slot[thisidx]);
+		}
+	}
+}
+
+//
+// AActor::ActorBlockMapListNode::Refresh
+//
+// Copies the actor's position and radius into its thing records.  Needed
+// whenever a linked actor is moved or resized without relinking it.
+//
+void AActor::ActorBlockMapListNode::Refresh()
+{
+	for (int bmy = originy; bmy < originy + blockcnty; bmy++)
+	{
+		for (int bmx = originx; bmx < originx + blockcntx; bmx++)
+		{
+			const size_t block = bmy * bmapwidth + bmx;
+			if (block >= blockthings.size())
+				return;
+
+			std::vector<blockthing_t>& things = blockthings[block].things;
+			const size_t index = slot[getIndex(bmx, bmy)];
+
+			if (index < things.size() && things[index].mo == actor)
+			{
+				things[index].x = actor->x;
+				things[index].y = actor->y;
+				things[index].radius = actor->radius;
+			}
 		}
 	}
 }
 
+void AActor::ActorBlockMapListNode::SetSlot(int bmx, int bmy, size_t index)
+{
+	slot[getIndex(bmx, bmy)] = index;
+}
+
 AActor* AActor::ActorBlockMapListNode::Next(int bmx, int bmy)
 {
 	if (bmx < 0 || bmx >= bmapwidth || bmy < 0 || bmy >= bmapheight)
@@ -206,6 +345,7 @@ void AActor::ActorBlockMapListNode::clear()
 	blockcntx = blockcnty = 0;
 	memset(prev, 0, sizeof(prev));
 	memset(next, 0, sizeof(next));
+	memset(slot, 0, sizeof(slot));
 }
 
 size_t AActor::ActorBlockMapListNode::getIndex(int bmx, int bmy)
@@ -729,6 +869,67 @@ BOOL P_BlockThingsIterator (int x, int y, BOOL(*func)(AActor*), AActor *actor)
 	return true;
 }
 
+//
+// P_BlockThingsFilterIterator
+//
+// Same as P_BlockThingsIterator, but walks the block's thing records and
+// skips any thing that reject returns true for without calling func.  reject
+// must only discard things that func would ignore without side effects.
+//
+// If func links or unlinks things in this block, the rest of the block is
+// walked through the blocklinks chain so the visiting order is the same as
+// P_BlockThingsIterator.
+//
+BOOL P_BlockThingsFilterIterator (int x, int y, BOOL(*func)(AActor*),
+                                  bool(*reject)(const blockthing_t&))
+{
+	if (x<0 || y<0 || x>=bmapwidth || y>=bmapheight)
+		return true;
+
+	blockthings_t& block = blockthings[y*bmapwidth+x];
+	const unsigned int changes = block.changes;
+
+	for (size_t i = block.things.size(); i-- > 0;)
+	{
+		if (block.things[i].mo == NULL)
+			continue;
+
+		blockthings_scanned++;
+
+		if (reject(block.things[i]))
+		{
+			blockthings_rejected++;
+			continue;
+		}
+
+		AActor *mobj = block.things[i].mo;
+		if (!func (mobj))
+			return false;
+
+		if (block.changes != changes)
+		{
+			blockthings_fallbacks++;
+
+			AActor *next = mobj->bmapnode.Next(x, y);
+			return next ? P_BlockThingsIterator(x, y, func, next) : true;
+		}
+	}
+
+	return true;
+}
+
+BEGIN_COMMAND(blockthingstats)
+{
+	Printf(PRINT_HIGH, "%u block things scanned: %u rejected (%u%%), %u fallbacks\n",
+	       blockthings_scanned, blockthings_rejected,
+	       blockthings_scanned ? (unsigned int)((uint64_t)blockthings_rejected * 100 / blockthings_scanned) : 0,
+	       blockthings_fallbacks);
+
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+		blockthings_scanned = blockthings_rejected = blockthings_fallbacks = 0;
+}
+END_COMMAND(blockthingstats)
+
 
 
 //
@@ -791,6 +992,8 @@ BOOL PIT_AddLineIntercepts (line_t *ld)
 		return false;	// stop checking
 	}
 
+	if (frac > FRACUNIT)
+		return true;	// past the end of the trace, never traversed
 
 	intercept_t intercept;
 	intercept.frac = frac;
@@ -858,6 +1061,9 @@ BOOL PIT_AddThingIntercepts (AActor* thing)
 	if (frac < 0)
 		return true;			// behind source
 
+	if (frac > FRACUNIT)
+		return true;			// past the end of the trace, never traversed
+
 	intercept_t intercept;
 	intercept.frac = frac;
 	intercept.isaline = false;
@@ -868,6 +1074,59 @@ BOOL PIT_AddThingIntercepts (AActor* thing)
 }
 
 
+//
+// Intercept ordering
+//
+// Traversers are handed intercepts nearest first, with ties going to the
+// intercept that was added first, the same order the original selection
+// scan over the whole array produced.  The intercepts are kept in a binary
+// heap of indices and popped one at a time, so a trace that stops at the
+// first wall it hits does not pay to sort everything behind it.
+//
+static std::vector<size_t> interceptheap;
+
+struct InterceptAfter
+{
+	bool operator()(size_t a, size_t b) const
+	{
+		const fixed_t fa = intercepts[a].frac, fb = intercepts[b].frac;
+		return fa > fb || (fa == fb && a > b);
+	}
+};
+
+//
+// P_StartInterceptOrder
+//
+// Prepares the collected intercepts for P_NextIntercept.  The fracs must
+// not change until the traversal is done.
+//
+void P_StartInterceptOrder()
+{
+	interceptheap.resize(intercepts.Size());
+	for (size_t i = 0; i < interceptheap.size(); i++)
+		interceptheap[i] = i;
+
+	std::make_heap(interceptheap.begin(), interceptheap.end(), InterceptAfter());
+}
+
+//
+// P_NextIntercept
+//
+// Returns the nearest intercept that has not been handed out yet, or NULL
+// when all of them have been.
+//
+intercept_t* P_NextIntercept()
+{
+	if (interceptheap.empty())
+		return NULL;
+
+	std::pop_heap(interceptheap.begin(), interceptheap.end(), InterceptAfter());
+	intercept_t* in = &intercepts[interceptheap.back()];
+	interceptheap.pop_back();
+
+	return in;
+}
+
 //
 // P_TraverseIntercepts
 // Returns true if the traverser function returns true
@@ -875,27 +1134,15 @@ BOOL PIT_AddThingIntercepts (AActor* thing)
 //
 BOOL P_TraverseIntercepts (traverser_t func, fixed_t maxfrac)
 {
-	size_t 				count = intercepts.Size();
-	fixed_t 			dist;
-	size_t		scan;
-	intercept_t*		in = 0;
+	intercept_t*		in;
 
-	while (count--)
-	{
-		dist = MAXINT;
-		for (scan = 0 ; scan < intercepts.Size(); scan++)
-		{
-			if (intercepts[scan].frac < dist)
-			{
-				dist = intercepts[scan].frac;
-				in = &intercepts[scan];
-			}
-		}
+	P_StartInterceptOrder();
 
-		if (dist > maxfrac)
+	while ((in = P_NextIntercept()))
+	{
+		if (in->frac > maxfrac)
 			return true;		// checked everything in range
 
-
 		if ( !func (in) )
 			return false;		// don't bother going farther
 
@@ -909,41 +1156,34 @@ BOOL P_TraverseIntercepts (traverser_t func, fixed_t maxfrac)
 
 
 //
-// P_PathTraverse
-// Traces a line from x1,y1 to x2,y2,
-// calling the traverser function for each.
-// Returns true if the traverser function returns true
-// for all lines.
+// Trace block walking
 //
-BOOL P_PathTraverse (fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2, int flags, BOOL (*trav) (intercept_t *))
+// Steps through the mapblocks a trace from x1,y1 to x2,y2 passes through,
+// in order.  This is the walk P_PathTraverse has always done, including its
+// quirks, so anything built on it visits exactly the same blocks.
+//
+struct traceblocks_t
+{
+	int		mapx, mapy;
+	int		xt2, yt2;
+	int		mapxstep, mapystep;
+	fixed_t	xstep, ystep;
+	fixed_t	xintercept, yintercept;
+	int		count;
+};
+
+//
+// P_StartTraceBlocks
+//
+// Sets up the global trace and walk for a trace from x1,y1 to x2,y2.  The
+// first block is in walk.mapx, walk.mapy.
+//
+static void P_StartTraceBlocks (traceblocks_t &walk, fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2)
 {
 	fixed_t 	xt1;
 	fixed_t 	yt1;
-	fixed_t 	xt2;
-	fixed_t 	yt2;
-
-	fixed_t 	xstep;
-	fixed_t 	ystep;
-
 	fixed_t 	partial;
 
-	fixed_t 	xintercept;
-	fixed_t 	yintercept;
-
-	int 		mapx;
-	int 		mapy;
-
-	int 		mapxstep;
-	int 		mapystep;
-
-	int 		count;
-
-	earlyout = flags & PT_EARLYOUT;
-
-	validcount++;
-
-	intercepts.Clear();
-
 	if ( ((x1-bmaporgx)&(MAPBLOCKSIZE-1)) == 0)
 		x1 += FRACUNIT; // don't side exactly on a line
 
@@ -962,92 +1202,329 @@ BOOL P_PathTraverse (fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2, int flags,
 
 	x2 -= bmaporgx;
 	y2 -= bmaporgy;
-	xt2 = x2>>MAPBLOCKSHIFT;
-	yt2 = y2>>MAPBLOCKSHIFT;
+	walk.xt2 = x2>>MAPBLOCKSHIFT;
+	walk.yt2 = y2>>MAPBLOCKSHIFT;
 
-	if (xt2 > xt1)
+	if (walk.xt2 > xt1)
 	{
-		mapxstep = 1;
+		walk.mapxstep = 1;
 		partial = FRACUNIT - ((x1>>MAPBTOFRAC)&(FRACUNIT-1));
-		ystep = FixedDiv (y2-y1,abs(x2-x1));
+		walk.ystep = FixedDiv (y2-y1,abs(x2-x1));
 	}
-	else if (xt2 < xt1)
+	else if (walk.xt2 < xt1)
 	{
-		mapxstep = -1;
+		walk.mapxstep = -1;
 		partial = (x1>>MAPBTOFRAC)&(FRACUNIT-1);
-		ystep = FixedDiv (y2-y1,abs(x2-x1));
+		walk.ystep = FixedDiv (y2-y1,abs(x2-x1));
 	}
 	else
 	{
-		mapxstep = 0;
+		walk.mapxstep = 0;
 		partial = FRACUNIT;
-		ystep = 256*FRACUNIT;
+		walk.ystep = 256*FRACUNIT;
 	}
 
-	yintercept = (y1>>MAPBTOFRAC) + FixedMul (partial, ystep);
+	walk.yintercept = (y1>>MAPBTOFRAC) + FixedMul (partial, walk.ystep);
 
 
-	if (yt2 > yt1)
+	if (walk.yt2 > yt1)
 	{
-		mapystep = 1;
+		walk.mapystep = 1;
 		partial = FRACUNIT - ((y1>>MAPBTOFRAC)&(FRACUNIT-1));
-		xstep = FixedDiv (x2-x1,abs(y2-y1));
+		walk.xstep = FixedDiv (x2-x1,abs(y2-y1));
 	}
-	else if (yt2 < yt1)
+	else if (walk.yt2 < yt1)
 	{
-		mapystep = -1;
+		walk.mapystep = -1;
 		partial = (y1>>MAPBTOFRAC)&(FRACUNIT-1);
-		xstep = FixedDiv (x2-x1,abs(y2-y1));
+		walk.xstep = FixedDiv (x2-x1,abs(y2-y1));
 	}
 	else
 	{
-		mapystep = 0;
+		walk.mapystep = 0;
 		partial = FRACUNIT;
-		xstep = 256*FRACUNIT;
+		walk.xstep = 256*FRACUNIT;
+	}
+	walk.xintercept = (x1>>MAPBTOFRAC) + FixedMul (partial, walk.xstep);
+
+	walk.mapx = xt1;
+	walk.mapy = yt1;
+	walk.count = 0;
+}
+
+//
+// P_NextTraceBlock
+//
+// Steps to the next block of the trace.  Returns false once the last block
+// has been visited.
+//
+static bool P_NextTraceBlock (traceblocks_t &walk)
+{
+	if (walk.mapx == walk.xt2 && walk.mapy == walk.yt2)
+		return false;
+
+	if ( (walk.yintercept >> FRACBITS) == walk.mapy)
+	{
+		walk.yintercept += walk.ystep;
+		walk.mapx += walk.mapxstep;
+	}
+	else if ( (walk.xintercept >> FRACBITS) == walk.mapx)
+	{
+		walk.xintercept += walk.xstep;
+		walk.mapy += walk.mapystep;
 	}
-	xintercept = (x1>>MAPBTOFRAC) + FixedMul (partial, xstep);
 
-	// Step through map blocks.
 	// Count is present to prevent a round off error
 	// from skipping the break.
-	mapx = xt1;
-	mapy = yt1;
+	return ++walk.count < 64;
+}
+
+
+//
+// P_PathTraverse
+// Traces a line from x1,y1 to x2,y2,
+// calling the traverser function for each.
+// Returns true if the traverser function returns true
+// for all lines.
+//
+BOOL P_PathTraverse (fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2, int flags, BOOL (*trav) (intercept_t *))
+{
+	traceblocks_t	walk;
+
+	earlyout = flags & PT_EARLYOUT;
+
+	validcount++;
+
+	intercepts.Clear();
+
+	// Step through map blocks.
+	P_StartTraceBlocks (walk, x1, y1, x2, y2);
 
-	for (count = 0 ; count < 64 ; count++)
+	do
 	{
 		if (flags & PT_ADDLINES)
 		{
-			if (!P_BlockLinesIterator (mapx, mapy,PIT_AddLineIntercepts))
+			if (!P_BlockLinesIterator (walk.mapx, walk.mapy,PIT_AddLineIntercepts))
 				return false;	// early out
 		}
 
 		if (flags & PT_ADDTHINGS)
 		{
-			if (!P_BlockThingsIterator (mapx, mapy,PIT_AddThingIntercepts))
+			if (!P_BlockThingsIterator (walk.mapx, walk.mapy,PIT_AddThingIntercepts))
 				return false;	// early out
 		}
+	} while (P_NextTraceBlock (walk));
+
+	// go through the sorted list
+	return P_TraverseIntercepts ( trav, FRACUNIT );
+}
+
+
+//
+// Fan traces
+//
+// A set of traces from the same origin, such as the tracers of an autoaim
+// spread, that share one pass over the things in the blocks they cross.
+// P_StartFanTrace records the blocks each trace walks through and gathers
+// the things in those blocks that pass a filter, once.  P_FanPathTraverse
+// then runs one trace through lines and things exactly like P_PathTraverse,
+// except that things come from the gathered lists.
+//
+// The filter may only drop things that the traverser ignores without side
+// effects, and nothing may be moved or linked into the blockmap while the
+// traces are run.
+//
+struct fantrace_t
+{
+	fixed_t		x2, y2;
+	size_t		firstblock;
+	size_t		numblocks;
+};
 
-		if (mapx == xt2 && mapy == yt2)
+struct fanblock_t
+{
+	int			mapx, mapy;
+	size_t		index;		// into fanblockslot
+	int			slot;		// gathered things of the block, or -1
+};
+
+static fixed_t					fanx1, fany1;
+static std::vector<fantrace_t>	fantraces;
+static std::vector<fanblock_t>	fanblocks;
+static std::vector<int>			fanblockslot;		// bmapwidth*bmapheight, -1 if not gathered
+static std::vector<size_t>		fanslotstart;		// per slot, into fanthings; one past the end
+static std::vector<AActor *>	fanthings;
+
+//
+// P_StartFanTrace
+//
+// Prepares count traces from x1,y1 to each x2[i],y2[i].  Only things that
+// filter returns true for are added as intercepts.
+//
+void P_StartFanTrace (fixed_t x1, fixed_t y1, const fixed_t *x2, const fixed_t *y2, int count,
+                      bool (*filter)(AActor *))
+{
+	const size_t numblocks = bmapwidth * bmapheight;
+	if (fanblockslot.size() != numblocks)
+	{
+		fanblockslot.assign(numblocks, -1);
+	}
+	else
+	{
+		// forget the previous fan's blocks
+		for (size_t i = 0; i < fanblocks.size(); i++)
 		{
-			break;
+			if (fanblocks[i].slot >= 0)
+				fanblockslot[fanblocks[i].index] = -1;
 		}
+	}
+
+	fanx1 = x1;
+	fany1 = y1;
+	fantraces.resize(count);
+	fanblocks.clear();
+	fanslotstart.clear();
+	fanslotstart.push_back(0);
+	fanthings.clear();
+
+	for (int i = 0; i < count; i++)
+	{
+		fantrace_t &fan = fantraces[i];
+		fan.x2 = x2[i];
+		fan.y2 = y2[i];
+		fan.firstblock = fanblocks.size();
+
+		traceblocks_t walk;
+		P_StartTraceBlocks (walk, x1, y1, x2[i], y2[i]);
 
-		if ( (yintercept >> FRACBITS) == mapy)
+		do
 		{
-			yintercept += ystep;
-			mapx += mapxstep;
-		}
-		else if ( (xintercept >> FRACBITS) == mapx)
+			fanblock_t block;
+			block.mapx = walk.mapx;
+			block.mapy = walk.mapy;
+			block.index = 0;
+			block.slot = -1;
+
+			if (walk.mapx >= 0 && walk.mapy >= 0 && walk.mapx < bmapwidth && walk.mapy < bmapheight)
+			{
+				block.index = walk.mapy * bmapwidth + walk.mapx;
+
+				int &slot = fanblockslot[block.index];
+				if (slot < 0)
+				{
+					// first trace to reach this block gathers its things
+					for (AActor *mo = blocklinks[block.index]; mo;
+					     mo = mo->bmapnode.Next(walk.mapx, walk.mapy))
+					{
+						if (filter (mo))
+							fanthings.push_back (mo);
+					}
+
+					slot = fanslotstart.size() - 1;
+					fanslotstart.push_back (fanthings.size());
+				}
+				block.slot = slot;
+			}
+
+			fanblocks.push_back (block);
+		} while (P_NextTraceBlock (walk));
+
+		fan.numblocks = fanblocks.size() - fan.firstblock;
+	}
+}
+
+//
+// P_FanPathTraverse
+//
+// Runs trace number tracer of the fan set up by P_StartFanTrace through
+// lines and things, the same as P_PathTraverse with PT_ADDLINES|PT_ADDTHINGS.
+//
+BOOL P_FanPathTraverse (int tracer, BOOL (*trav) (intercept_t *))
+{
+	const fantrace_t &fan = fantraces[tracer];
+	traceblocks_t walk;
+
+	earlyout = false;
+
+	validcount++;
+
+	intercepts.Clear();
+
+	P_StartTraceBlocks (walk, fanx1, fany1, fan.x2, fan.y2);
+
+	for (size_t i = fan.firstblock; i < fan.firstblock + fan.numblocks; i++)
+	{
+		const fanblock_t &block = fanblocks[i];
+
+		if (!P_BlockLinesIterator (block.mapx, block.mapy, PIT_AddLineIntercepts))
+			return false;	// early out
+
+		if (block.slot >= 0)
 		{
-			xintercept += xstep;
-			mapy += mapystep;
+			for (size_t j = fanslotstart[block.slot]; j < fanslotstart[block.slot + 1]; j++)
+				PIT_AddThingIntercepts (fanthings[j]);
 		}
-
 	}
+
 	// go through the sorted list
 	return P_TraverseIntercepts ( trav, FRACUNIT );
 }
 
+static size_t tracebench_visited;
+
+static BOOL PTR_BenchTraverse (intercept_t *in)
+{
+	tracebench_visited++;
+	return true;
+}
+
+//
+// tracebench [count] [distance]
+//
+// Fires count full-length traces spread evenly around the console player (or
+// the middle of the blockmap) through lines and things, and reports the
+// average time and number of intercepts per trace.
+//
+BEGIN_COMMAND(tracebench)
+{
+	if (bmapwidth <= 0 || bmapheight <= 0)
+	{
+		Printf(PRINT_HIGH, "tracebench: no level loaded\n");
+		return;
+	}
+
+	const int count = argc > 1 ? MAX(atoi(argv[1]), 1) : 1024;
+	const fixed_t distance = (argc > 2 ? MAX(atoi(argv[2]), 1) : 8192) << FRACBITS;
+
+	fixed_t x = bmaporgx + (bmapwidth << MAPBLOCKSHIFT) / 2;
+	fixed_t y = bmaporgy + (bmapheight << MAPBLOCKSHIFT) / 2;
+
+	AActor* mo = consoleplayer().mo;
+	if (mo)
+	{
+		x = mo->x;
+		y = mo->y;
+	}
+
+	tracebench_visited = 0;
+	const dtime_t start = I_GetTime();
+
+	for (int i = 0; i < count; i++)
+	{
+		const unsigned int an = (unsigned int)(((uint64_t)i << 32) / count) >> ANGLETOFINESHIFT;
+		P_PathTraverse(x, y, x + FixedMul(distance, finecosine[an]),
+		               y + FixedMul(distance, finesine[an]), PT_ADDLINES | PT_ADDTHINGS,
+		               PTR_BenchTraverse);
+	}
+
+	const dtime_t elapsed = I_GetTime() - start;
+
+	Printf(PRINT_HIGH, "tracebench: %d traces of %d units, %.2f intercepts and %.3f us per trace\n",
+	       count, distance >> FRACBITS, double(tracebench_visited) / count,
+	       double(elapsed) / (1000.0 * count));
+}
+END_COMMAND(tracebench)
+
 //
 // P_PointToAngle
 //
@@ -1205,60 +1682,46 @@ bool P_ActorInFOV(AActor* origin, AActor* mo , float f, fixed_t dist)
 
 static AActor* RoughBlockCheck(AActor* mo, int index, angle_t fov)
 {
-	AActor* link;
+	// Walk the block's thing records from the back, which is the
+	// blocklinks order.  Nothing here links or unlinks things.
+	const std::vector<blockthing_t>& things = blockthings[index].things;
 
-	link = blocklinks[index];
-	while (link)
+	for (size_t i = things.size(); i-- > 0;)
 	{
+		AActor* link = things[i].mo;
+
+		// skip removed records
+		if (link == NULL)
+			continue;
+
 		// skip non-shootable actors
 		if (!(link->flags & MF_SHOOTABLE))
-		{
-			link = link->snext;
 			continue;
-		}
 
 		// skip the projectile's owner
 		if (link == mo->target)
-		{
-			link = link->snext;
 			continue;
-		}
-		
+
 		// [Blair] Don't target friendlies
 		if (P_IsFriendlyThing(mo->target, link))
-		{
-			link = link->snext;
 			continue;
-		}
 
 		// [Blair] Don't target spectators
 		if (link->player && link->player->spectator)
-		{
-			link = link->snext;
 			continue;
-		}
 
 		// [Blair] Don't target teammates
 		if (mo->target->player && link->player &&
 			P_AreTeammates((player_t&)mo->target->player, (player_t&)link->player))
-		{
-			link = link->snext;
 			continue;
-		}
-		
+
 		// skip actors outside of specified FOV
-		 if (fov > 0 && !P_CheckFov(mo, link, fov))
-		{
-			link = link->snext;
+		if (fov > 0 && !P_CheckFov(mo, link, fov))
 			continue;
-		}
 
 		// skip actors not in line of sight
 		if (!P_CheckSight(mo, link))
-		{
-			link = link->snext;
 			continue;
-		}
 
 		// all good! return it.
 		return link;
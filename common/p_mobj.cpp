@@ -51,6 +51,8 @@
 #include "hu_speedometer.h"
 #endif
 
+#include <algorithm>
+
 void SV_UpdateMobj(AActor* mo);
 void SV_UpdateMobjState(AActor* mo);
 
@@ -131,8 +133,10 @@ AActor::AActor()
       info(NULL), tics(0), state(NULL), damage(0), flags(0), flags2(0),
       flags3(0), oflags(0), special1(0), special2(0), health(0), movedir(0), movecount(0), visdir(0),
       reactiontime(0), threshold(0), player(NULL), lastlook(0), special(0), inext(NULL),
-      iprev(NULL), translation(translationref_t()), translucency(0), waterlevel(0),
-      gear(0), onground(false), touching_sectorlist(NULL), deadtic(0), oldframe(0),
+      iprev(NULL), tnext(NULL), tprev(NULL), translation(translationref_t()),
+      translucency(0), waterlevel(0),
+      gear(0), onground(false), touching_sectorlist(NULL), secnodex(0), secnodey(0),
+      secnoderadius(0), secnodegen(0), deadtic(0), oldframe(0),
       rndindex(0), netid(0), tid(0), baseline_set(false), bmapnode(this)
 {
 	memset(args, 0, sizeof(args));
@@ -155,9 +159,12 @@ AActor::AActor(const AActor& other)
       health(other.health), movedir(other.movedir), movecount(other.movecount),
       visdir(other.visdir), reactiontime(other.reactiontime), threshold(other.threshold),
       player(other.player), lastlook(other.lastlook), special(other.special),
-      inext(other.inext), iprev(other.iprev), translation(other.translation),
+      inext(other.inext), iprev(other.iprev), tnext(NULL), tprev(NULL),
+      translation(other.translation),
       translucency(other.translucency), waterlevel(other.waterlevel), gear(other.gear),
       onground(other.onground), touching_sectorlist(other.touching_sectorlist),
+      secnodex(other.secnodex), secnodey(other.secnodey),
+      secnoderadius(other.secnoderadius), secnodegen(other.secnodegen),
       deadtic(other.deadtic), oldframe(other.oldframe), rndindex(other.rndindex),
       netid(other.netid), tid(other.tid), baseline_set(false), bmapnode(other.bmapnode)
 {
@@ -221,6 +228,10 @@ AActor &AActor::operator= (const AActor &other)
 	gear = other.gear;
     onground = other.onground;
     touching_sectorlist = other.touching_sectorlist;
+    secnodex = other.secnodex;
+    secnodey = other.secnodey;
+    secnoderadius = other.secnoderadius;
+    secnodegen = other.secnodegen;
     deadtic = other.deadtic;
     oldframe = other.oldframe;
     rndindex = other.rndindex;
@@ -249,8 +260,10 @@ AActor::AActor(fixed_t ix, fixed_t iy, fixed_t iz, mobjtype_t itype)
       info(NULL), tics(0), state(NULL), damage(0), flags(0), flags2(0), flags3(0), oflags(0),
       special1(0), special2(0), health(0), movedir(0), movecount(0), visdir(0),
       reactiontime(0), threshold(0), player(NULL), lastlook(0), special(0), inext(NULL),
-      iprev(NULL), translation(translationref_t()), translucency(0), waterlevel(0),
-      gear(0), onground(false), touching_sectorlist(NULL), deadtic(0), oldframe(0),
+      iprev(NULL), tnext(NULL), tprev(NULL), translation(translationref_t()),
+      translucency(0), waterlevel(0),
+      gear(0), onground(false), touching_sectorlist(NULL), secnodex(0), secnodey(0),
+      secnoderadius(0), secnodegen(0), deadtic(0), oldframe(0),
       rndindex(0), netid(0), tid(0), baseline_set(false), bmapnode(this)
 {
 	// Fly!!! fix it in P_RespawnSpecial
@@ -262,6 +275,7 @@ AActor::AActor(fixed_t ix, fixed_t iy, fixed_t iz, mobjtype_t itype)
 	self.init(this);
 	info = &mobjinfo[itype];
 	type = itype;
+	AddToTypeList();
 	x = ix;
 	y = iy;
 	radius = info->radius;
@@ -430,6 +444,7 @@ void AActor::Destroy ()
 
 	// [RH] Unlink from tid chain
 	RemoveFromHash ();
+	RemoveFromTypeList ();
 
 	// unlink from sector and block lists
 	UnlinkFromWorld ();
@@ -974,6 +989,7 @@ void AActor::Serialize (FArchive &arc)
 		floorsector = subsector->sector;
 
 		AddToHash ();
+		AddToTypeList ();
 		if(playerid && validplayer(idplayer(playerid)))
 		{
 			player = &idplayer(playerid);
@@ -1994,6 +2010,95 @@ void AActor::RemoveFromHash ()
 	}
 }
 
+AActor* AActor::TypeListHead[NUMMOBJTYPES];
+AActor* AActor::TypeListTail[NUMMOBJTYPES];
+int AActor::TypeListCount[NUMMOBJTYPES];
+
+//
+// AActor::ClearTypeLists
+//
+// Forgets every per-type actor list. Actors unlink themselves when they are
+// destroyed, so this only needs to run once all thinkers are gone.
+//
+void AActor::ClearTypeLists ()
+{
+	for (size_t i = 0; i < NUMMOBJTYPES; i++)
+	{
+		TypeListHead[i] = TypeListTail[i] = NULL;
+		TypeListCount[i] = 0;
+	}
+}
+
+//
+// AActor::AddToTypeList
+//
+// Appends an mobj to the list for its type, so the list stays in the same
+// order as the thinkers were spawned in.
+//
+void AActor::AddToTypeList ()
+{
+	tnext = NULL;
+	tprev = TypeListTail[type];
+
+	if (tprev)
+		tprev->tnext = this;
+	else
+		TypeListHead[type] = this;
+
+	TypeListTail[type] = this;
+	TypeListCount[type]++;
+}
+
+//
+// AActor::RemoveFromTypeList
+//
+// Removes an mobj from the list for its type. Does nothing if it was never
+// added.
+//
+void AActor::RemoveFromTypeList ()
+{
+	if (tprev == NULL && TypeListHead[type] != this)
+		return;
+
+	if (tprev)
+		tprev->tnext = tnext;
+	else
+		TypeListHead[type] = tnext;
+
+	if (tnext)
+		tnext->tprev = tprev;
+	else
+		TypeListTail[type] = tprev;
+
+	tnext = tprev = NULL;
+	TypeListCount[type]--;
+}
+
+//
+// AActor::FirstOfType
+//
+AActor *AActor::FirstOfType (mobjtype_t kind)
+{
+	if ((unsigned)kind >= NUMMOBJTYPES)
+		return NULL;
+
+	return TypeListHead[kind];
+}
+
+//
+// AActor::CountOfType
+//
+// Returns the number of mobjs of the given type on the level, without
+// walking the thinker list.
+//
+int AActor::CountOfType (mobjtype_t kind)
+{
+	if ((unsigned)kind >= NUMMOBJTYPES)
+		return 0;
+
+	return TypeListCount[kind];
+}
+
 //
 // P_FindMobjByTid
 //
@@ -2174,6 +2279,7 @@ bool P_CheckMissileSpawn (AActor* th)
 	th->x += th->momx>>1;
 	th->y += th->momy>>1;
 	th->z += th->momz>>1;
+	th->bmapnode.Refresh();
 
 	// killough 3/15/98: no dropoff (really = don't care for missiles)
 
@@ -2330,7 +2436,7 @@ AActor* P_SpawnMissile (AActor *source, AActor *dest, mobjtype_t type)
 	th = new AActor (source->x, source->y, source->z + 4*8*FRACUNIT, type);
 
     if (th->info->seesound)
-		S_Sound (th, CHAN_VOICE, th->info->seesound, 1, ATTN_NORM);
+		S_MobjSound(th, CHAN_VOICE, th->info->seesound, mobjsounds[th->type].see, 1, ATTN_NORM);
 
     th->target = source->ptr();	// where it came from
     an = P_PointToAngle (source->x, source->y, dest_x, dest_y);
@@ -2403,7 +2509,7 @@ void P_SpawnPlayerMissile (AActor *source, mobjtype_t type)
 	AActor *th = new AActor (source->x, source->y, source->z + 4*8*FRACUNIT, type);
 
 	if (th->info->seesound)
-		S_Sound (th, CHAN_VOICE, th->info->seesound, 1, ATTN_NORM);
+		S_MobjSound(th, CHAN_VOICE, th->info->seesound, mobjsounds[th->type].see, 1, ATTN_NORM);
 
 	th->target = source->ptr();
 	th->angle = an;
@@ -2474,7 +2580,7 @@ void P_SpawnMBF21PlayerMissile(AActor* source, mobjtype_t type, fixed_t angle, f
 	AActor* th = new AActor(source->x, source->y, source->z + 4 * 8 * FRACUNIT, type);
 
 	if (th->info->seesound)
-		S_Sound(th, CHAN_VOICE, th->info->seesound, 1, ATTN_NORM);
+		S_MobjSound(th, CHAN_VOICE, th->info->seesound, mobjsounds[th->type].see, 1, ATTN_NORM);
 
 	th->target = source->ptr();
 	an += (angle_t)(((int64_t)angle << 16) / 360);
@@ -2507,6 +2613,7 @@ void P_SpawnMBF21PlayerMissile(AActor* source, mobjtype_t type, fixed_t angle, f
 	th->x += FixedMul(xyofs, finecosine[an]);
 	th->y += FixedMul(xyofs, finesine[an]);
 	th->z += zofs;
+	th->bmapnode.Refresh();
 
 	// [Blair] Set a tracer for player tracer weapons.
 	// This allows tracer projectiles fired from players to seek what
@@ -2670,7 +2777,7 @@ void P_ExplodeMissile (AActor* mo)
 		mo->flags &= ~MF_MISSILE;
 
 		if (mo->info->deathsound)
-			S_Sound (mo, CHAN_VOICE, mo->info->deathsound, 1, ATTN_NORM);
+			S_MobjSound(mo, CHAN_VOICE, mo->info->deathsound, mobjsounds[mo->type].death, 1, ATTN_NORM);
 
 		mo->effects = 0;		// [RH]
 	}
@@ -3043,6 +3150,7 @@ void P_SpawnMapThing (mapthing2_t *mthing, int position)
 	{
 		mobj->radius = mobj->args[0] << FRACBITS;
 		mobj->height = mobj->args[1] << FRACBITS;
+		mobj->bmapnode.Refresh();
 	}
 
 	// [AM] Adjust monster health based on server setting
@@ -3276,17 +3384,39 @@ BEGIN_COMMAND(cheat_mobjs)
 	Printf("== %s ==", mobj_type);
 
 	AActor* mo;
-	TThinkerIterator<AActor> iterator;
+	FActorTypeIterator iterator((mobjtype_t)mobj_index);
 	while ((mo = iterator.Next()))
 	{
-		if (mo->type == mobj_index)
+		Printf("ID: %d\n", mo->netid);
+		Printf("  %.1f, %.1f, %.1f\n", FIXED2FLOAT(mo->x), FIXED2FLOAT(mo->y),
+		       FIXED2FLOAT(mo->z));
+	}
+}
+END_COMMAND(cheat_mobjs)
+
+BEGIN_COMMAND(mobjcount)
+{
+	// sort the types with the most actors first
+	std::vector<std::pair<int, int> > counts;
+	int total = 0;
+
+	for (size_t i = 0; i < NUMMOBJTYPES; i++)
+	{
+		const int count = AActor::CountOfType((mobjtype_t)i);
+		if (count > 0)
 		{
-			Printf("ID: %d\n", mo->netid);
-			Printf("  %.1f, %.1f, %.1f\n", FIXED2FLOAT(mo->x), FIXED2FLOAT(mo->y),
-			       FIXED2FLOAT(mo->z));
+			counts.push_back(std::make_pair(-count, (int)i));
+			total += count;
 		}
 	}
+
+	std::sort(counts.begin(), counts.end());
+
+	for (size_t i = 0; i < counts.size(); i++)
+		Printf("%6d %s\n", -counts[i].first, ::mobjinfo[counts[i].second].name);
+
+	Printf("%6d actors of %d types\n", total, (int)counts.size());
 }
-END_COMMAND(cheat_mobjs)
+END_COMMAND(mobjcount)
 
 VERSION_CONTROL (p_mobj_cpp, "$Id$")
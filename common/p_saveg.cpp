@@ -263,6 +263,9 @@ void P_SerializeWorld (FArchive &arc)
 					>> si->midtexture;
 			}
 		}
+
+		// sector heights were restored without going through P_SetFloorHeight
+		P_InitSoundGraph();
 	}
 }
 
@@ -44,6 +44,9 @@
 #include "p_lnspec.h"
 #include "v_palette.h"
 #include "c_console.h"
+#include "c_dispatch.h"
+#include "cmdlib.h"
+#include "m_fileio.h"
 #include "p_horde.h"
 #include "g_gametype.h"
 
@@ -64,6 +67,7 @@ void P_SpawnCompatibleSectorSpecial(sector_t* sector);
 static void P_SetupLevelFloorPlane(sector_t *sector);
 static void P_SetupLevelCeilingPlane(sector_t *sector);
 static void P_SetupSlopes();
+static void P_InitBlockLinks();
 void P_InvertPlane(plane_t *plane);
 void P_SetupWorldState();
 int P_TranslateSectorSpecial(int special);
@@ -72,6 +76,7 @@ extern dyncolormap_t NormalLight;
 extern AActor* shootthing;
 
 EXTERN_CVAR(g_thingfilter)
+EXTERN_CVAR(p_mapcache)
 
 bool			g_ValidLevel = false;
 
@@ -118,6 +123,7 @@ int 			bmapheight; 	// size in mapblocks
 
 int				*blockmap;		// int for larger maps ([RH] Made int because BOOM does)
 int				*blockmaplump;	// offsets in blockmap are from here
+static int		blockmaplumpsize;	// ints in blockmaplump
 
 fixed_t 		bmaporgx;		// origin of block map
 fixed_t 		bmaporgy;
@@ -136,6 +142,14 @@ AActor**		blocklinks;		// for thing chains
 byte*			rejectmatrix;
 BOOL			rejectempty;
 
+// Map fingerprint as it was worked out before it covered the whole lumps,
+// only used to recognise E2M7
+static byte		legacy_fingerprint[16];
+
+// Key of the processed map cache entry for the current map
+static byte		mapcache_key[16];
+static const uint32_t MAPCACHE_VERSION = 1;
+
 
 // Maintain single and multi player starting spots.
 std::vector<mapthing2_t> DeathMatchStarts;
@@ -153,7 +167,7 @@ static bool cmpPlayerNum(mapthing2_t i, mapthing2_t j)
 //
 void P_LoadVertexes (int lump)
 {
-	byte *data;
+	const byte *data;
 	int i;
 
 	// Determine number of vertices:
@@ -164,18 +178,18 @@ void P_LoadVertexes (int lump)
 	vertexes = (vertex_t *)Z_Malloc (numvertexes*sizeof(vertex_t), PU_LEVEL, 0);
 
 	// Load data into cache.
-	data = (byte *)W_CacheLumpNum (lump, PU_STATIC);
+	data = (const byte *)W_MapLumpNum (lump, W_AlignOf<mapvertex_t>::value);
 
 	// Copy and convert vertex coordinates,
 	// internal representation as fixed.
 	for (i = 0; i < numvertexes; i++)
 	{
-		vertexes[i].x = LESHORT(((mapvertex_t *)data)[i].x)<<FRACBITS;
-		vertexes[i].y = LESHORT(((mapvertex_t *)data)[i].y)<<FRACBITS;
+		vertexes[i].x = LESHORT(((const mapvertex_t *)data)[i].x)<<FRACBITS;
+		vertexes[i].y = LESHORT(((const mapvertex_t *)data)[i].y)<<FRACBITS;
 	}
 
 	// Free buffer memory.
-	Z_Free (data);
+	W_UnmapLumpNum (lump, data);
 }
 
 void P_LoadSegsHelper(int side, short angle, int linedef, seg_t *li)
@@ -231,7 +245,7 @@ void P_LoadSegs (int lump, bool isdeepbsp = false)
 		    "P_LoadSegs: SEGS lump is empty - levels without nodes are not supported.");
 	}
 
-	byte* data;
+	const byte* data;
 
 	if (isdeepbsp)
 		numsegs = W_LumpLength (lump) / sizeof(mapseg_deepbsp_t);
@@ -239,14 +253,14 @@ void P_LoadSegs (int lump, bool isdeepbsp = false)
 		numsegs = W_LumpLength (lump) / sizeof(mapseg_t);
 	segs = (seg_t *)Z_Malloc (numsegs*sizeof(seg_t), PU_LEVEL, 0);
 	memset (segs, 0, numsegs*sizeof(seg_t));
-	data = (byte*)W_CacheLumpNum (lump, PU_STATIC);
+	data = (const byte*)W_MapLumpNum (lump, isdeepbsp ? sizeof(int32_t) : W_AlignOf<mapseg_t>::value);
 
 	for (int i = 0; i < numsegs; i++)
 	{
 		seg_t *li = segs+i;
 		if (isdeepbsp)
 		{
-			mapseg_deepbsp_t *ml = (mapseg_deepbsp_t*) data+i;
+			const mapseg_deepbsp_t *ml = (const mapseg_deepbsp_t*) data+i;
 			int v;
 
 			v = LELONG(ml->v1);
@@ -267,7 +281,7 @@ void P_LoadSegs (int lump, bool isdeepbsp = false)
 		}
 		else
 		{
-			mapseg_t *ml = (mapseg_t*) data+i;
+			const mapseg_t *ml = (const mapseg_t*) data+i;
 			short v;
 
 			v = LESHORT(ml->v1);
@@ -288,7 +302,7 @@ void P_LoadSegs (int lump, bool isdeepbsp = false)
 		}
 	}
 
-	Z_Free (data);
+	W_UnmapLumpNum (lump, data);
 }
 
 //
@@ -302,7 +316,7 @@ void P_LoadSubsectors(int lump, bool isdeepbsp = false)
 		    "P_LoadSubsectors: SSECTORS lump is empty - levels without nodes are not supported.");
 	}
 
-	byte *data;
+	const byte *data;
 	int i;
 
 	if (isdeepbsp)
@@ -310,27 +324,27 @@ void P_LoadSubsectors(int lump, bool isdeepbsp = false)
 	else
 		numsubsectors = W_LumpLength (lump) / sizeof(mapsubsector_t);
 	subsectors = (subsector_t *)Z_Malloc (numsubsectors*sizeof(subsector_t),PU_LEVEL,0);
-	data = (byte *)W_CacheLumpNum (lump,PU_STATIC);
+	data = (const byte *)W_MapLumpNum (lump, isdeepbsp ? sizeof(int32_t) : W_AlignOf<mapsubsector_t>::value);
 
 	memset (subsectors, 0, numsubsectors*sizeof(subsector_t));
 
 	if (isdeepbsp) {
 		for (i = 0; i < numsubsectors; i++)
 		{
-			subsectors[i].numlines = LESHORT(((mapsubsector_deepbsp_t *)data)[i].numsegs);
-			subsectors[i].firstline = (unsigned int)LELONG(((mapsubsector_deepbsp_t *)data)[i].firstseg);
+			subsectors[i].numlines = LESHORT(((const mapsubsector_deepbsp_t *)data)[i].numsegs);
+			subsectors[i].firstline = (unsigned int)LELONG(((const mapsubsector_deepbsp_t *)data)[i].firstseg);
 		}
 	}
 	else
 	{
 		for (i = 0; i < numsubsectors; i++)
 		{
-			subsectors[i].numlines = (unsigned short)LESHORT(((mapsubsector_t *)data)[i].numsegs);
-			subsectors[i].firstline = (unsigned short)LESHORT(((mapsubsector_t *)data)[i].firstseg);
+			subsectors[i].numlines = (unsigned short)LESHORT(((const mapsubsector_t *)data)[i].numsegs);
+			subsectors[i].firstline = (unsigned short)LESHORT(((const mapsubsector_t *)data)[i].firstseg);
 		}
 	}
 
-	Z_Free(data);
+	W_UnmapLumpNum(lump, data);
 }
 
 
@@ -350,11 +364,11 @@ void P_LoadSectors (int lump)
 	sectors = new sector_t[numsectors];
 	memset(sectors, 0, sizeof(sector_t)*numsectors);
 
-	byte* data = (byte*)W_CacheLumpNum(lump, PU_STATIC);
+	const byte* data = (const byte*)W_MapLumpNum(lump, W_AlignOf<mapsector_t>::value);
 
 	const int defSeqType = (level.flags & LEVEL_SNDSEQTOTALCTRL) ? 0 : -1;
 
-	mapsector_t* ms = (mapsector_t*)data;
+	const mapsector_t* ms = (const mapsector_t*)data;
 	sector_t* ss = sectors;
 	for (int i = 0; i < numsectors; i++, ss++, ms++)
 	{
@@ -429,7 +443,7 @@ void P_LoadSectors (int lump)
 		ss->movefactor = ORIG_FRICTION_FACTOR;
 	}
 
-	Z_Free (data);
+	W_UnmapLumpNum (lump, data);
 }
 
 
@@ -444,18 +458,18 @@ void P_LoadNodes (int lump)
 		    "P_LoadNodes: NODES lump is empty - levels without nodes are not supported.");
 	}
 
-	byte*		data;
+	const byte*	data;
 	int 		i;
 	int 		j;
 	int 		k;
-	mapnode_t*	mn;
+	const mapnode_t*	mn;
 	node_t* 	no;
 
 	numnodes = W_LumpLength (lump) / sizeof(mapnode_t);
 	nodes = (node_t *)Z_Malloc (numnodes*sizeof(node_t), PU_LEVEL, 0);
-	data = (byte *)W_CacheLumpNum (lump, PU_STATIC);
+	data = (const byte *)W_MapLumpNum (lump, W_AlignOf<mapnode_t>::value);
 
-	mn = (mapnode_t *)data;
+	mn = (const mapnode_t *)data;
 	no = nodes;
 
 	for (i = 0; i < numnodes; i++, no++, mn++)
@@ -481,7 +495,7 @@ void P_LoadNodes (int lump)
 		}
 	}
 
-	Z_Free (data);
+	W_UnmapLumpNum (lump, data);
 }
 
 //
@@ -495,17 +509,17 @@ void P_LoadNodes_DeePBSP(int lump)
 		    "P_LoadNodes_DeePBSP: NODES lump is empty - levels without nodes are not supported.");
 	}
 
-	byte*		data;
-	mapnode_deepbsp_t*	mn;
+	const byte*	data;
+	const mapnode_deepbsp_t*	mn;
 	node_t* 	no;
 
 	numnodes = (W_LumpLength (lump) - 8) / sizeof(mapnode_deepbsp_t);
 	nodes = (node_t *)Z_Malloc (numnodes*sizeof(node_t), PU_LEVEL, 0);
-	data = (byte*) W_CacheLumpNum (lump, PU_STATIC);
+	data = (const byte*) W_MapLumpNum (lump, sizeof(int32_t));
 
 	data += 8;
 
-	mn = (mapnode_deepbsp_t *)data;
+	mn = (const mapnode_deepbsp_t *)data;
 	no = nodes;
 
 	for (int i = 0; i < numnodes; i++, mn++, no++)
@@ -523,7 +537,7 @@ void P_LoadNodes_DeePBSP(int lump)
 		}
 	}
 
-	Z_Free (data - 8);
+	W_UnmapLumpNum (lump, data - 8);
 }
 
 //
@@ -533,18 +547,18 @@ void P_LoadNodes_DeePBSP(int lump)
 bool P_LoadXNOD(int lump)
 {
 	size_t len = W_LumpLength(lump);
-	byte *data = (byte *) W_CacheLumpNum(lump, PU_STATIC);
+	const byte *data = (const byte *) W_MapLumpNum(lump, sizeof(int32_t));
 	byte* output = NULL;
 
 	if (len < 4)
 	{
-		Z_Free(data);
+		W_UnmapLumpNum(lump, data);
 		return false;
 	}
 
 	bool compressed = memcmp(data, "ZNOD", 4) == 0;
 
-	byte *p;
+	const byte *p;
 	// [EB] decompress compressed nodes
 	// adapted from Crispy Doom
 	if (compressed)
@@ -560,7 +574,7 @@ bool P_LoadXNOD(int lump)
 		// initialize stream state for decompression
 		zstream = (z_stream*)M_Malloc(sizeof(*zstream));
 		memset(zstream, 0, sizeof(*zstream));
-		zstream->next_in = data + 4;
+		zstream->next_in = const_cast<byte*>(data) + 4;
 		zstream->avail_in = len - 4;
 		zstream->next_out = output;
 		zstream->avail_out = outlen;
@@ -711,7 +725,7 @@ bool P_LoadXNOD(int lump)
 		}
 	}
 
-	Z_Free(data);
+	W_UnmapLumpNum(lump, data);
 	Z_Free(output);
 
 	return true;
@@ -725,27 +739,20 @@ enum nodetype_t {
 };
 
 nodetype_t P_CheckNodeType(int lump) {
-	byte *data = (byte *) W_CacheLumpNum(lump, PU_STATIC);
-
-	if (memcmp(data, "xNd4\0\0\0\0", 8) == 0)
-	{
-		Z_Free(data);
-		return NT_DEEP;
-	}
+	const size_t len = W_LumpLength(lump);
+	const byte *data = (const byte *) W_MapLumpNum(lump, 1);
+	nodetype_t type = NT_STANDARD;
 
-	if (memcmp(data, "XNOD", 4) == 0)
-	{
-		Z_Free(data);
-		return NT_XNOD;
-	}
+	if (len >= 8 && memcmp(data, "xNd4\0\0\0\0", 8) == 0)
+		type = NT_DEEP;
+	else if (len >= 4 && memcmp(data, "XNOD", 4) == 0)
+		type = NT_XNOD;
+	else if (len >= 4 && memcmp(data, "ZNOD", 4) == 0)
+		type = NT_ZNOD;
 
-	if (memcmp(data, "ZNOD", 4) == 0)
-	{
-		Z_Free(data);
-		return NT_ZNOD;
-	}
+	W_UnmapLumpNum(lump, data);
 
-	return NT_STANDARD;
+	return type;
 }
 
 //
@@ -754,9 +761,9 @@ nodetype_t P_CheckNodeType(int lump) {
 void P_LoadThings (int lump)
 {
 	mapthing2_t mt2;		// [RH] for translation
-	byte *data = (byte *)W_CacheLumpNum (lump, PU_STATIC);
-	mapthing_t *mt = (mapthing_t *)data;
-	mapthing_t *lastmt = (mapthing_t *)(data + W_LumpLength (lump));
+	const byte *data = (const byte *)W_MapLumpNum (lump, W_AlignOf<mapthing_t>::value);
+	const mapthing_t *mt = (const mapthing_t *)data;
+	const mapthing_t *lastmt = (const mapthing_t *)(data + W_LumpLength (lump));
 
 	P_HordeClearSpawns();
 	playerstarts.clear();
@@ -814,7 +821,7 @@ void P_LoadThings (int lump)
 
 	P_SpawnAvatars();
 
-	Z_Free (data);
+	W_UnmapLumpNum (lump, data);
 }
 
 // [RH]
@@ -1030,14 +1037,14 @@ void P_FinishLoadingLineDefs (void)
 
 void P_LoadLineDefs (const int lump)
 {
-	byte *data;
+	const byte *data;
 	int i;
 	line_t *ld;
 
 	numlines = W_LumpLength (lump) / sizeof(maplinedef_t);
 	lines = (line_t *)Z_Malloc (numlines*sizeof(line_t), PU_LEVEL, 0);
 	memset (lines, 0, numlines*sizeof(line_t));
-	data = (byte *)W_CacheLumpNum (lump, PU_STATIC);
+	data = (const byte *)W_MapLumpNum (lump, W_AlignOf<maplinedef_t>::value);
 
 	// [Blair] Don't mind me, just hackin'
 	// E2M7 has flags masked in that interfere with MBF21 flags.
@@ -1048,23 +1055,23 @@ void P_LoadLineDefs (const int lump)
 	std::string levelHash;
 
 	// [Blair] Serialize the hashes before reading.
-	uint64_t reconsthash1 = (uint64_t)(::level.level_fingerprint[0]) |
-	                        (uint64_t)(::level.level_fingerprint[1]) << 8 |
-	                        (uint64_t)(::level.level_fingerprint[2]) << 16 |
-	                        (uint64_t)(::level.level_fingerprint[3]) << 24 |
-	                        (uint64_t)(::level.level_fingerprint[4]) << 32 |
-	                        (uint64_t)(::level.level_fingerprint[5]) << 40 |
-	                        (uint64_t)(::level.level_fingerprint[6]) << 48 |
-	                        (uint64_t)(::level.level_fingerprint[7]) << 56;
-
-	uint64_t reconsthash2 = (uint64_t)(::level.level_fingerprint[8]) |
-	                        (uint64_t)(::level.level_fingerprint[9]) << 8 |
-	                        (uint64_t)(::level.level_fingerprint[10]) << 16 |
-	                        (uint64_t)(::level.level_fingerprint[11]) << 24 |
-	                        (uint64_t)(::level.level_fingerprint[12]) << 32 |
-	                        (uint64_t)(::level.level_fingerprint[13]) << 40 |
-	                        (uint64_t)(::level.level_fingerprint[14]) << 48 |
-	                        (uint64_t)(::level.level_fingerprint[15]) << 56;
+	uint64_t reconsthash1 = (uint64_t)(legacy_fingerprint[0]) |
+	                        (uint64_t)(legacy_fingerprint[1]) << 8 |
+	                        (uint64_t)(legacy_fingerprint[2]) << 16 |
+	                        (uint64_t)(legacy_fingerprint[3]) << 24 |
+	                        (uint64_t)(legacy_fingerprint[4]) << 32 |
+	                        (uint64_t)(legacy_fingerprint[5]) << 40 |
+	                        (uint64_t)(legacy_fingerprint[6]) << 48 |
+	                        (uint64_t)(legacy_fingerprint[7]) << 56;
+
+	uint64_t reconsthash2 = (uint64_t)(legacy_fingerprint[8]) |
+	                        (uint64_t)(legacy_fingerprint[9]) << 8 |
+	                        (uint64_t)(legacy_fingerprint[10]) << 16 |
+	                        (uint64_t)(legacy_fingerprint[11]) << 24 |
+	                        (uint64_t)(legacy_fingerprint[12]) << 32 |
+	                        (uint64_t)(legacy_fingerprint[13]) << 40 |
+	                        (uint64_t)(legacy_fingerprint[14]) << 48 |
+	                        (uint64_t)(legacy_fingerprint[15]) << 56;
 
 	StrFormat(levelHash, "%16llx%16llx", reconsthash1, reconsthash2);
 
@@ -1073,7 +1080,7 @@ void P_LoadLineDefs (const int lump)
 	ld = lines;
 	for (i=0 ; i<numlines ; i++, ld++)
 	{
-		const maplinedef_t *mld = ((maplinedef_t *)data) + i;
+		const maplinedef_t *mld = ((const maplinedef_t *)data) + i;
 
 		ld->flags = (unsigned short)(short int)mld->flags;
 		ld->special = (short int)mld->special;
@@ -1111,23 +1118,23 @@ void P_LoadLineDefs (const int lump)
 		P_AdjustLine (ld);
 	}
 
-	Z_Free (data);
+	W_UnmapLumpNum (lump, data);
 }
 
 // [RH] Same as P_LoadLineDefs() except it uses Hexen-style LineDefs.
 void P_LoadLineDefs2 (int lump)
 {
-	byte*				data;
+	const byte*			data;
 	int 				i;
-	maplinedef2_t*		mld;
+	const maplinedef2_t*	mld;
 	line_t* 			ld;
 
 	numlines = W_LumpLength (lump) / sizeof(maplinedef2_t);
 	lines = (line_t *)Z_Malloc (numlines*sizeof(line_t), PU_LEVEL,0 );
 	memset (lines, 0, numlines*sizeof(line_t));
-	data = (byte *)W_CacheLumpNum (lump, PU_STATIC);
+	data = (const byte *)W_MapLumpNum (lump, W_AlignOf<maplinedef2_t>::value);
 
-	mld = (maplinedef2_t *)data;
+	mld = (const maplinedef2_t *)data;
 	ld = lines;
 	for (i = 0; i < numlines; i++, mld++, ld++)
 	{
@@ -1166,7 +1173,7 @@ void P_LoadLineDefs2 (int lump)
 		P_AdjustLine (ld);
 	}
 
-	Z_Free (data);
+	W_UnmapLumpNum (lump, data);
 }
 
 //
@@ -1585,7 +1592,8 @@ void P_CreateBlockMap()
 	}
 
 	// Create the blockmap lump
-	blockmaplump = (int *)Z_Malloc(sizeof(*blockmaplump) * (4+NBlocks+linetotal), PU_LEVEL, 0);
+	blockmaplumpsize = 4+NBlocks+linetotal;
+	blockmaplump = (int *)Z_Malloc(sizeof(*blockmaplump) * blockmaplumpsize, PU_LEVEL, 0);
 
 	// blockmap header
 	//
@@ -1646,8 +1654,9 @@ void P_LoadBlockMap (int lump)
 		P_CreateBlockMap();
 	else
 	{
-		short *wadblockmaplump = (short *)W_CacheLumpNum (lump, PU_LEVEL);
+		const short *wadblockmaplump = (const short *)W_MapLumpNum (lump, W_AlignOf<short>::value);
 		int i;
+		blockmaplumpsize = count;
 		blockmaplump = (int *)Z_Malloc(sizeof(*blockmaplump) * count, PU_LEVEL, 0);
 
 		// killough 3/1/98: Expand wad blockmap into larger internal one,
@@ -1666,18 +1675,29 @@ void P_LoadBlockMap (int lump)
 			blockmaplump[i] = t == -1 ? (DWORD)0xffffffff : (DWORD) t & 0xffff;
 		}
 
-		Z_Free (wadblockmaplump);
+		W_UnmapLumpNum (lump, wadblockmaplump);
 	}
 
+	P_InitBlockLinks();
+}
+
+//
+// P_InitBlockLinks
+//
+// Sets up the blockmap globals from the header of blockmaplump
+//
+static void P_InitBlockLinks()
+{
 	bmaporgx = blockmaplump[0]<<FRACBITS;
 	bmaporgy = blockmaplump[1]<<FRACBITS;
 	bmapwidth = blockmaplump[2];
 	bmapheight = blockmaplump[3];
 
 	// clear out mobj chains
-	count = sizeof(*blocklinks) * bmapwidth*bmapheight;
+	const int count = sizeof(*blocklinks) * bmapwidth*bmapheight;
 	blocklinks = (AActor **)Z_Malloc (count, PU_LEVEL, 0);
 	memset (blocklinks, 0, count);
+	P_InitBlockThings();
 	blockmap = blockmaplump+4;
 }
 
@@ -1687,56 +1707,85 @@ void P_LoadBlockMap (int lump)
 * Creates a unique map fingerprint used to identify a unique map.
 * Based on a few key lumps that makes a map unique.
 *
+* When p_mapcache is set, the key of the processed map cache is worked out
+* from the same data plus the lumps and options the cached geometry depends
+* on.
+*
 * @param maplumpnum - Lump offset number of the specified map
 * If it is, use it as part of the map calculation.
 */
 void P_GenerateUniqueMapFingerPrint(int maplumpnum)
 {
-	unsigned int length = 0;
+	static const int fingerprintlumps[] = {ML_THINGS,   ML_LINEDEFS, ML_SIDEDEFS,
+	                                       ML_VERTEXES, ML_SEGS,     ML_SSECTORS,
+	                                       ML_SECTORS};
+	static const int cachelumps[] = {ML_NODES, ML_BLOCKMAP};
 
 	typedef std::vector<byte> LevelLumps;
-	LevelLumps levellumps;
-
-	const byte* thingbytes = const_cast<const byte*>((const byte*)W_CacheLumpNum(maplumpnum+ML_THINGS, PU_STATIC));
-	const byte* lindefbytes = const_cast<const byte*>((const byte*)W_CacheLumpNum(maplumpnum+ML_LINEDEFS, PU_STATIC));
-	const byte* sidedefbytes = const_cast<const byte*>((const byte*)W_CacheLumpNum(maplumpnum+ML_SIDEDEFS, PU_STATIC));
-	const byte* vertexbytes = const_cast<const byte*>((const byte*)W_CacheLumpNum(maplumpnum+ML_VERTEXES, PU_STATIC));
-	const byte* segsbytes = const_cast<const byte*>((const byte*)W_CacheLumpNum(maplumpnum+ML_SEGS, PU_STATIC));
-	const byte* ssectorsbytes = const_cast<const byte*>((const byte*)W_CacheLumpNum(maplumpnum+ML_SSECTORS, PU_STATIC));
-	const byte* sectorsbytes = const_cast<const byte*>((const byte*)W_CacheLumpNum(maplumpnum+ML_SECTORS, PU_STATIC));
-
-	levellumps.insert(levellumps.end(), W_LumpLength(maplumpnum+ML_THINGS), *thingbytes);
-	levellumps.insert(levellumps.end(), W_LumpLength(maplumpnum+ML_LINEDEFS), *lindefbytes);
-	levellumps.insert(levellumps.end(), W_LumpLength(maplumpnum+ML_SIDEDEFS), *sidedefbytes);
-	levellumps.insert(levellumps.end(), W_LumpLength(maplumpnum+ML_VERTEXES), *vertexbytes);
-	levellumps.insert(levellumps.end(), W_LumpLength(maplumpnum+ML_SEGS), *segsbytes);
-	levellumps.insert(levellumps.end(), W_LumpLength(maplumpnum+ML_SSECTORS), *ssectorsbytes);
-	levellumps.insert(levellumps.end(), W_LumpLength(maplumpnum+ML_SECTORS), *sectorsbytes);
-
-	length = W_LumpLength(maplumpnum+ML_THINGS) + W_LumpLength(maplumpnum+ML_LINEDEFS) +
-	         W_LumpLength(maplumpnum+ML_SIDEDEFS) + W_LumpLength(maplumpnum+ML_VERTEXES) +
-			 W_LumpLength(maplumpnum + ML_SEGS) + W_LumpLength(maplumpnum + ML_SSECTORS) +
-			 W_LumpLength(maplumpnum + ML_SECTORS);
-
-	fhfprint_s fingerprint = W_FarmHash128(levellumps.data(), length);
+	LevelLumps levellumps, legacylumps;
+
+	for (size_t i = 0; i < ARRAY_LENGTH(fingerprintlumps); i++)
+	{
+		const int lump = maplumpnum + fingerprintlumps[i];
+		const size_t offset = levellumps.size();
+		const size_t length = W_LumpLength(lump);
+
+		if (length == 0)
+			continue;
 
+		levellumps.resize(offset + length);
+		W_ReadLump(lump, &levellumps[offset]);
+
+		// The fingerprint used to be taken over the first byte of each lump
+		// repeated for the length of the lump. P_LoadLineDefs still knows
+		// E2M7 by that hash.
+		legacylumps.insert(legacylumps.end(), length, levellumps[offset]);
+	}
+
+	fhfprint_s fingerprint = W_FarmHash128(levellumps.data(), levellumps.size());
 	ArrayCopy(::level.level_fingerprint, fingerprint.fingerprint);
+
+	fingerprint = W_FarmHash128(legacylumps.data(), legacylumps.size());
+	ArrayCopy(legacy_fingerprint, fingerprint.fingerprint);
+
+	if (!p_mapcache)
+		return;
+
+	for (size_t i = 0; i < ARRAY_LENGTH(cachelumps); i++)
+	{
+		const int lump = maplumpnum + cachelumps[i];
+		const size_t offset = levellumps.size();
+		const size_t length = W_LumpLength(lump);
+
+		if (length == 0)
+			continue;
+
+		levellumps.resize(offset + length);
+		W_ReadLump(lump, &levellumps[offset]);
+	}
+
+	// Everything else that changes how the geometry is built
+	const uint32_t options[] = {MAPCACHE_VERSION, HasBehavior ? 1u : 0u,
+	                            Args.CheckParm("-blockmap") ? 1u : 0u,
+	                            demoplayback ? 1u : 0u};
+	const byte* optionbytes = reinterpret_cast<const byte*>(options);
+	levellumps.insert(levellumps.end(), optionbytes, optionbytes + sizeof(options));
+
+	fingerprint = W_FarmHash128(levellumps.data(), levellumps.size());
+	ArrayCopy(mapcache_key, fingerprint.fingerprint);
 }
+
 //
-// P_GroupLines
-// Builds sector line lists and subsector sector numbers.
-// Finds block bounding boxes for sectors.
+// P_CountSectorLines
 //
-void P_GroupLines (void)
+// Sets the sector of each subsector and counts the lines of each sector.
+// Returns the number of line table entries the sectors need.
+//
+static int P_CountSectorLines()
 {
-	line_t**			linebuffer;
 	int 				i;
-	int 				j;
 	int 				total;
 	line_t* 			li;
-	sector_t*			sector;
-	DBoundingBox		bbox;
-	int 				block;
 
 	// look up sector number for each subsector
 	for (i = 0; i < numsubsectors; i++)
@@ -1770,6 +1819,27 @@ void P_GroupLines (void)
 		}
 	}
 
+	return total;
+}
+
+//
+// P_GroupLines
+// Builds sector line lists and subsector sector numbers.
+// Finds block bounding boxes for sectors.
+//
+void P_GroupLines (void)
+{
+	line_t**			linebuffer;
+	int 				i;
+	int 				j;
+	int 				total;
+	line_t* 			li;
+	sector_t*			sector;
+	DBoundingBox		bbox;
+	int 				block;
+
+	total = P_CountSectorLines();
+
 	// build line tables for each sector
 	linebuffer = (line_t **)Z_Malloc (total*sizeof(line_t *), PU_LEVEL, 0);
 	sector = sectors;
@@ -1897,6 +1967,472 @@ static void P_RemoveSlimeTrails()
 	Z_Free(hit);
 }
 
+//
+// Processed map cache
+//
+// Loading the nodes (ZDBSP nodes have to be inflated first), building the
+// blockmap, P_GroupLines and P_RemoveSlimeTrails are the slow part of
+// loading a big map. With p_mapcache set their results are saved to the user
+// directory under the map cache key and read back the next time the same map
+// is loaded. Pointers are saved as array indices.
+//
+
+struct mapcacheheader_t
+{
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	numorgvertexes;	// before extended nodes add their own
+	uint32_t	numvertexes;
+	uint32_t	numsegs;
+	uint32_t	numsubsectors;
+	uint32_t	numnodes;
+	uint32_t	numlines;
+	uint32_t	numsides;
+	uint32_t	numsectors;
+	uint32_t	numonesided;	// linedefs P_LoadSegsHelper took ML_TWOSIDED from
+	uint32_t	blockmapsize;
+	uint32_t	numlinebuffer;
+};
+
+struct mapcacheseg_t
+{
+	uint32_t	v1;
+	uint32_t	v2;
+	fixed_t		offset;
+	angle_t		angle;
+	uint32_t	sidedef;
+	uint32_t	linedef;
+	int32_t		frontsector;	// -1 for none
+	int32_t		backsector;
+	fixed_t		length;
+};
+
+struct mapcachesubsector_t
+{
+	uint32_t	numlines;
+	uint32_t	firstline;
+};
+
+struct mapcachesector_t
+{
+	fixed_t		soundorg[2];
+	int32_t		blockbox[4];
+};
+
+struct mapcachestats_t
+{
+	unsigned int	coldloads;
+	unsigned int	cachedloads;
+	unsigned int	rejected;
+	dtime_t			coldtime;
+	dtime_t			cachedtime;
+};
+
+static const char MAPCACHE_MAGIC[4] = {'O', 'M', 'A', 'P'};
+
+static mapcachestats_t mapcache_stats;
+
+static std::string P_MapCacheFileName()
+{
+	std::string name = "mapcache_", hex;
+
+	for (size_t i = 0; i < ARRAY_LENGTH(mapcache_key); i++)
+	{
+		StrFormat(hex, "%02x", mapcache_key[i]);
+		name += hex;
+	}
+
+	return M_GetUserFileName(name + ".bin");
+}
+
+template <typename T>
+static void P_MapCacheWrite(std::vector<byte>& buf, const T* data, size_t count)
+{
+	const byte* p = reinterpret_cast<const byte*>(data);
+	buf.insert(buf.end(), p, p + count * sizeof(T));
+}
+
+// Returns count items of T from the cache data and moves past them, or NULL
+// if the data is too short
+template <typename T>
+static const T* P_MapCacheRead(const byte*& p, const byte* end, size_t count)
+{
+	if (size_t(end - p) / sizeof(T) < count)
+		return NULL;
+
+	const T* data = reinterpret_cast<const T*>(p);
+	p += count * sizeof(T);
+	return data;
+}
+
+static int32_t P_MapCacheSector(const sector_t* sector)
+{
+	return sector ? sector - sectors : -1;
+}
+
+//
+// P_SaveMapCache
+//
+// Writes out the geometry of the level that was just loaded. twosided holds
+// the ML_TWOSIDED flag of each linedef from before the segs were loaded.
+//
+static void P_SaveMapCache(const std::string& filename, int numorgvertexes,
+                           const std::vector<bool>& twosided)
+{
+	std::vector<uint32_t> onesided;
+	for (int i = 0; i < numlines; i++)
+	{
+		if (twosided[i] && !(lines[i].flags & ML_TWOSIDED))
+			onesided.push_back(i);
+	}
+
+	std::vector<uint32_t> linebuffer;
+	std::vector<mapcachesector_t> csectors(numsectors);
+	for (int i = 0; i < numsectors; i++)
+	{
+		for (int j = 0; j < sectors[i].linecount; j++)
+			linebuffer.push_back(sectors[i].lines[j] - lines);
+
+		csectors[i].soundorg[0] = sectors[i].soundorg[0];
+		csectors[i].soundorg[1] = sectors[i].soundorg[1];
+		for (int j = 0; j < 4; j++)
+			csectors[i].blockbox[j] = sectors[i].blockbox[j];
+	}
+
+	std::vector<mapcachesubsector_t> csubsectors(numsubsectors);
+	for (int i = 0; i < numsubsectors; i++)
+	{
+		csubsectors[i].numlines = subsectors[i].numlines;
+		csubsectors[i].firstline = subsectors[i].firstline;
+	}
+
+	std::vector<mapcacheseg_t> csegs(numsegs);
+	for (int i = 0; i < numsegs; i++)
+	{
+		const seg_t* seg = &segs[i];
+		mapcacheseg_t* cseg = &csegs[i];
+
+		cseg->v1 = seg->v1 - vertexes;
+		cseg->v2 = seg->v2 - vertexes;
+		cseg->offset = seg->offset;
+		cseg->angle = seg->angle;
+		cseg->sidedef = seg->sidedef - sides;
+		cseg->linedef = seg->linedef - lines;
+		cseg->frontsector = P_MapCacheSector(seg->frontsector);
+		cseg->backsector = P_MapCacheSector(seg->backsector);
+		cseg->length = seg->length;
+	}
+
+	mapcacheheader_t header;
+	memcpy(header.magic, MAPCACHE_MAGIC, sizeof(header.magic));
+	header.version = MAPCACHE_VERSION;
+	header.numorgvertexes = numorgvertexes;
+	header.numvertexes = numvertexes;
+	header.numsegs = numsegs;
+	header.numsubsectors = numsubsectors;
+	header.numnodes = numnodes;
+	header.numlines = numlines;
+	header.numsides = numsides;
+	header.numsectors = numsectors;
+	header.numonesided = onesided.size();
+	header.blockmapsize = blockmaplumpsize;
+	header.numlinebuffer = linebuffer.size();
+
+	std::vector<byte> buf;
+	P_MapCacheWrite(buf, &header, 1);
+	P_MapCacheWrite(buf, vertexes, numvertexes);
+	P_MapCacheWrite(buf, csegs.data(), csegs.size());
+	P_MapCacheWrite(buf, csubsectors.data(), csubsectors.size());
+	P_MapCacheWrite(buf, nodes, numnodes);
+	P_MapCacheWrite(buf, onesided.data(), onesided.size());
+	P_MapCacheWrite(buf, blockmaplump, blockmaplumpsize);
+	P_MapCacheWrite(buf, linebuffer.data(), linebuffer.size());
+	P_MapCacheWrite(buf, csectors.data(), csectors.size());
+
+	M_WriteFile(filename, buf.data(), buf.size());
+}
+
+//
+// P_ReadMapCache
+//
+// Sets up the level geometry from the cache data between p and end. Nothing
+// is changed unless the whole of it checks out against the lumps that have
+// already been loaded.
+//
+static bool P_ReadMapCache(const byte* p, const byte* end)
+{
+	const mapcacheheader_t* header = P_MapCacheRead<mapcacheheader_t>(p, end, 1);
+
+	if (header == NULL || memcmp(header->magic, MAPCACHE_MAGIC, sizeof(header->magic)) ||
+	    header->version != MAPCACHE_VERSION ||
+	    header->numorgvertexes != (uint32_t)numvertexes ||
+	    header->numvertexes < header->numorgvertexes ||
+	    header->numlines != (uint32_t)numlines || header->numsides != (uint32_t)numsides ||
+	    header->numsectors != (uint32_t)numsectors || header->blockmapsize < 4)
+		return false;
+
+	const vertex_t* cvertexes = P_MapCacheRead<vertex_t>(p, end, header->numvertexes);
+	const mapcacheseg_t* csegs = P_MapCacheRead<mapcacheseg_t>(p, end, header->numsegs);
+	const mapcachesubsector_t* csubsectors =
+	    P_MapCacheRead<mapcachesubsector_t>(p, end, header->numsubsectors);
+	const node_t* cnodes = P_MapCacheRead<node_t>(p, end, header->numnodes);
+	const uint32_t* conesided = P_MapCacheRead<uint32_t>(p, end, header->numonesided);
+	const int* cblockmap = P_MapCacheRead<int>(p, end, header->blockmapsize);
+	const uint32_t* clinebuffer = P_MapCacheRead<uint32_t>(p, end, header->numlinebuffer);
+	const mapcachesector_t* csectors =
+	    P_MapCacheRead<mapcachesector_t>(p, end, header->numsectors);
+
+	if (csectors == NULL || p != end)
+		return false;
+
+	// Check every index before anything is touched
+	for (uint32_t i = 0; i < header->numsegs; i++)
+	{
+		const mapcacheseg_t* cseg = &csegs[i];
+
+		if (cseg->v1 >= header->numvertexes || cseg->v2 >= header->numvertexes ||
+		    cseg->sidedef >= header->numsides || cseg->linedef >= header->numlines ||
+		    cseg->frontsector < -1 || cseg->frontsector >= numsectors ||
+		    cseg->backsector < -1 || cseg->backsector >= numsectors)
+			return false;
+	}
+
+	for (uint32_t i = 0; i < header->numsubsectors; i++)
+	{
+		if (csubsectors[i].firstline >= header->numsegs)
+			return false;
+	}
+
+	for (uint32_t i = 0; i < header->numonesided; i++)
+	{
+		if (conesided[i] >= header->numlines)
+			return false;
+	}
+
+	for (uint32_t i = 0; i < header->numlinebuffer; i++)
+	{
+		if (clinebuffer[i] >= header->numlines)
+			return false;
+	}
+
+	if (cblockmap[2] < 0 || cblockmap[3] < 0 ||
+	    4 + (int64_t)cblockmap[2] * cblockmap[3] > header->blockmapsize)
+		return false;
+
+	// The sector line lists must add up to what P_CountSectorLines will count
+	uint32_t total = 0;
+	for (int i = 0; i < numlines; i++)
+	{
+		const sector_t* front = lines[i].frontsector ? lines[i].frontsector : lines[i].backsector;
+		const sector_t* back = lines[i].frontsector ? lines[i].backsector : NULL;
+
+		total += (front != NULL) + (back != NULL && back != front);
+	}
+
+	if (total != header->numlinebuffer)
+		return false;
+
+	// Extended nodes add vertexes of their own, see P_LoadXNOD
+	if (header->numvertexes != header->numorgvertexes)
+	{
+		vertex_t* newvert =
+		    (vertex_t*)Z_Malloc(header->numvertexes * sizeof(*newvert), PU_LEVEL, 0);
+
+		for (int i = 0; i < numlines; i++)
+		{
+			lines[i].v1 = newvert + (lines[i].v1 - vertexes);
+			lines[i].v2 = newvert + (lines[i].v2 - vertexes);
+		}
+
+		Z_Free(vertexes);
+		vertexes = newvert;
+		numvertexes = header->numvertexes;
+	}
+
+	// Slime trail removal has already been applied to these
+	memcpy(vertexes, cvertexes, numvertexes * sizeof(*vertexes));
+
+	blockmaplumpsize = header->blockmapsize;
+	blockmaplump = (int*)Z_Malloc(blockmaplumpsize * sizeof(*blockmaplump), PU_LEVEL, 0);
+	memcpy(blockmaplump, cblockmap, blockmaplumpsize * sizeof(*blockmaplump));
+	P_InitBlockLinks();
+
+	numsubsectors = header->numsubsectors;
+	subsectors = (subsector_t*)Z_Malloc(numsubsectors * sizeof(*subsectors), PU_LEVEL, 0);
+	memset(subsectors, 0, numsubsectors * sizeof(*subsectors));
+	for (int i = 0; i < numsubsectors; i++)
+	{
+		subsectors[i].numlines = csubsectors[i].numlines;
+		subsectors[i].firstline = csubsectors[i].firstline;
+	}
+
+	numnodes = header->numnodes;
+	nodes = (node_t*)Z_Malloc(numnodes * sizeof(*nodes), PU_LEVEL, 0);
+	memcpy(nodes, cnodes, numnodes * sizeof(*nodes));
+
+	numsegs = header->numsegs;
+	segs = (seg_t*)Z_Malloc(numsegs * sizeof(*segs), PU_LEVEL, 0);
+	for (int i = 0; i < numsegs; i++)
+	{
+		const mapcacheseg_t* cseg = &csegs[i];
+		seg_t* seg = &segs[i];
+
+		seg->v1 = &vertexes[cseg->v1];
+		seg->v2 = &vertexes[cseg->v2];
+		seg->offset = cseg->offset;
+		seg->angle = cseg->angle;
+		seg->sidedef = &sides[cseg->sidedef];
+		seg->linedef = &lines[cseg->linedef];
+		seg->frontsector = cseg->frontsector < 0 ? NULL : &sectors[cseg->frontsector];
+		seg->backsector = cseg->backsector < 0 ? NULL : &sectors[cseg->backsector];
+		seg->length = cseg->length;
+	}
+
+	for (uint32_t i = 0; i < header->numonesided; i++)
+		lines[conesided[i]].flags &= ~ML_TWOSIDED;
+
+	P_CountSectorLines();
+
+	line_t** linebuffer =
+	    (line_t**)Z_Malloc(header->numlinebuffer * sizeof(*linebuffer), PU_LEVEL, 0);
+	for (uint32_t i = 0; i < header->numlinebuffer; i++)
+		linebuffer[i] = &lines[clinebuffer[i]];
+
+	for (int i = 0; i < numsectors; i++)
+	{
+		sector_t* sector = &sectors[i];
+
+		sector->lines = linebuffer;
+		linebuffer += sector->linecount;
+
+		sector->soundorg[0] = csectors[i].soundorg[0];
+		sector->soundorg[1] = csectors[i].soundorg[1];
+		for (int j = 0; j < 4; j++)
+			sector->blockbox[j] = csectors[i].blockbox[j];
+	}
+
+	return true;
+}
+
+//
+// P_LoadMapCache
+//
+static bool P_LoadMapCache(const std::string& filename)
+{
+	if (!M_FileExists(filename))
+		return false;
+
+	byte* data = NULL;
+	const QWORD length = M_ReadFile(filename, &data);
+
+	const bool ok = length > 0 && P_ReadMapCache(data, data + length);
+
+	if (data != NULL)
+		Z_Free(data);
+
+	if (!ok)
+	{
+		DPrintf("P_LoadMapCache: %s does not match this map, rebuilding it.\n",
+		        filename.c_str());
+		mapcache_stats.rejected++;
+	}
+
+	return ok;
+}
+
+//
+// P_LoadLevelGeometry
+//
+// Loads the blockmap and nodes and builds the sector line lists, either from
+// the map lumps or from the processed map cache.
+//
+static void P_LoadLevelGeometry(int lumpnum)
+{
+	const dtime_t start = I_GetTime();
+	std::string cachefile;
+
+	if (p_mapcache)
+	{
+		cachefile = P_MapCacheFileName();
+
+		if (P_LoadMapCache(cachefile))
+		{
+			const dtime_t elapsed = I_GetTime() - start;
+			mapcache_stats.cachedloads++;
+			mapcache_stats.cachedtime += elapsed;
+			DPrintf("P_LoadLevelGeometry: loaded from the map cache in %.2f ms.\n",
+			        double(elapsed) / 1000000.0);
+			return;
+		}
+	}
+
+	const int numorgvertexes = numvertexes;
+	std::vector<bool> twosided;
+
+	if (p_mapcache)
+	{
+		twosided.resize(numlines);
+		for (int i = 0; i < numlines; i++)
+			twosided[i] = (lines[i].flags & ML_TWOSIDED) != 0;
+	}
+
+	P_LoadBlockMap (lumpnum+ML_BLOCKMAP);
+
+	switch (P_CheckNodeType(lumpnum+ML_NODES)) {
+		case NT_XNOD:
+		case NT_ZNOD:
+			P_LoadXNOD(lumpnum+ML_NODES);
+			break;
+
+		case NT_DEEP:
+			P_LoadSubsectors(lumpnum+ML_SSECTORS, true);
+			P_LoadNodes_DeePBSP(lumpnum+ML_NODES);
+			P_LoadSegs(lumpnum+ML_SEGS, true);
+			break;
+
+		default:
+			P_LoadSubsectors(lumpnum+ML_SSECTORS);
+			P_LoadNodes(lumpnum+ML_NODES);
+			P_LoadSegs(lumpnum+ML_SEGS);
+	}
+
+	P_GroupLines ();
+
+	// [SL] don't move seg vertices if compatibility is cruical
+	if (!demoplayback)
+		P_RemoveSlimeTrails();
+
+	const dtime_t elapsed = I_GetTime() - start;
+	mapcache_stats.coldloads++;
+	mapcache_stats.coldtime += elapsed;
+	DPrintf("P_LoadLevelGeometry: built in %.2f ms.\n", double(elapsed) / 1000000.0);
+
+	if (p_mapcache)
+		P_SaveMapCache(cachefile, numorgvertexes, twosided);
+}
+
+BEGIN_COMMAND(mapcachestats)
+{
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+	{
+		memset(&mapcache_stats, 0, sizeof(mapcache_stats));
+		Printf(PRINT_HIGH, "Map cache stats reset.\n");
+		return;
+	}
+
+	const mapcachestats_t& stats = mapcache_stats;
+
+	Printf(PRINT_HIGH, "Map geometry built from lumps: %u, %.2f ms average\n",
+	       stats.coldloads,
+	       stats.coldloads ? double(stats.coldtime) / (1000000.0 * stats.coldloads) : 0.0);
+	Printf(PRINT_HIGH, "Map geometry read from cache:  %u, %.2f ms average\n",
+	       stats.cachedloads,
+	       stats.cachedloads ? double(stats.cachedtime) / (1000000.0 * stats.cachedloads)
+	                         : 0.0);
+	Printf(PRINT_HIGH, "Cache files rejected: %u\n", stats.rejected);
+}
+END_COMMAND(mapcachestats)
+
 //
 // [RH] P_LoadBehavior
 //
@@ -1983,6 +2519,7 @@ void P_SetupLevel (const char *lumpname, int position)
 	shootthing = NULL;
 
 	DThinker::DestroyAllThinkers ();
+	AActor::ClearTypeLists ();
 	Z_FreeTags (PU_LEVEL, PU_LEVELMAX);
 	g_ValidLevel = false;		// [AM] False until the level is loaded.
 	NormalLight.next = NULL;	// [RH] Z_FreeTags frees all the custom colormaps
@@ -2034,25 +2571,6 @@ void P_SetupLevel (const char *lumpname, int position)
 		P_LoadLineDefs2 (lumpnum+ML_LINEDEFS);	// [RH] Load Hexen-style linedefs
 	P_LoadSideDefs2 (lumpnum+ML_SIDEDEFS);
 	P_FinishLoadingLineDefs ();
-	P_LoadBlockMap (lumpnum+ML_BLOCKMAP);
-
-	switch (P_CheckNodeType(lumpnum+ML_NODES)) {
-		case NT_XNOD:
-		case NT_ZNOD:
-			P_LoadXNOD(lumpnum+ML_NODES);
-			break;
-
-		case NT_DEEP:
-			P_LoadSubsectors(lumpnum+ML_SSECTORS, true);
-			P_LoadNodes_DeePBSP(lumpnum+ML_NODES);
-			P_LoadSegs(lumpnum+ML_SEGS, true);
-			break;
-
-		default:
-			P_LoadSubsectors(lumpnum+ML_SSECTORS);
-			P_LoadNodes(lumpnum+ML_NODES);
-			P_LoadSegs(lumpnum+ML_SEGS);
-	}
 
 	rejectmatrix = (byte *)W_CacheLumpNum (lumpnum+ML_REJECT, PU_LEVEL);
 	{
@@ -2065,11 +2583,8 @@ void P_SetupLevel (const char *lumpname, int position)
 			rejectempty = true;
 		}
 	}
-	P_GroupLines ();
 
-	// [SL] don't move seg vertices if compatibility is cruical
-	if (!demoplayback)
-		P_RemoveSlimeTrails();
+	P_LoadLevelGeometry(lumpnum);
 
 	P_SetupSlopes();
 
@@ -2108,6 +2623,9 @@ void P_SetupLevel (const char *lumpname, int position)
 	// killough 3/26/98: Spawn icon landings:
 	P_SpawnBrainTargets();
 
+	// build the sound propagation graph for P_NoiseAlert
+	P_InitSoundGraph();
+
 	// set up world state
 	P_SetupWorldState();
 
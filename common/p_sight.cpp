@@ -214,10 +214,8 @@ bool P_SightBlockLinesIterator (int x, int y)
 
 bool P_SightTraverseIntercepts ( void )
 {
-	size_t  count = intercepts.Size();
-	fixed_t dist;
 	size_t	scan;
-	intercept_t *in = 0;
+	intercept_t *in;
 	divline_t dl;
 //
 // calculate intercept distance
@@ -234,16 +232,10 @@ bool P_SightTraverseIntercepts ( void )
 //
 // go through in order
 //
-	while (count--)
-	{
-		dist = MAXINT;
-		for (scan = 0 ; scan < intercepts.Size(); scan++)
-			if (intercepts[scan].frac < dist)
-			{
-				dist = intercepts[scan].frac;
-				in = &intercepts[scan];
-			}
+	P_StartInterceptOrder ();
 
+	while ((in = P_NextIntercept ()))
+	{
 		if ( !PTR_SightTraverse (in) )
 			return false;					// don't bother going farther
 			
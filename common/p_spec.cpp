@@ -2586,6 +2586,29 @@ void DScroller::RunThink ()
 	}
 }
 
+//
+// DScroller::ParallelKey
+//
+// Texture scrollers only touch the offsets of their affectee, unless they
+// carry things or follow a control sector that movers change during the tic.
+//
+int DScroller::ParallelKey () const
+{
+	if (m_Control != -1)
+		return -1;
+
+	switch (m_Type)
+	{
+		case sc_side:
+			return numsectors + m_Affectee;
+		case sc_floor:
+		case sc_ceiling:
+			return m_Affectee;
+		default:
+			return -1;
+	}
+}
+
 //
 // Add_Scroller()
 //
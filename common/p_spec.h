@@ -221,6 +221,7 @@ public:
 	DScroller (fixed_t dx, fixed_t dy, const line_t *l, int control, int accel);
 
 	void RunThink ();
+	int ParallelKey () const;
 
 	bool AffectsWall (int wallnum) { return m_Type == sc_side && m_Affectee == wallnum; }
 	int GetWallNum () { return m_Type == sc_side ? m_Affectee : -1; }
@@ -519,6 +520,7 @@ class DGlow : public DLighting
 public:
 	DGlow (sector_t *sector);
 	void		RunThink ();
+	int			ParallelKey () const;
 protected:
 	int 		m_MinLight;
 	int 		m_MaxLight;
@@ -556,6 +558,7 @@ public:
 	DPhased (sector_t *sector);
 	DPhased (sector_t *sector, int baselevel, int phase);
 	void		RunThink ();
+	int			ParallelKey () const;
 	byte GetBaseLevel() const { return m_BaseLevel; }
 	byte GetPhase() const { return m_Phase; }
 protected:
@@ -1309,6 +1312,8 @@ void P_SuspendScript (int script, const char *map);
 void P_TerminateScript (int script, const char *map);
 void P_StartOpenScripts (void);
 void P_DoDeferedScripts (void);
+void P_WakeTagWaiters (int tag);
+void P_WakePolyWaiters (int polynum);
 
 
 //
@@ -270,7 +270,7 @@ BOOL P_Thing_Projectile (int tid, int type, angle_t angle,
 		if (mobj)
 		{
 			if (mobj->info->seesound)
-				S_Sound (mobj, CHAN_VOICE, mobj->info->seesound, 1, ATTN_NORM);
+				S_MobjSound(mobj, CHAN_VOICE, mobj->info->seesound, mobjsounds[mobj->type].see, 1, ATTN_NORM);
 			if (gravity)
 			{
 				mobj->flags &= ~MF_NOGRAVITY;
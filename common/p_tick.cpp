@@ -82,7 +82,8 @@ void P_Ticker (void)
 	}
 
 	DThinker::RunThinkers ();
-	
+	P_RunSplashes ();
+
 	P_UpdateSpecials ();
 	P_RespawnSpecials ();
 
@@ -69,19 +69,37 @@ static player_t nullplayer;		// used to indicate 'player not found' when searchi
 EXTERN_CVAR (sv_allowmovebob)
 EXTERN_CVAR (cl_movebob)
 
-player_t &idplayer(byte id)
+//
+// Players::lookup
+//
+// Returns the player with the given id, or NULL if there is none.  Hits in
+// the index are O(1); misses search the list and refill the index.
+//
+player_t* Players::lookup(byte id)
 {
-	// Put a cached lookup mechanism in here.
+	player_t* player = m_index[id];
+	if (player != NULL && player->id == id)
+		return player;
 
 	// full search
-	for (Players::iterator it = players.begin();it != players.end();++it)
+	for (iterator it = begin(); it != end(); ++it)
 	{
 		// Add to the cache while we search
 		if (it->id == id)
-			return *it;
+		{
+			m_index[id] = &*it;
+			return &*it;
+		}
 	}
 
-	return nullplayer;
+	m_index[id] = NULL;
+	return NULL;
+}
+
+player_t &idplayer(byte id)
+{
+	player_t* player = players.lookup(id);
+	return player ? *player : nullplayer;
 }
 
 /**
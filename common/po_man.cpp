@@ -106,6 +106,14 @@ DPolyAction::DPolyAction (int polyNum)
 	m_Dist = 0;
 }
 
+void DPolyAction::Destroy ()
+{
+	// Scripts waiting for this polyobject can check again
+	P_WakePolyWaiters (m_PolyObj);
+
+	Super::Destroy ();
+}
+
 DRotatePoly::DRotatePoly ()
 {
 }
@@ -913,6 +921,10 @@ static void UnLinkPolyobj (polyobj_t *po)
 	int i, j;
 	int index;
 
+	// the polyobj's lines are about to move, so cached sector lists
+	// of things near it can no longer be trusted
+	P_InvalidateSecNodes();
+
 	// remove the polyobj from each blockmap section
 	for(j = po->bbox[BOXBOTTOM]; j <= po->bbox[BOXTOP]; j++)
 	{
@@ -948,6 +960,8 @@ static void LinkPolyobj (polyobj_t *po)
 	polyblock_t *tempLink;
 	int i, j;
 
+	P_InvalidateSecNodes();
+
 	// calculate the polyobj bbox
 	tempSeg = po->segs;
 	rightX = leftX = (*tempSeg)->v1->x;
@@ -48,6 +48,7 @@
 #include <cmath>
 
 #include <algorithm>
+#include <vector>
 
 //
 // Graphics.
@@ -76,6 +77,9 @@ static int*		texturecompositesize;
 static short** 	texturecolumnlump;
 static unsigned **texturecolumnofs;
 static byte**	texturecomposite;
+static byte*	levelarena;					// see R_BakeLevelGraphics
+static std::vector<int> texturearenaofs;	// per texture, -1 if not baked
+static std::vector<int> patcharenaofs;		// per lump, -1 if not baked
 fixed_t*		texturescalex;
 fixed_t*		texturescaley;
 
@@ -261,11 +265,8 @@ void R_DrawColumnInCache(const tallpost_t *post, byte *cache,
 //
 // Rewritten by Lee Killough for performance and to fix Medusa bug
 
-void R_GenerateComposite (int texnum)
+static void R_CompositeTexture(int texnum, byte *block)
 {
-	byte *block = (byte *)Z_Malloc (texturecompositesize[texnum], PU_STATIC,
-						   (void **) &texturecomposite[texnum]);
-	texturecomposite[texnum] = block;
 	texture_t *texture = textures[texnum];
 
 	// Composite the columns together.
@@ -341,6 +342,15 @@ void R_GenerateComposite (int texnum)
 
 	delete [] marks;
 	delete [] tmpdata;
+}
+
+void R_GenerateComposite (int texnum)
+{
+	byte *block = (byte *)Z_Malloc (texturecompositesize[texnum], PU_STATIC,
+						   (void **) &texturecomposite[texnum]);
+	texturecomposite[texnum] = block;
+
+	R_CompositeTexture(texnum, block);
 
 	// Now that the texture has been built in column cache,
 	// it is purgable from zone memory.
@@ -453,12 +463,116 @@ void R_GenerateLookup(int texnum, int *const errors)
 	delete [] postcount;
 }
 
+//
+// LEVEL GRAPHICS ARENA
+//
+// R_PrecacheLevel bakes the composite of every wall texture on the map, along
+// with the converted patches used by single-patch textures and by sprites,
+// into one contiguous PU_LEVEL block. Column lookups for baked graphics index
+// straight into the arena, so no composite is generated and no patch is
+// converted the first time something comes into view. Anything that was not
+// baked falls back to the regular zone cache.
+//
+//
+// R_ConvertedPatchSize
+//
+// Returns the number of bytes used by a patch already converted to tallpost_t
+// columns. R_ConvertPatch lays the columns out back to back, so this is the
+// end of the furthest column terminator.
+//
+static size_t R_ConvertedPatchSize(const patch_t* patch)
+{
+	size_t size = patch->datastart();
+
+	for (int i = 0; i < patch->width(); i++)
+	{
+		const tallpost_t* post =
+			(tallpost_t*)((byte*)patch + LELONG(patch->columnofs[i]));
+		while (!post->end())
+			post = post->next();
+
+		size = std::max(size, (size_t)((byte*)post - (byte*)patch) + 2);
+	}
+
+	return size;
+}
+
+//
+// R_BakeLevelGraphics
+//
+// Composites texlist and copies the converted patches in patchlist into a
+// freshly allocated level arena.
+//
+static void R_BakeLevelGraphics(const std::vector<int>& texlist,
+                                const std::vector<int>& patchlist)
+{
+	if (levelarena)
+		Z_Free(levelarena);
+
+	texturearenaofs.assign(numtextures, -1);
+	patcharenaofs.assign(numlumps, -1);
+
+	// Lay out the arena. Patches are held PU_STATIC until they are copied.
+	std::vector<size_t> patchsizes(patchlist.size());
+	size_t arenasize = 0;
+
+	for (size_t i = 0; i < patchlist.size(); i++)
+	{
+		const patch_t* patch = W_CachePatch(patchlist[i], PU_STATIC);
+		patchsizes[i] = R_ConvertedPatchSize(patch);
+
+		patcharenaofs[patchlist[i]] = (int)arenasize;
+		arenasize += (std::max(patchsizes[i], sizeof(patch_t)) + 3) & ~3;
+	}
+
+	for (size_t i = 0; i < texlist.size(); i++)
+	{
+		texturearenaofs[texlist[i]] = (int)arenasize;
+		arenasize += (texturecompositesize[texlist[i]] + 3) & ~3;
+	}
+
+	if (arenasize == 0)
+		return;
+
+	levelarena = (byte*)Z_Malloc(arenasize, PU_LEVEL, &levelarena);
+
+	for (size_t i = 0; i < patchlist.size(); i++)
+	{
+		const int lump = patchlist[i];
+		byte* dest = levelarena + patcharenaofs[lump];
+
+		memset(dest, 0, sizeof(patch_t));
+		memcpy(dest, W_CachePatch(lump, PU_CACHE), patchsizes[i]);
+	}
+
+	for (size_t i = 0; i < texlist.size(); i++)
+		R_CompositeTexture(texlist[i], levelarena + texturearenaofs[texlist[i]]);
+
+	DPrintf("R_BakeLevelGraphics: %u textures, %u patches, %u bytes\n",
+	        (unsigned)texlist.size(), (unsigned)patchlist.size(), (unsigned)arenasize);
+}
+
+//
+// R_GetLevelPatch
+//
+// Returns the baked copy of a converted patch if there is one, otherwise
+// caches it the regular way.
+//
+patch_t* R_GetLevelPatch(int lumpnum)
+{
+	if (levelarena && (size_t)lumpnum < patcharenaofs.size() &&
+	    patcharenaofs[lumpnum] != -1)
+		return (patch_t*)(levelarena + patcharenaofs[lumpnum]);
+
+	return W_CachePatch(lumpnum, PU_CACHE);
+}
+
 //
 // R_GetPatchColumn
 //
 tallpost_t* R_GetPatchColumn(int lumpnum, int colnum)
 {
-	patch_t* patch = W_CachePatch(lumpnum, PU_CACHE);
+	patch_t* patch = R_GetLevelPatch(lumpnum);
 	return (tallpost_t*)((byte*)patch + LELONG(patch->columnofs[colnum]));
 }
 
@@ -485,7 +599,10 @@ tallpost_t* R_GetTextureColumn(int texnum, int colnum)
 	int ofs = texturecolumnofs[texnum][colnum];
 
 	if (lump > 0)
-		return (tallpost_t*)((byte *)W_CachePatch(lump, PU_CACHE) + ofs);
+		return (tallpost_t*)((byte *)R_GetLevelPatch(lump) + ofs);
+
+	if (levelarena && texturearenaofs[texnum] != -1)
+		return (tallpost_t*)(levelarena + texturearenaofs[texnum] + ofs);
 
 	if (!texturecomposite[texnum])
 		R_GenerateComposite(texnum);
@@ -590,6 +707,10 @@ void R_InitTextures (void)
 		delete[] texturecolumnofs[i];
 	}
 
+	// the level arena is indexed by texture number
+	if (levelarena)
+		Z_Free(levelarena);
+
 	// denis - fix memory leaks
 	delete[] textures;
 	delete[] texturecolumnlump;
@@ -1129,15 +1250,18 @@ void R_PrecacheLevel (void)
 	hitlist[sky1texture] = 1;
 	hitlist[sky2texture] = 1;
 
+	// Composite textures are baked into the level arena, as are the patches
+	// that single-patch textures draw their columns from.
+	std::vector<int> baketextures, bakepatches;
+
 	for (i = numtextures - 1; i >= 0; i--)
 	{
 		if (hitlist[i])
 		{
-			int j;
-			texture_t *texture = textures[i];
-
-			for (j = texture->patchcount - 1; j > 0; j--)
-				W_CachePatch(texture->patches[j].patch, PU_CACHE);
+			if (texturecompositesize[i] > 0)
+				baketextures.push_back(i);
+			else if (textures[i]->patchcount > 0)
+				bakepatches.push_back(textures[i]->patches[0].patch);
 		}
 	}
 
@@ -1155,10 +1279,27 @@ void R_PrecacheLevel (void)
 	for (i = numsprites - 1; i >= 0; i--)
 	{
 		if (hitlist[i])
+		{
 			R_CacheSprite (sprites + i);
+
+			for (int f = 0; f < sprites[i].numframes; f++)
+			{
+				for (int r = 0; r < 16; r++)
+				{
+					if (sprites[i].spriteframes[f].lump[r] != -1)
+						bakepatches.push_back(sprites[i].spriteframes[f].lump[r]);
+				}
+			}
+		}
 	}
 
 	delete[] hitlist;
+
+	std::sort(bakepatches.begin(), bakepatches.end());
+	bakepatches.erase(std::unique(bakepatches.begin(), bakepatches.end()),
+	                  bakepatches.end());
+
+	R_BakeLevelGraphics(baketextures, bakepatches);
 }
 
 // Utility function,
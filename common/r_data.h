@@ -84,6 +84,7 @@ extern fixed_t* texturescalex;
 extern fixed_t* texturescaley;
 
 // Retrieve column data for span blitting.
+patch_t* R_GetLevelPatch(int lumpnum);
 tallpost_t* R_GetPatchColumn(int lumpnum, int colnum);
 byte* R_GetPatchColumnData(int lumpnum, int colnum);
 tallpost_t* R_GetTextureColumn(int texnum, int colnum);
@@ -94,6 +94,33 @@ void S_SoundID(fixed_t* pt, int channel, int sfxid, float volume, int attenuatio
 void S_LoopedSoundID(AActor* ent, int channel, int sfxid, float volume, int attenuation);
 void S_LoopedSoundID(fixed_t* pt, int channel, int sfxid, float volume, int attenuation);
 
+// Same as S_Sound, for a sound id already resolved with S_FindSound (such
+// as the interned mobjinfo sounds). Unlike S_SoundID, these apply the same
+// filtering as the named versions. Ids of -1 are ignored.
+void S_SoundHandle(int channel, int sfxid, float volume, int attenuation);
+void S_SoundHandle(AActor* ent, int channel, int sfxid, float volume, int attenuation);
+
+// Plays one of an actor's mobjinfo sounds by its interned id. Player sounds
+// such as "*pain100_1" depend on who is playing them and are never interned,
+// so those still go through S_Sound by name.
+inline void S_MobjSound(int channel, const char* name, int sfxid, float volume,
+                        int attenuation)
+{
+	if (name != NULL && name[0] == '*')
+		S_Sound(channel, name, volume, attenuation);
+	else
+		S_SoundHandle(channel, sfxid, volume, attenuation);
+}
+
+inline void S_MobjSound(AActor* ent, int channel, const char* name, int sfxid,
+                        float volume, int attenuation)
+{
+	if (name != NULL && name[0] == '*')
+		S_Sound(ent, channel, name, volume, attenuation);
+	else
+		S_SoundHandle(ent, channel, sfxid, volume, attenuation);
+}
+
 // sound channels
 // channel 0 never willingly overrides
 // other channels (1-8) always override a playing sound on that channel
@@ -168,6 +195,7 @@ int S_AddSound(const char* logicalname, const char* lumpname); // Add sound by l
 int S_AddSoundLump(char* logicalname, int lump);         // Add sound by lump index
 void S_AddRandomSound(int owner, std::vector<int>& list);
 void S_ClearSoundLumps();
+void S_InternMobjSounds();
 
 void UV_SoundAvoidPlayer(AActor* mo, byte channel, const char* name, byte attenuation);
 
@@ -190,6 +218,15 @@ inline static void S_NetSound(AActor* mo, byte channel, const char* name, const
 #endif
 }
 
+inline static void S_NetSoundID(AActor* mo, byte channel, int sfxid, const byte attenuation)
+{
+#if SERVER_APP
+	SV_SoundID(mo, channel, sfxid, attenuation);
+#else
+	S_SoundHandle(mo, channel, sfxid, 1, attenuation);
+#endif
+}
+
 inline static void S_PlayerSound(player_t* pl, AActor* mo, const byte channel, const char* name,
                           const byte attenuation)
 {
@@ -38,6 +38,16 @@
 #endif
 
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#if defined(_WIN32) && !defined(_XBOX)
+#include "win32inc.h"
+#elif defined(UNIX) && !defined(GEKKO) && !defined(__SWITCH__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define W_POSIX_MMAP
+#endif
 
 #include "crc32.h"
 
@@ -47,6 +57,7 @@
 #include "cmdlib.h"
 #include "m_argv.h"
 #include "md5.h"
+#include "c_dispatch.h"
 
 #include "farmhash.h"
 
@@ -78,52 +89,133 @@ void**			lumpcache;
 
 static unsigned	stdisk_lumpnum;
 
+// An open wad file, and where it is mapped into memory if it could be
+struct wadfile_t
+{
+	FILE*		handle;
+	const byte*	base;
+	size_t		size;
+#if defined(_WIN32) && !defined(_XBOX)
+	HANDLE		mapping;
+#endif
+};
+
+static std::vector<wadfile_t> wadfilemaps;
+
+struct wadstats_t
+{
+	size_t	mappedfiles;
+	size_t	mappedbytes;
+	size_t	views;			// lumps read in place by W_MapLumpNum
+	size_t	mappedcopies;	// lumps copied out of a mapping
+	size_t	filereads;		// lumps read with stdio
+	size_t	copiedbytes;
+};
+
+static wadstats_t wadstats;
+
 //
-// W_LumpNameHash
+// W_LumpNameKey
 //
-// Hash function used for lump names. Must be mod'ed with table size.
-// Can be used for any 8-character names.
-// by Lee Killough
+// Packs an up to 8-character name into an uppercase 64-bit key, first
+// character in the low byte. Two names compare equal under strnicmp(a, b, 8)
+// exactly when their keys are equal.
 //
-// [SL] taken from prboom-plus
+uint64_t W_LumpNameKey(const char* name)
+{
+	uint64_t key = 0;
+
+	for (int i = 0; i < 8 && name[i]; i++)
+		key |= (uint64_t)toupper((unsigned char)name[i]) << (i * 8);
+
+	return key;
+}
+
+//
+// Lump name index
+//
+// An open-addressed table with one slot for every (name, namespace) pair,
+// pointing at the last lump with that name so pwad ordering rules hold.
+// Slots keep their own copy of the key, so probing never touches lumpinfo.
+// The table is at most half full.
 //
-unsigned int W_LumpNameHash(const char *s)
+struct lumpslot_t
 {
-	unsigned int hash;
+	uint64_t	key;
+	int			namespc;
+	int			lump;		// -1 for an empty slot
+};
 
-	(void)((hash =         toupper(s[0]), s[1]) &&
-			(hash = hash*3+toupper(s[1]), s[2]) &&
-			(hash = hash*2+toupper(s[2]), s[3]) &&
-			(hash = hash*2+toupper(s[3]), s[4]) &&
-			(hash = hash*2+toupper(s[4]), s[5]) &&
-			(hash = hash*2+toupper(s[5]), s[6]) &&
-			(hash = hash*2+toupper(s[6]),
-			 hash = hash*2+toupper(s[7]))
-         );
-	return hash;
+static std::vector<lumpslot_t> lumpindex;
+static unsigned int lumpindexbits = 0;
+
+// Bumped every time the index is rebuilt, so lookups cached in an OLumpName
+// know to resolve again
+static unsigned int lumpindexgen = 0;
+
+static inline size_t W_LumpSlot(uint64_t key, int namespc)
+{
+	return (size_t)(((key + namespc) * 0x9E3779B97F4A7C15ULL) >> (64 - lumpindexbits));
+}
+
+static int W_LookupLump(uint64_t key, int namespc)
+{
+	if (lumpindex.empty())
+		return -1;
+
+	const size_t mask = lumpindex.size() - 1;
+
+	for (size_t i = W_LumpSlot(key, namespc);; i = (i + 1) & mask)
+	{
+		const lumpslot_t& slot = lumpindex[i];
+		if (slot.lump < 0 || (slot.key == key && slot.namespc == namespc))
+			return slot.lump;
+	}
 }
 
 //
 // W_HashLumps
 //
-// killough 1/31/98: Initialize lump hash table
-// [SL] taken from prboom-plus
+// Computes the name key of every lump and rebuilds the lump name index.
+// Must be called whenever lumps are added, renamed or moved to another
+// namespace.
 //
 void W_HashLumps(void)
 {
-	for (unsigned int i = 0; i < numlumps; i++)
-		lumpinfo[i].index = -1;			// mark slots empty
+	for (size_t i = 0; i < numlumps; i++)
+		lumpinfo[i].namekey = W_LumpNameKey(lumpinfo[i].name);
+
+	lumpindexbits = 1;
+	while (((size_t)1 << lumpindexbits) < numlumps * 2)
+		lumpindexbits++;
 
-	// Insert nodes to the beginning of each chain, in first-to-last
-	// lump order, so that the last lump of a given name appears first
-	// in any chain, observing pwad ordering rules. killough
+	const lumpslot_t empty = {0, 0, -1};
+	lumpindex.assign((size_t)1 << lumpindexbits, empty);
 
-	for (unsigned int i = 0; i < numlumps; i++)
+	const size_t mask = lumpindex.size() - 1;
+
+	// Later lumps override earlier ones, so insert backwards and skip
+	// names that are already in
+	for (int lump = (int)numlumps - 1; lump >= 0; lump--)
 	{
-		unsigned int j = W_LumpNameHash(lumpinfo[i].name) % (unsigned int)numlumps;
-		lumpinfo[i].next = lumpinfo[j].index;     // Prepend to list
-		lumpinfo[j].index = i;
+		const uint64_t key = lumpinfo[lump].namekey;
+		const int namespc = lumpinfo[lump].namespc;
+
+		size_t i = W_LumpSlot(key, namespc);
+		while (lumpindex[i].lump >= 0 &&
+		       (lumpindex[i].key != key || lumpindex[i].namespc != namespc))
+			i = (i + 1) & mask;
+
+		if (lumpindex[i].lump < 0)
+		{
+			lumpindex[i].key = key;
+			lumpindex[i].namespc = namespc;
+			lumpindex[i].lump = lump;
+		}
 	}
+
+	if (++lumpindexgen == 0)
+		lumpindexgen = 1;
 }
 
 
@@ -142,71 +234,349 @@ void uppercopy (char *to, const char *from)
 		to[i] = 0;
 }
 
-/**
- * @brief Calculate a CRC32 hash from a file.
- * 
- * @param filename Filename of file to hash.
- * @return Output hash, or blank if file could not be found.
- */
-OCRC32Sum W_CRC32(const std::string& filename)
+//
+// WAD HASH CACHE
+//
+// Whole-file hashes are expensive on big wads, so the CRC32 and MD5 of every
+// file we hash are kept in wadhashes.txt in the user directory, keyed by the
+// absolute path along with the size, modification time and inode the file
+// had when it was hashed. An entry is only trusted while all of those still
+// match. Files modified in the last couple of seconds are never cached, as
+// a rewrite within the same second would keep the same mtime.
+//
+
+static const char* WADHASH_FILENAME = "wadhashes.txt";
+static const size_t WADHASH_READ_SIZE = 1024 * 1024;
+static const time_t WADHASH_RACY_SECONDS = 2;
+
+struct wadhash_t
 {
-	OCRC32Sum rvo;
+	unsigned long long size;
+	long long mtime;
+	unsigned long long inode;
+	OCRC32Sum crc32;
+	OMD5Hash md5;
+};
 
-	const int file_chunk_size = 8192;
-	FILE* fp = fopen(filename.c_str(), "rb");
+typedef OHashTable<std::string, wadhash_t> WadHashTable;
+static WadHashTable wadhashes;
+static bool wadhashes_loaded = false;
 
-	if (!fp)
-		return rvo;
+// Lines in the cache file beyond one per entry in wadhashes, counting
+// those written by earlier runs.
+static size_t wadhash_extralines = 0;
 
-	unsigned n = 0;
-	unsigned char buf[file_chunk_size];
-	uint32_t crc = 0;
+static size_t wadhash_hits = 0;
+static size_t wadhash_hashed = 0;
+static unsigned long long wadhash_hashedbytes = 0;
 
-	while ((n = fread(buf, 1, sizeof(buf), fp)))
+//
+// W_StatHashKey
+//
+// Fills in the cache key for a file, and returns false if the file does not
+// exist or was modified too recently to be cached.
+//
+static bool W_StatHashKey(const std::string& filename, std::string& path, wadhash_t& key,
+                          bool& cacheable)
+{
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0 || (st.st_mode & S_IFMT) != S_IFREG)
+		return false;
+
+	if (!M_GetAbsPath(filename, path))
+		path = filename;
+
+	key.size = st.st_size;
+	key.mtime = st.st_mtime;
+	key.inode = st.st_ino;
+	cacheable = st.st_mtime < time(NULL) - WADHASH_RACY_SECONDS;
+	return true;
+}
+
+static void W_LoadHashCache()
+{
+	wadhashes_loaded = true;
+
+	FILE* fp = fopen(M_GetUserFileName(WADHASH_FILENAME).c_str(), "r");
+	if (fp == NULL)
+		return;
+
+	size_t lines = 0;
+	char line[4096];
+	while (fgets(line, sizeof(line), fp))
 	{
-		crc = crc32_fast(buf, n, crc);
+		// Skip anything too long to be a whole line
+		if (strchr(line, '\n') == NULL)
+			continue;
+
+		lines++;
+
+		wadhash_t entry;
+		char crc32[16], md5[40];
+		int pathstart = 0;
+
+		if (sscanf(line, "%llu %lld %llu %15s %39s %n", &entry.size, &entry.mtime,
+		           &entry.inode, crc32, md5, &pathstart) != 5 || pathstart == 0)
+			continue;
+
+		std::string path = line + pathstart;
+		TrimStringEnd(path);
+		if (path.empty() || !OCRC32Sum::makeFromHexStr(entry.crc32, crc32) ||
+		    !OMD5Hash::makeFromHexStr(entry.md5, md5))
+			continue;
+
+		// Later lines replace earlier ones for the same path
+		wadhashes[path] = entry;
 	}
 
-	std::string hashStr;
+	fclose(fp);
+
+	// Replaced and unreadable lines count towards the next rewrite
+	wadhash_extralines = lines - wadhashes.size();
+}
+
+//
+// W_SaveHashEntries
+//
+// Appends new entries to the cache file. The file is rewritten from scratch
+// once it has collected more stale lines than live ones.
+//
+static void W_SaveHashEntries(const std::vector<std::string>& paths)
+{
+	if (paths.empty())
+		return;
+
+	const std::string filename = M_GetUserFileName(WADHASH_FILENAME);
+	const bool rewrite = wadhash_extralines + paths.size() > wadhashes.size();
 
-	StrFormat(hashStr, "%08X", crc);
+	FILE* fp = fopen(filename.c_str(), rewrite ? "w" : "a");
+	if (fp == NULL)
+		return;
 
-	OCRC32Sum::makeFromHexStr(rvo, hashStr);
-	return rvo; // bubble up failure
+	if (rewrite)
+	{
+		for (WadHashTable::const_iterator it = wadhashes.begin(); it != wadhashes.end();
+		     ++it)
+		{
+			const wadhash_t& entry = it->second;
+			fprintf(fp, "%llu %lld %llu %s %s %s\n", entry.size, entry.mtime,
+			        entry.inode, entry.crc32.getHexCStr(), entry.md5.getHexCStr(),
+			        it->first.c_str());
+		}
+		wadhash_extralines = 0;
+	}
+	else
+	{
+		for (size_t i = 0; i < paths.size(); i++)
+		{
+			const wadhash_t& entry = wadhashes[paths[i]];
+			fprintf(fp, "%llu %lld %llu %s %s %s\n", entry.size, entry.mtime,
+			        entry.inode, entry.crc32.getHexCStr(), entry.md5.getHexCStr(),
+			        paths[i].c_str());
+		}
+		wadhash_extralines += paths.size();
+	}
+
+	fclose(fp);
 }
 
-// denis - Standard MD5SUM
-OMD5Hash W_MD5(const std::string& filename)
+// A file waiting to be hashed by a worker. Workers only touch their own job.
+struct wadhashjob_t
 {
-	OMD5Hash rvo;
+	std::string path;
+	wadhash_t key;
+	bool cacheable;
+	bool ok;
+	uint32_t crc;
+	md5_byte_t digest[16];
+};
 
-	const int file_chunk_size = 8192;
-	FILE *fp = fopen(filename.c_str(), "rb");
+//
+// W_HashJob
+//
+// Computes the CRC32 and MD5 of a file in one pass, with large reads.
+//
+static void W_HashJob(void* data, int part)
+{
+	wadhashjob_t& job = (*static_cast<std::vector<wadhashjob_t>*>(data))[part];
 
-	if(!fp)
-		return rvo;
+	job.ok = false;
 
+	FILE* fp = fopen(job.path.c_str(), "rb");
+	if (fp == NULL)
+		return;
+
+	// We read in big chunks ourselves, stdio buffering would only copy
+	setvbuf(fp, NULL, _IONBF, 0);
+
+	unsigned char* buf = new unsigned char[WADHASH_READ_SIZE];
 	md5_state_t state;
 	md5_init(&state);
+	job.crc = 0;
 
-	unsigned n = 0;
-	unsigned char buf[file_chunk_size];
-
-	while((n = fread(buf, 1, sizeof(buf), fp)))
-		md5_append(&state, (unsigned char *)buf, n);
+	size_t n;
+	while ((n = fread(buf, 1, WADHASH_READ_SIZE, fp)) > 0)
+	{
+		job.crc = crc32_fast(buf, n, job.crc);
+		md5_append(&state, buf, n);
+	}
 
-	md5_byte_t digest[16];
-	md5_finish(&state, digest);
+	job.ok = !ferror(fp);
+	md5_finish(&state, job.digest);
 
+	delete[] buf;
 	fclose(fp);
+}
+
+//
+// W_RunHashJobs
+//
+// Hashes the files that are not cached, or have changed since they were, on
+// the worker pool and saves the new hashes. Files modified too recently to
+// be cached are never added to wadhashes, their hashes are handed back in
+// racy instead.
+//
+static void W_RunHashJobs(const std::vector<std::string>& filenames,
+                          std::vector<wadhashjob_t>& racy)
+{
+	if (!wadhashes_loaded)
+		W_LoadHashCache();
+
+	std::vector<wadhashjob_t> jobs;
+	OHashTable<std::string, bool> queued;
+
+	for (size_t i = 0; i < filenames.size(); i++)
+	{
+		wadhashjob_t job;
+		if (!W_StatHashKey(filenames[i], job.path, job.key, job.cacheable))
+			continue;
+
+		if (queued.find(job.path) != queued.end())
+			continue;
+		queued[job.path] = true;
+
+		WadHashTable::const_iterator it = wadhashes.find(job.path);
+		if (job.cacheable && it != wadhashes.end() && it->second.size == job.key.size &&
+		    it->second.mtime == job.key.mtime && it->second.inode == job.key.inode)
+		{
+			wadhash_hits++;
+			continue;
+		}
+
+		jobs.push_back(job);
+	}
+
+	if (jobs.empty())
+		return;
+
+	I_RunParallel(W_HashJob, &jobs, (int)jobs.size());
+
+	std::vector<std::string> saved;
+	for (size_t i = 0; i < jobs.size(); i++)
+	{
+		wadhashjob_t& job = jobs[i];
+		if (!job.ok)
+			continue;
+
+		std::string crc32, md5, hex;
+		StrFormat(crc32, "%08X", job.crc);
+		for (size_t j = 0; j < ARRAY_LENGTH(job.digest); j++)
+		{
+			StrFormat(hex, "%02X", job.digest[j]);
+			md5 += hex;
+		}
+
+		OCRC32Sum::makeFromHexStr(job.key.crc32, crc32);
+		OMD5Hash::makeFromHexStr(job.key.md5, md5);
+
+		wadhash_hashed++;
+		wadhash_hashedbytes += job.key.size;
+
+		if (!job.cacheable)
+		{
+			racy.push_back(job);
+			continue;
+		}
+
+		wadhashes[job.path] = job.key;
+		saved.push_back(job.path);
+	}
+
+	W_SaveHashEntries(saved);
+}
+
+/**
+ * @brief Make sure the CRC32 and MD5 of a set of files are in the hash cache.
+ *
+ * @detail Files that are not cached, or have changed since they were, are
+ *         hashed on the worker pool, then the new hashes are saved. Files
+ *         modified in the last couple of seconds are hashed but not kept.
+ *
+ * @param filenames Files to hash, missing files are skipped.
+ */
+void W_HashFiles(const std::vector<std::string>& filenames)
+{
+	std::vector<wadhashjob_t> racy;
+	W_RunHashJobs(filenames, racy);
+}
+
+//
+// W_GetFileHashes
+//
+// Looks up the hashes of a single file, hashing it if needed. Returns false
+// if the file could not be read.
+//
+static bool W_GetFileHashes(const std::string& filename, wadhash_t& out)
+{
+	std::vector<std::string> filenames(1, filename);
+	std::vector<wadhashjob_t> racy;
+	W_RunHashJobs(filenames, racy);
+
+	// Too recently modified to be cached, use the hashes just this once
+	if (!racy.empty())
+	{
+		out = racy[0].key;
+		return true;
+	}
+
+	std::string path;
+	wadhash_t key;
+	bool cacheable;
+	if (!W_StatHashKey(filename, path, key, cacheable) || !cacheable)
+		return false;
 
-	std::stringstream hashStr;
+	WadHashTable::iterator it = wadhashes.find(path);
+	if (it == wadhashes.end() || it->second.size != key.size ||
+	    it->second.mtime != key.mtime || it->second.inode != key.inode)
+		return false;
 
-	for(int i = 0; i < 16; i++)
-		hashStr << std::setw(2) << std::setfill('0') << std::hex << std::uppercase << (short)digest[i];
+	out = it->second;
+	return true;
+}
 
-	OMD5Hash::makeFromHexStr(rvo, hashStr.str());
-	return rvo; // bubble up failure
+/**
+ * @brief Calculate a CRC32 hash from a file.
+ * 
+ * @param filename Filename of file to hash.
+ * @return Output hash, or blank if file could not be found.
+ */
+OCRC32Sum W_CRC32(const std::string& filename)
+{
+	wadhash_t entry;
+	if (!W_GetFileHashes(filename, entry))
+		return OCRC32Sum();
+
+	return entry.crc32;
+}
+
+// denis - Standard MD5SUM
+OMD5Hash W_MD5(const std::string& filename)
+{
+	wadhash_t entry;
+	if (!W_GetFileHashes(filename, entry))
+		return OMD5Hash();
+
+	return entry.md5;
 }
 
 /*
@@ -249,6 +619,96 @@ fhfprint_s W_FarmHash128(const byte* lumpdata, int length)
 	return fhfngprnt;
 }
 
+//
+// W_MapFile
+//
+// Maps an open wad file into memory read-only. Lumps of mapped files are
+// copied straight out of the mapping, or used in place by W_MapLumpNum,
+// instead of being read with stdio. Only done if -mmap was given, leaves
+// base NULL otherwise or if the file could not be mapped.
+//
+// The mapping is private, so later writes to the file do not have to show
+// up in it, but pages past the end of a file that is truncated while it is
+// loaded still fault (SIGBUS) when touched. Wads are not expected to change
+// under a running game, which is why mapping is not the default.
+//
+static void W_MapFile(wadfile_t& file)
+{
+	file.base = NULL;
+	file.size = M_FileLength(file.handle);
+#if defined(_WIN32) && !defined(_XBOX)
+	file.mapping = NULL;
+#endif
+
+	if (file.size == 0 || !Args.CheckParm("-mmap"))
+		return;
+
+#if defined(_WIN32) && !defined(_XBOX)
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file.handle));
+	file.mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (file.mapping == NULL)
+		return;
+
+	file.base = (const byte*)MapViewOfFile(file.mapping, FILE_MAP_READ, 0, 0, 0);
+	if (file.base == NULL)
+	{
+		CloseHandle(file.mapping);
+		file.mapping = NULL;
+		return;
+	}
+#elif defined(W_POSIX_MMAP)
+	void* base = mmap(NULL, file.size, PROT_READ, MAP_PRIVATE, fileno(file.handle), 0);
+	if (base == MAP_FAILED)
+		return;
+
+	file.base = (const byte*)base;
+#else
+	return;
+#endif
+
+	wadstats.mappedfiles++;
+	wadstats.mappedbytes += file.size;
+}
+
+static void W_UnmapFile(wadfile_t& file)
+{
+	if (file.base == NULL)
+		return;
+
+#if defined(_WIN32) && !defined(_XBOX)
+	UnmapViewOfFile(file.base);
+	CloseHandle(file.mapping);
+	file.mapping = NULL;
+#elif defined(W_POSIX_MMAP)
+	munmap((void*)file.base, file.size);
+#endif
+
+	wadstats.mappedfiles--;
+	wadstats.mappedbytes -= file.size;
+	file.base = NULL;
+}
+
+//
+// W_ReadFile
+//
+// Reads len bytes at pos from an open wad file. Returns false on a short
+// read.
+//
+static bool W_ReadFile(const wadfile_t& file, size_t pos, void* dest, size_t len)
+{
+	if (file.base != NULL)
+	{
+		if (pos > file.size || len > file.size - pos)
+			return false;
+
+		memcpy(dest, file.base + pos, len);
+		return true;
+	}
+
+	fseek(file.handle, pos, SEEK_SET);
+	return fread(dest, len, 1, file.handle) == 1;
+}
+
 //
 // LUMP BASED ROUTINES.
 //
@@ -259,7 +719,7 @@ fhfprint_s W_FarmHash128(const byte* lumpdata, int length)
 // Adds lumps from the array of filelump_t. If clientonly is true,
 // only certain lumps will be added.
 //
-void W_AddLumps(FILE* handle, filelump_t* fileinfo, size_t newlumps, bool clientonly)
+void W_AddLumps(const wadfile_t& file, filelump_t* fileinfo, size_t newlumps, bool clientonly)
 {
 	lumpinfo = (lumpinfo_t*)Realloc(lumpinfo, (numlumps + newlumps) * sizeof(lumpinfo_t));
 	if (!lumpinfo)
@@ -270,9 +730,17 @@ void W_AddLumps(FILE* handle, filelump_t* fileinfo, size_t newlumps, bool client
 
 	for (size_t i = 0; i < newlumps; i++, info++)
 	{
-		lump->handle = handle;
+		lump->handle = file.handle;
 		lump->position = info->filepos;
 		lump->size = info->size;
+
+		// Lumps that run past the end of the file are left to W_ReadLump
+		// to complain about
+		if (file.base != NULL && (size_t)info->filepos <= file.size &&
+		    (size_t)info->size <= file.size - info->filepos)
+			lump->mapdata = file.base + info->filepos;
+		else
+			lump->mapdata = NULL;
 		strncpy(lump->name, info->name, 8);
 
 		lump++;
@@ -307,13 +775,17 @@ void AddFile(const OResFile& file)
 
 	Printf(PRINT_HIGH, "adding %s", filename.c_str());
 
+	wadfile_t wadfile;
+	wadfile.handle = handle;
+	W_MapFile(wadfile);
+
 	size_t newlumps;
 
 	wadinfo_t header;
-	size_t readlen = fread(&header, sizeof(header), 1, handle);
-	if ( readlen < 1 )
+	if (!W_ReadFile(wadfile, 0, &header, sizeof(header)))
 	{
 		Printf(PRINT_HIGH, "failed to read %s.\n", filename.c_str());
+		W_UnmapFile(wadfile);
 		fclose(handle);
 		return;
 	}
@@ -327,7 +799,7 @@ void AddFile(const OResFile& file)
 
 		fileinfo = new filelump_t[1];	
 		fileinfo->filepos = 0;
-		fileinfo->size = M_FileLength(handle);
+		fileinfo->size = wadfile.size;
 		std::transform(lumpname.c_str(), lumpname.c_str() + 8, fileinfo->name, toupper);
 
 		newlumps = 1;
@@ -340,19 +812,20 @@ void AddFile(const OResFile& file)
 		header.infotableofs = LELONG(header.infotableofs);
 		size_t length = header.numlumps * sizeof(filelump_t);
 
-		if (length > (unsigned)M_FileLength(handle))
+		if (length > wadfile.size)
 		{
 			Printf(PRINT_WARNING, "\nbad number of lumps for %s\n", filename.c_str());
+			W_UnmapFile(wadfile);
 			fclose(handle);
 			return;
 		}
 
 		fileinfo = new filelump_t[header.numlumps];
-		fseek(handle, header.infotableofs, SEEK_SET);
-		readlen = fread(fileinfo, length, 1, handle);
-		if (readlen < 1)
+		if (!W_ReadFile(wadfile, header.infotableofs, fileinfo, length))
 		{
 			Printf(PRINT_HIGH, "failed to read file info in %s\n", filename.c_str());
+			delete [] fileinfo;
+			W_UnmapFile(wadfile);
 			fclose(handle);
 			return;
 		}
@@ -369,7 +842,8 @@ void AddFile(const OResFile& file)
 		Printf(PRINT_HIGH, " (%d lumps)\n", header.numlumps);
 	}
 
-	W_AddLumps(handle, fileinfo, newlumps, false);
+	W_AddLumps(wadfile, fileinfo, newlumps, false);
+	wadfilemaps.push_back(wadfile);
 
 	delete [] fileinfo;
 
@@ -453,6 +927,7 @@ void W_MergeLumps (const char *start, const char *end, int space)
 					newlumps++;
 					strncpy (newlumpinfos[0].name, ustart, 8);
 					newlumpinfos[0].handle = NULL;
+					newlumpinfos[0].mapdata = NULL;
 					newlumpinfos[0].position =
 						newlumpinfos[0].size = 0;
 					newlumpinfos[0].namespc = ns_global;
@@ -521,6 +996,7 @@ void W_MergeLumps (const char *start, const char *end, int space)
 
 		strncpy (lumpinfo[numlumps].name, uend, 8);
 		lumpinfo[numlumps].handle = NULL;
+		lumpinfo[numlumps].mapdata = NULL;
 		lumpinfo[numlumps].position =
 			lumpinfo[numlumps].size = 0;
 		lumpinfo[numlumps].namespc = ns_global;
@@ -551,6 +1027,7 @@ void W_InitMultipleFiles(const OResFiles& files)
 
 	M_Free(::lumpinfo);
 	::lumpinfo = NULL;
+	lumpindex.clear();
 
 	// open each file once, load headers, and count lumps
 	std::vector<OMD5Hash> loaded;
@@ -628,39 +1105,36 @@ int W_HandleToLump(const lumpHandle_t handle)
 // W_CheckNumForName
 // Returns -1 if name not found.
 //
-// Rewritten by Lee Killough to use hash table for performance. Significantly
-// cuts down on time -- increases Doom performance over 300%. This is the
-// single most important optimization of the original Doom sources, because
-// lump name lookup is used so often, and the original Doom used a sequential
-// search. For large wads with > 1000 lumps this meant an average of over
-// 500 were probed during every search. Now the average is under 2 probes per
-// search. There is no significant benefit to packing the names into longwords
-// with this new hashing algorithm, because the work to do the packing is
-// just as much work as simply doing the string comparisons with the new
-// algorithm, which minimizes the expected number of comparisons to under 2.
-//
-// [SL] taken from prboom-plus
+// Lump names are compared as uppercase 64-bit keys through the lump name
+// index, which stores every name and namespace pair once. A lookup is one
+// hash and usually a single probe.
 //
 int W_CheckNumForName(const char *name, int namespc)
 {
-	// Hash function maps the name to one of possibly numlump chains.
-	// It has been tuned so that the average chain length never exceeds 2.
+	return W_LookupLump(W_LumpNameKey(name), namespc);
+}
 
-	// proff 2001/09/07 - check numlumps==0, this happens when called before WAD loaded
-	register int i = (numlumps==0)?(-1):(lumpinfo[W_LumpNameHash(name) % numlumps].index);
+//
+// W_CheckNumForName
+//
+// Remembers the result in the OLumpName, so names that are looked up over
+// and over, such as HUD graphics, only probe the index again after it has
+// been rebuilt.
+//
+int W_CheckNumForName(const OLumpName& name, int namespc)
+{
+	const uint64_t key = W_LumpNameKey(name.m_data);
 
-	// We search along the chain until end, looking for case-insensitive
-	// matches which also match a namespace tag. Separate hash tables are
-	// not used for each namespace, because the performance benefit is not
-	// worth the overhead, considering namespace collisions are rare in
-	// Doom wads.
+	if (name.m_lumpgen == lumpindexgen && name.m_lumpkey == key &&
+	    name.m_lumpns == namespc)
+		return name.m_lump;
 
-	while (i >= 0 && (strnicmp(lumpinfo[i].name, name, 8) ||
-				lumpinfo[i].namespc != namespc))
-		i = lumpinfo[i].next;
+	name.m_lump = W_LookupLump(key, namespc);
+	name.m_lumpkey = key;
+	name.m_lumpns = namespc;
+	name.m_lumpgen = lumpindexgen;
 
-	// Return the matching lump, or -1 if none found.
-	return i;
+	return name.m_lump;
 }
 
 //
@@ -686,7 +1160,15 @@ int W_GetNumForName(const char* name, int namespc)
 //
 int W_GetNumForName(OLumpName& name, int namespc)
 {
-	return W_GetNumForName(name.c_str(), namespc);
+	int i = W_CheckNumForName(static_cast<const OLumpName&>(name), namespc);
+
+	if (i == -1)
+	{
+		I_Error("W_GetNumForName: %s not found!\n(checked in: %s)", name.c_str(),
+		        M_ResFilesToString(::wadfiles).c_str());
+	}
+
+	return i;
 }
 
 /**
@@ -732,6 +1214,14 @@ void W_ReadLump(unsigned int lump, void* dest)
 
 	l = lumpinfo + lump;
 
+	if (l->mapdata != NULL)
+	{
+		memcpy(dest, l->mapdata, l->size);
+		wadstats.mappedcopies++;
+		wadstats.copiedbytes += l->size;
+		return;
+	}
+
 	if (lump != stdisk_lumpnum)
     	I_BeginRead();
 
@@ -741,6 +1231,9 @@ void W_ReadLump(unsigned int lump, void* dest)
 	if (feof(l->handle))
 		I_Error ("W_ReadLump: only read %i of %i on lump %i", c, l->size, lump);
 
+	wadstats.filereads++;
+	wadstats.copiedbytes += l->size;
+
 	if (lump != stdisk_lumpnum)
     	I_EndRead();
 }
@@ -777,7 +1270,7 @@ bool W_CheckLumpName (unsigned lump, const char *name)
 	if (lump >= numlumps)
 		return false;
 
-	return !strnicmp (lumpinfo[lump].name, name, 8);
+	return lumpinfo[lump].namekey == W_LumpNameKey(name);
 }
 
 //
@@ -837,6 +1330,54 @@ void* W_CacheLumpNum(unsigned int lump, const zoneTag_e tag)
 	return lumpcache[lump];
 }
 
+//
+// W_LumpView
+//
+// Returns the mapped contents of a lump if they can be read in place. Lumps
+// are laid out at any offset in a wad, so a lump that is not aligned to
+// align in the file is left to be copied.
+//
+static const byte* W_LumpView(unsigned int lump, size_t align)
+{
+	const byte* data = lumpinfo[lump].mapdata;
+	if (data == NULL || ((size_t)data & (align - 1)) != 0)
+		return NULL;
+
+	return data;
+}
+
+//
+// W_MapLumpNum
+//
+// Returns the contents of a lump for reading only. Lumps of mapped wad files
+// that are aligned to align (a power of two, see W_AlignOf) are used in
+// place, others are cached with PU_STATIC. Unlike W_CacheLumpNum, the data
+// is not followed by a zero byte. Release it with W_UnmapLumpNum.
+//
+const void* W_MapLumpNum(unsigned int lump, size_t align)
+{
+	if (lump >= numlumps)
+		I_Error ("W_MapLumpNum: %i >= numlumps", lump);
+
+	const byte* view = W_LumpView(lump, align);
+	if (view != NULL)
+	{
+		wadstats.views++;
+		return view;
+	}
+
+	return W_CacheLumpNum(lump, PU_STATIC);
+}
+
+//
+// W_UnmapLumpNum
+//
+void W_UnmapLumpNum(unsigned int lump, const void* data)
+{
+	if (lump < numlumps && data != lumpinfo[lump].mapdata)
+		Z_Free(const_cast<void*>(data));
+}
+
 //
 // W_CacheLumpName
 //
@@ -850,7 +1391,7 @@ void* W_CacheLumpName(const char* name, const zoneTag_e tag)
 //
 void* W_CacheLumpName(OLumpName& name, const zoneTag_e tag)
 {
-	return W_CacheLumpNum(W_GetNumForName(name.c_str()), tag);
+	return W_CacheLumpNum(W_GetNumForName(name), tag);
 }
 
 size_t R_CalculateNewPatchSize(patch_t *patch, size_t length);
@@ -870,11 +1411,21 @@ patch_t* W_CachePatch(unsigned lumpnum, const zoneTag_e tag)
 
 	if (!lumpcache[lumpnum])
 	{
-		// temporary storage of the raw patch in the old format
-		byte *rawlumpdata = new byte[W_LumpLength(lumpnum)];
+		// temporary storage of the raw patch in the old format, unless the
+		// wad is mapped and it can be converted in place
+		byte *rawlumpdata = NULL;
+		patch_t *rawpatch = (patch_t*)W_LumpView(lumpnum, W_AlignOf<patch_t>::value);
 
-		W_ReadLump(lumpnum, rawlumpdata);
-		patch_t *rawpatch = (patch_t*)(rawlumpdata);
+		if (rawpatch != NULL)
+		{
+			wadstats.views++;
+		}
+		else
+		{
+			rawlumpdata = new byte[W_LumpLength(lumpnum)];
+			W_ReadLump(lumpnum, rawlumpdata);
+			rawpatch = (patch_t*)(rawlumpdata);
+		}
 
 		size_t newlumplen = R_CalculateNewPatchSize(rawpatch, W_LumpLength(lumpnum));
 
@@ -915,7 +1466,7 @@ patch_t* W_CachePatch(const char* name, const zoneTag_e tag)
 
 patch_t* W_CachePatch(OLumpName& name, const zoneTag_e tag)
 {
-	return W_CachePatch(W_GetNumForName(name.c_str()), tag);
+	return W_CachePatch(W_GetNumForName(name), tag);
 	// denis - todo - would be good to replace non-existant patches with a default '404'
 	// patch
 }
@@ -968,9 +1519,11 @@ int W_FindLump (const char *name, int lastlump)
 	if (lastlump < -1)
 		lastlump = -1;
 
+	const uint64_t key = W_LumpNameKey(name);
+
 	for (int i = lastlump + 1; i < (int)numlumps; i++)
 	{
-		if (strnicmp(lumpinfo[i].name, name, 8) == 0)
+		if (lumpinfo[i].namekey == key)
 			return i;
 	}
 
@@ -1002,6 +1555,10 @@ void W_Close ()
 		lump_p++;
 	}
 
+	for (size_t i = 0; i < wadfilemaps.size(); i++)
+		W_UnmapFile(wadfilemaps[i]);
+	wadfilemaps.clear();
+
 	::handleGen = (::handleGen + 1) & HANDLE_GEN_MASK;
 	if (::handleGen == 0)
 	{
@@ -1010,4 +1567,133 @@ void W_Close ()
 	}
 }
 
+//
+// lumpbench
+//
+// Times lump name lookups of every lump in the loaded wads, by plain name,
+// through an OLumpName and for names that are not there, and checks each
+// lookup found the right lump.
+//
+BEGIN_COMMAND(lumpbench)
+{
+	const int passes = argc > 1 ? MAX(atoi(argv[1]), 1) : 100;
+
+	if (numlumps == 0 || lumpindex.empty())
+		return;
+
+	std::vector<OLumpName> names(numlumps);
+	std::vector<OLumpName> misses(numlumps);
+	size_t wrong = 0;
+
+	for (size_t i = 0; i < numlumps; i++)
+	{
+		names[i] = lumpinfo[i].name;
+
+		// No real lump name starts with a tilde
+		char miss[9];
+		memcpy(miss, lumpinfo[i].name, 8);
+		miss[8] = '\0';
+		misses[i] = miss;
+		misses[i][0] = '~';
+
+		const int found = W_CheckNumForName(lumpinfo[i].name, lumpinfo[i].namespc);
+		if (found < (int)i || lumpinfo[found].namekey != lumpinfo[i].namekey ||
+		    lumpinfo[found].namespc != lumpinfo[i].namespc)
+			wrong++;
+	}
+
+	// Average probes to find each name in the index
+	size_t entries = 0, probes = 0;
+	const size_t mask = lumpindex.size() - 1;
+	for (size_t i = 0; i < lumpindex.size(); i++)
+	{
+		if (lumpindex[i].lump < 0)
+			continue;
+
+		entries++;
+		for (size_t j = W_LumpSlot(lumpindex[i].key, lumpindex[i].namespc);; j = (j + 1) & mask)
+		{
+			probes++;
+			if (j == i)
+				break;
+		}
+	}
+
+	volatile int sink = 0;
+	dtime_t start, bynames, bylumpnames, bymisses;
+
+	start = I_GetTime();
+	for (int pass = 0; pass < passes; pass++)
+		for (size_t i = 0; i < numlumps; i++)
+			sink += W_CheckNumForName(lumpinfo[i].name, lumpinfo[i].namespc);
+	bynames = I_GetTime() - start;
+
+	start = I_GetTime();
+	for (int pass = 0; pass < passes; pass++)
+		for (size_t i = 0; i < numlumps; i++)
+			sink += W_CheckNumForName(names[i], lumpinfo[i].namespc);
+	bylumpnames = I_GetTime() - start;
+
+	start = I_GetTime();
+	for (int pass = 0; pass < passes; pass++)
+		for (size_t i = 0; i < numlumps; i++)
+			sink += W_CheckNumForName(misses[i].c_str(), lumpinfo[i].namespc);
+	bymisses = I_GetTime() - start;
+
+	const double lookups = (double)numlumps * passes;
+
+	Printf(PRINT_HIGH, "%u lumps, %u names in %u slots, %.2f probes per name\n",
+	       (unsigned)numlumps, (unsigned)entries, (unsigned)lumpindex.size(),
+	       entries ? (double)probes / entries : 0.0);
+	Printf(PRINT_HIGH, "By name: %.1f ns, by OLumpName: %.1f ns, missing: %.1f ns\n",
+	       bynames / lookups, bylumpnames / lookups, bymisses / lookups);
+	if (wrong)
+		Printf(PRINT_WARNING, "%u lookups found the wrong lump!\n", (unsigned)wrong);
+}
+END_COMMAND(lumpbench)
+
+BEGIN_COMMAND(wadstats)
+{
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+	{
+		wadstats.views = wadstats.mappedcopies = wadstats.filereads =
+		    wadstats.copiedbytes = 0;
+		wadhash_hits = wadhash_hashed = 0;
+		wadhash_hashedbytes = 0;
+		Printf(PRINT_HIGH, "Wad stats reset.\n");
+		return;
+	}
+
+	std::string bytes;
+
+	StrFormatBytes(bytes, wadstats.mappedbytes);
+	Printf(PRINT_HIGH, "%u of %u wad files mapped (%s)\n",
+	       (unsigned)wadstats.mappedfiles, (unsigned)wadfilemaps.size(), bytes.c_str());
+
+	StrFormatBytes(bytes, wadstats.copiedbytes);
+	Printf(PRINT_HIGH, "Lumps used in place: %u\n", (unsigned)wadstats.views);
+	Printf(PRINT_HIGH, "Lumps copied from a mapping: %u, read from a file: %u (%s)\n",
+	       (unsigned)wadstats.mappedcopies, (unsigned)wadstats.filereads, bytes.c_str());
+
+	StrFormatBytes(bytes, (size_t)wadhash_hashedbytes);
+	Printf(PRINT_HIGH, "Files hashed: %u (%s), found in the hash cache: %u\n",
+	       (unsigned)wadhash_hashed, bytes.c_str(), (unsigned)wadhash_hits);
+
+#ifdef __linux__
+	// Resident set size, mapped wad pages that have been touched count too
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm != NULL)
+	{
+		unsigned long size, resident;
+		if (fscanf(statm, "%lu %lu", &size, &resident) == 2)
+		{
+			StrFormatBytes(bytes, (size_t)resident * sysconf(_SC_PAGESIZE));
+			Printf(PRINT_HIGH, "Resident memory: %s\n", bytes.c_str());
+		}
+		fclose(statm);
+	}
+#endif
+}
+END_COMMAND(wadstats)
+
 VERSION_CONTROL (w_wad_cpp, "$Id$")
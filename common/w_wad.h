@@ -70,11 +70,11 @@ typedef struct lumpinfo_s
 	int			position;
 	int			size;
 
-	// [RH] Hashing stuff
-	int			next;
-	int			index;
+	uint64_t	namekey;	// name as a W_LumpNameKey, set by W_HashLumps
 
 	int			namespc;
+
+	const byte	*mapdata;	// lump contents if the wad is mapped, else NULL
 } lumpinfo_t;
 
 // [RH] Namespaces from BOOM.
@@ -111,12 +111,15 @@ extern	size_t	numlumps;
 
 OCRC32Sum W_CRC32(const std::string& filename);
 OMD5Hash W_MD5(const std::string& filename);
+void W_HashFiles(const std::vector<std::string>& filenames);
 fhfprint_s W_FarmHash128(const byte* lumpdata, int length);
 void W_InitMultipleFiles(const OResFiles& filenames);
 lumpHandle_t W_LumpToHandle(const unsigned lump);
 int W_HandleToLump(const lumpHandle_t handle);
 
+uint64_t W_LumpNameKey(const char* name);
 int W_CheckNumForName(const char *name, int ns = ns_global);
+int W_CheckNumForName(const OLumpName& name, int ns = ns_global);
 int W_GetNumForName(const char *name, int ns = ns_global);
 int W_GetNumForName(OLumpName& name, int ns = ns_global);
 
@@ -126,6 +129,21 @@ void		W_ReadLump (unsigned lump, void *dest);
 unsigned	W_ReadChunk (const char *file, unsigned offs, unsigned len, void *dest, unsigned &filelen);
 
 void* W_CacheLumpNum(unsigned lump, const zoneTag_e tag);
+const void* W_MapLumpNum(unsigned lump, size_t align);
+void W_UnmapLumpNum(unsigned lump, const void* data);
+
+// Alignment W_MapLumpNum needs to read a lump in place as an array of T
+template <typename T>
+struct W_AlignOf
+{
+	struct aligned_t
+	{
+		char c;
+		T t;
+	};
+	static const size_t value = sizeof(aligned_t) - sizeof(T);
+};
+
 void* W_CacheLumpName(const char* name, const zoneTag_e tag);
 void* W_CacheLumpName(OLumpName& name, const zoneTag_e tag);
 patch_t* W_CachePatch(unsigned lump, const zoneTag_e tag = PU_CACHE);
@@ -143,7 +161,6 @@ void	W_Close ();
 int		W_FindLump (const char *name, int lastlump);	// [RH]	Find lumps with duplication
 bool	W_CheckLumpName (unsigned lump, const char *name);	// [RH] True if lump's name == name // denis - todo - replace with map<>
 
-//unsigned W_LumpNameHash (const char *name);				// [RH] Create hash key from an 8-char name
 
 // [RH] Combine multiple marked ranges of lumps into one.
 void	W_MergeLumps (const char *start, const char *end, int);
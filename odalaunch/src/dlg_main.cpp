@@ -66,6 +66,7 @@
 #include <wx/stream.h>
 #include <wx/sstream.h>
 
+#include "net_query.h"
 #include "net_utils.h"
 #include "oda_defs.h"
 #include "plat_utils.h"
@@ -76,8 +77,6 @@
 
 using namespace odalpapi;
 
-extern int NUM_THREADS;
-
 // Control ID assignments for events
 // application icon
 
@@ -205,13 +204,6 @@ dlgMain::dlgMain(wxWindow* parent, wxWindowID id)
 
 	QServer = NULL;
 
-	NUM_THREADS = QueryThread::GetIdealThreadCount();
-
-	for(size_t i = 0; i < NUM_THREADS; ++i)
-	{
-		threadVector.push_back(new QueryThread(this));
-	}
-
 	{
 		wxFileConfig ConfigInfo;
 
@@ -355,26 +347,6 @@ void dlgMain::OnClose(wxCloseEvent& event)
 	if(GetThread() && GetThread()->IsRunning())
 		GetThread()->Wait();
 
-	// Gracefully terminate any running worker threads and then deallocate
-	// their memory
-	{
-        std::vector<QueryThread*>::reverse_iterator it;
-
-        for(it = threadVector.rbegin(); it != threadVector.rend(); it++)
-        {
-            if((*it)->IsRunning())
-            {
-                (*it)->GracefulExit();
-                delete *it;
-                *it = NULL;
-            }
-        }
-
-        // Clear the vector at the end so we don't play fast and loose with
-        // iterator invalidation.
-        threadVector.clear();
-	}
-
 	// Save the UI layout and shut it all down
 	wxFileConfig ConfigInfo;
 
@@ -817,8 +789,6 @@ void dlgMain::MonThrGetServerList()
 	wxInt32 RetryCount;
 	size_t ServerCount;
 
-	size_t count = 0;
-	size_t serverNum = 0;
 	std::string Address;
 	uint16_t Port = 0;
 
@@ -839,60 +809,49 @@ void dlgMain::MonThrGetServerList()
 	delete[] QServer;
 	QServer = new Server [ServerCount];
 
-	size_t thrvec_size = threadVector.size();
-
-	while(count < ServerCount)
-	{
-		for(size_t i = 0; i < thrvec_size; ++i)
-		{
-			QueryThread* OdaQT = threadVector[i];
-			QueryThread::Status Status = OdaQT->GetStatus();
-
-			// Check if the user wants us to exit
-			if(OdaTH->TestDestroy())
-			{
-				return;
-			}
-
-			if(Status == QueryThread::Running)
-			{
-				// Give up some timeslice for this thread so worker thread slots
-				// become available
-				OdaTH->Sleep(15);
+	QueryEngine Engine;
 
-				continue;
-			}
-			else
-				++count;
+	// All servers share one socket, the thread settings now decide how many
+	// queries go out per burst
+	Engine.SetTimeout(ServerTimeout);
+	Engine.SetPacing(QueryThread::GetIdealThreadCount(), 10);
+	Engine.SetCallback(&dlgMain::MonThrServerQueried, this);
 
-			// If we got this far, it means a thread has finished and needs more
-			// work, give it a job to do
-			if(serverNum < ServerCount)
-			{
-				//OdaTH->Sleep(1);
-				MServer.GetServerAddress(serverNum, Address, Port);
+	for(size_t i = 0; i < ServerCount; ++i)
+	{
+		MServer.GetServerAddress(i, Address, Port);
 
-				OdaQT->Signal(&QServer[serverNum], Address, Port, serverNum,
-				              ServerTimeout, RetryCount);
+		QServer[i].SetAddress(Address, Port);
+		QServer[i].SetRetries(RetryCount);
 
-				++serverNum;
-			}
-		}
+		if(!Engine.Queue(&QServer[i]))
+			MonThrServerQueried(&QServer[i], 0, this);
 	}
 
-	// Wait until all threads have finished before posting an event
-	for(size_t i = 0; i < thrvec_size; ++i)
+	while(Engine.Poll(15))
 	{
-		QueryThread* OdaQT = threadVector[i];
-
-		while(OdaQT->GetStatus() == QueryThread::Running)
-			OdaTH->Sleep(15);
+		// Check if the user wants us to exit
+		if(OdaTH->TestDestroy())
+			return;
 	}
 
 	MonThrPostEvent(wxEVT_THREAD_MONITOR_SIGNAL, -1,
 	                mtrs_servers_querydone, -1, -1);
 }
 
+// QueryEngine callback, posts the result of each server query to the main
+// thread like the worker threads used to
+void dlgMain::MonThrServerQueried(ServerBase* QueriedServer, int32_t Result,
+                                  void* Data)
+{
+	dlgMain* Dialog = (dlgMain*)Data;
+	wxCommandEvent newEvent(wxEVT_THREAD_WORKER_SIGNAL, wxID_ANY);
+
+	newEvent.SetId(Result);
+	newEvent.SetInt((Server*)QueriedServer - Dialog->QServer);
+	wxPostEvent(Dialog, newEvent);
+}
+
 void dlgMain::MonThrGetSingleServer()
 {
 	wxFileConfig ConfigInfo;
@@ -261,14 +261,14 @@ protected:
 	bool MonThrGetMasterList();
 	void MonThrGetServerList();
 	void MonThrGetSingleServer();
+	static void MonThrServerQueried(odalpapi::ServerBase* QueriedServer,
+	                                int32_t Result, void* Data);
 
 	void OnMonitorSignal(wxCommandEvent&);
 	void OnWorkerSignal(wxCommandEvent&);
 	// Our monitoring thread entry point, from wxThreadHelper
 	void* Entry();
 
-	std::vector<QueryThread*> threadVector;
-
 private:
 
 	DECLARE_EVENT_TABLE()
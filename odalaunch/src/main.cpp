@@ -31,6 +31,7 @@
 #include "xrc_resource.h"
 
 #include "net_io.h"
+#include "net_query.h"
 
 #include <wx/xrc/xmlres.h>
 #include <wx/image.h>
@@ -45,6 +46,30 @@ bool Application::OnInit()
 	if(BufferedSocket::InitializeSocketAPI() == false)
 		return false;
 
+	// Benchmark the query engine against local fake servers and quit
+	if(argc > 1 && argv[1] == wxT("--querybench"))
+	{
+		QueryStats_t Stats;
+		uint64_t Millis;
+		long Servers = 256;
+
+		if(argc > 2)
+			argv[2].ToLong(&Servers);
+
+		if(!BenchmarkQueryEngine(Servers, Stats, Millis))
+			wxPrintf(wxT("querybench: could not set up %ld servers\n"), Servers);
+		else
+			wxPrintf(wxT("querybench: %lu/%lu answered in %lu ms, %lu sent, ")
+			         wxT("%lu retries, max ping %lu ms\n"),
+			         (unsigned long)Stats.Answered, (unsigned long)Stats.Queued,
+			         (unsigned long)Millis, (unsigned long)Stats.Sent,
+			         (unsigned long)Stats.Retries, (unsigned long)Stats.MaxPing);
+
+		BufferedSocket::ShutdownSocketAPI();
+
+		return false;
+	}
+
 	::wxInitAllImageHandlers();
 
 	wxXmlResource::Get()->InitAllHandlers();
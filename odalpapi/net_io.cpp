@@ -61,6 +61,7 @@ BufferedSocket::BufferedSocket() :  m_BadRead(false), m_BadWrite(false),
 	m_Socket(0), m_SendPing(0), m_ReceivePing(0)
 {
 	m_Broadcast = false;
+	m_KeepOpen = false;
 	memset(&m_RemoteAddress, 0, sizeof(struct sockaddr_in));
 
 	m_SocketBuffer = new byte[MAX_PAYLOAD];
@@ -152,6 +153,52 @@ void BufferedSocket::SetBroadcast(bool enabled)
 	m_Broadcast = enabled;
 }
 
+bool BufferedSocket::Open(const uint16_t& LocalPort)
+{
+	m_KeepOpen = false;
+
+	if(CreateSocket() == false)
+		return false;
+
+	// Give the socket room to hold a burst of replies while the caller is
+	// busy parsing
+	int rcvbuf = 256 * 1024;
+
+	setsockopt(m_Socket, SOL_SOCKET, SO_RCVBUF, (char*)&rcvbuf, sizeof(rcvbuf));
+
+	// Broadcast sockets are already bound by CreateSocket
+	if(!m_Broadcast)
+	{
+		m_LocalAddress.sin_family = PF_INET;
+		m_LocalAddress.sin_port = htons(LocalPort);
+		m_LocalAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+		memset(m_LocalAddress.sin_zero, '\0', sizeof m_LocalAddress.sin_zero);
+
+		if(::bind(m_Socket, (sockaddr*)&m_LocalAddress, sizeof(m_LocalAddress)) != 0)
+		{
+			NET_ReportError(REPERR_NO_ARGS);
+			DestroySocket();
+			return false;
+		}
+	}
+
+	m_KeepOpen = true;
+
+	return true;
+}
+
+uint16_t BufferedSocket::GetLocalPort() const
+{
+	struct sockaddr_in local;
+	socklen_t locallen = sizeof(local);
+
+	if(m_Socket == 0 ||
+	        getsockname(m_Socket, (struct sockaddr*)&local, &locallen) != 0)
+		return 0;
+
+	return ntohs(local.sin_port);
+}
+
 void BufferedSocket::DestroySocket()
 {
 	if(m_Socket != 0)
@@ -234,6 +281,20 @@ string BufferedSocket::GetRemoteAddress() const
 	return rmtAddr.str();
 }
 
+void BufferedSocket::SetRemoteIP(const uint32_t& IP, const uint16_t& Port)
+{
+	m_RemoteAddress.sin_family = PF_INET;
+	m_RemoteAddress.sin_port = htons(Port);
+	m_RemoteAddress.sin_addr.s_addr = htonl(IP);
+	memset(m_RemoteAddress.sin_zero, '\0', sizeof m_RemoteAddress.sin_zero);
+}
+
+void BufferedSocket::GetRemoteIP(uint32_t& IP, uint16_t& Port) const
+{
+	IP = ntohl(m_RemoteAddress.sin_addr.s_addr);
+	Port = ntohs(m_RemoteAddress.sin_port);
+}
+
 int32_t BufferedSocket::SendData(const int32_t& Timeout)
 {
 	int32_t BytesSent;
@@ -243,7 +304,7 @@ int32_t BufferedSocket::SendData(const int32_t& Timeout)
 	if(!m_BufferSize)
 		return 0;
 
-	if(CreateSocket() == false)
+	if(!m_KeepOpen && CreateSocket() == false)
 		return 0;
 
 	BytesSent = sendto(m_Socket, (const char*)m_SocketBuffer, m_BufferSize, 0,
@@ -337,6 +398,34 @@ int32_t BufferedSocket::GetData(const int32_t& Timeout)
 	return -3;
 }
 
+int32_t BufferedSocket::PollData(const int32_t& Timeout)
+{
+	fd_set         readfds;
+	struct timeval tv;
+	int32_t        res;
+
+	if(m_Socket == 0)
+		return -2;
+
+	FD_ZERO(&readfds);
+	FD_SET(m_Socket, &readfds);
+	tv.tv_sec = Timeout / 1000;
+	tv.tv_usec = (Timeout % 1000) * 1000;
+	res = select(m_Socket+1, &readfds, NULL, NULL, &tv);
+
+	if(res == 0)
+		return -1;
+
+	if(res < 0)
+	{
+		NET_ReportError(REPERR_NO_ARGS);
+		return -2;
+	}
+
+	// Something is waiting, so this will not block
+	return GetData(0);
+}
+
 bool BufferedSocket::ReadHexString(string& str)
 {
 	std::stringstream hash;
@@ -79,6 +79,12 @@ public:
 	// Set network-wide broadcast ability
 	void SetBroadcast(bool enabled);
 
+	// Create a socket bound to LocalPort (0 for any) that is kept open
+	// across sends, so many queries can share it
+	bool Open(const uint16_t& LocalPort = 0);
+	// Gets the local port of an open socket
+	uint16_t GetLocalPort() const;
+
 	// Set the outgoing address
 	void SetRemoteAddress(const std::string& Address, const uint16_t& Port);
 	// Set the outgoing address in "address:port" format
@@ -87,10 +93,16 @@ public:
 	void GetRemoteAddress(std::string& Address, uint16_t& Port) const;
 	// Gets the outgoing address in "address:port" format
 	std::string GetRemoteAddress() const;
+	// Set/get the outgoing address as a resolved IPv4 address, host order
+	void SetRemoteIP(const uint32_t& IP, const uint16_t& Port);
+	void GetRemoteIP(uint32_t& IP, uint16_t& Port) const;
 
 	// Send/receive data
 	int32_t SendData(const int32_t& Timeout);
 	int32_t GetData(const int32_t& Timeout);
+	// Like GetData, but a Timeout of 0 returns immediately when nothing is
+	// waiting instead of blocking
+	int32_t PollData(const int32_t& Timeout);
 
 	// a method for a round-trip time in milliseconds
 	uint64_t GetPing()
@@ -177,6 +189,9 @@ private:
 	// broadcast mode
 	bool m_Broadcast;
 
+	// socket was opened with Open() and is reused by SendData
+	bool m_KeepOpen;
+
 	// local address
 	struct sockaddr_in m_LocalAddress;
 
@@ -59,7 +59,7 @@ int32_t ServerBase::Query(int32_t Timeout)
 	// If we didn't get it the first time, try again
 	while(Retry)
 	{
-		Socket->Write32(challenge);
+		WriteQuery();
 
 		if(!Socket->SendData(Timeout))
 			return 0;
@@ -609,6 +609,20 @@ int32_t Server::Parse()
 	return 0;
 }
 
+void Server::PrepareQuery()
+{
+	ResetData();
+}
+
+void Server::WriteQuery()
+{
+	Socket->Write32(challenge);
+	Socket->Write32(VERSION);
+	Socket->Write32(PROTOCOL_VERSION);
+	// bond - time
+	Socket->Write32(Info.PTime);
+}
+
 int32_t Server::Query(int32_t Timeout)
 {
 	int8_t Retry = m_RetryCount;
@@ -620,16 +634,12 @@ int32_t Server::Query(int32_t Timeout)
 
 	Socket->ClearBuffer();
 
-	ResetData();
+	PrepareQuery();
 
 	// If we didn't get it the first time, try again
 	while(Retry)
 	{
-		Socket->Write32(challenge);
-		Socket->Write32(VERSION);
-		Socket->Write32(PROTOCOL_VERSION);
-		// bond - time
-		Socket->Write32(Info.PTime);
+		WriteQuery();
 
 		if(!Socket->SendData(Timeout))
 			return 0;
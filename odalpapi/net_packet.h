@@ -80,6 +80,8 @@
 namespace odalpapi
 {
 
+class QueryEngine;
+
 const uint32_t MASTER_CHALLENGE = 777123;
 const uint32_t MASTER_RESPONSE  = 777123;
 const uint32_t SERVER_CHALLENGE = 0xAD011002;
@@ -203,6 +205,9 @@ protected:
 	uint8_t m_RetryCount;
 
 	threads::Mutex* m_Mutex;
+
+	// QueryEngine sends and parses on behalf of the server
+	friend class QueryEngine;
 public:
 	// Constructor
 	ServerBase()
@@ -234,6 +239,18 @@ public:
 		return -1;
 	}
 
+	// Called once before the first request of a query is sent
+	virtual void PrepareQuery()
+	{
+
+	}
+
+	// Write a request into the socket buffer
+	virtual void WriteQuery()
+	{
+		Socket->Write32(challenge);
+	}
+
 	// Query the server
 	int32_t Query(int32_t Timeout);
 
@@ -490,6 +507,9 @@ public:
 
 	int32_t Query(int32_t Timeout);
 
+	void PrepareQuery();
+	void WriteQuery();
+
 	void ReadInformation();
 
 	int32_t TranslateResponse(const uint16_t& TagId,
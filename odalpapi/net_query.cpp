@@ -0,0 +1,452 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id$
+//
+// Copyright (C) 2006-2020 by The Odamex Team.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//  Asynchronous query engine
+//
+//-----------------------------------------------------------------------------
+
+#include "net_query.h"
+
+#include <cstring>
+
+#include "net_error.h"
+#include "net_utils.h"
+
+using namespace std;
+
+namespace odalpapi
+{
+
+// Timer wheel size, in slots of WHEEL_RESOLUTION milliseconds. Deadlines
+// further out than one turn just stay in their slot for another turn.
+static const size_t   WHEEL_SLOTS = 256;
+static const uint32_t WHEEL_RESOLUTION = 8;
+
+// Replies read per Poll() before we go back to sending, so a flood of
+// answers cannot starve the send queue
+static const size_t MAX_READS_PER_POLL = 512;
+
+QueryEngine::QueryEngine() : m_Open(false), m_WheelTick(0), m_Timeout(1000),
+	m_Burst(32), m_Interval(10), m_NextBurst(0), m_Active(0),
+	m_Callback(NULL), m_UserData(NULL)
+{
+	m_Wheel.resize(WHEEL_SLOTS);
+
+	memset(&m_Stats, 0, sizeof(m_Stats));
+}
+
+QueryEngine::~QueryEngine()
+{
+
+}
+
+uint64_t QueryEngine::MakeKey(const uint32_t& IP, const uint16_t& Port,
+                              const uint32_t& Tag)
+{
+	return ((uint64_t)IP << 32) | ((uint64_t)Port << 16) | (Tag & 0xFFFF);
+}
+
+//
+// QueryEngine::ResponseTag()
+//
+// Maps the first word of a reply to the challenge it answers
+//
+uint32_t QueryEngine::ResponseTag(const uint32_t& Response)
+{
+	if(Response == MASTER_RESPONSE)
+		return MASTER_CHALLENGE;
+
+	if(((Response >> 20) & 0x0FFF) == TAG_ID)
+		return SERVER_CHALLENGE;
+
+	return 0;
+}
+
+bool QueryEngine::Queue(ServerBase* Server)
+{
+	string Address;
+	uint16_t Port;
+	uint32_t IP;
+
+	if(Server == NULL)
+		return false;
+
+	if(!m_Open)
+	{
+		if(!m_Socket.Open())
+			return false;
+
+		m_Open = true;
+	}
+
+	Server->GetAddress(Address, Port);
+
+	if(Address.empty() || !Port)
+		return false;
+
+	// Resolve once here instead of on every send
+	m_Socket.SetRemoteIP(0, 0);
+	m_Socket.SetRemoteAddress(Address, Port);
+	m_Socket.GetRemoteIP(IP, Port);
+
+	if(!IP)
+		return false;
+
+	Query_t Query;
+
+	Query.Server = Server;
+	Query.Key = MakeKey(IP, Port, Server->challenge);
+	Query.SendTime = 0;
+	Query.Deadline = 0;
+	Query.Serial = 0;
+	Query.Tries = 0;
+	Query.State = QS_Waiting;
+
+	Server->SetSocket(&m_Socket);
+
+	m_Queries.push_back(Query);
+
+	size_t Index = m_Queries.size() - 1;
+
+	// Only one request per address and tag can be in flight, otherwise we
+	// cannot tell the replies apart
+	if(m_Pending.find(Query.Key) != m_Pending.end())
+		m_Deferred.insert(make_pair(Query.Key, Index));
+	else
+	{
+		m_Pending[Query.Key] = Index;
+		m_SendQueue.push_back(Index);
+	}
+
+	++m_Active;
+	++m_Stats.Queued;
+
+	return true;
+}
+
+//
+// QueryEngine::SendBurst()
+//
+// Sends up to m_Burst requests from the send queue
+//
+void QueryEngine::SendBurst(const uint64_t& Now)
+{
+	size_t Sent = 0;
+
+	if(Now < m_NextBurst)
+		return;
+
+	while(Sent < m_Burst && !m_SendQueue.empty())
+	{
+		size_t Index = m_SendQueue.front();
+		Query_t& Query = m_Queries[Index];
+
+		m_SendQueue.pop_front();
+
+		// Answered while waiting to be resent
+		if(Query.State != QS_Waiting)
+			continue;
+
+		if(!Query.Tries)
+			Query.Server->PrepareQuery();
+		else
+			++m_Stats.Retries;
+
+		m_Socket.SetRemoteIP((uint32_t)(Query.Key >> 32),
+		                     (uint16_t)(Query.Key >> 16));
+		m_Socket.ClearBuffer();
+
+		Query.Server->WriteQuery();
+
+		if(m_Socket.SendData(0) <= 0)
+		{
+			Finish(Index, 0);
+			continue;
+		}
+
+		++Query.Tries;
+		++Query.Serial;
+		Query.SendTime = GetMillisNow();
+		Query.Deadline = Query.SendTime + m_Timeout;
+		Query.State = QS_InFlight;
+
+		WheelEntry_t Entry = { Index, Query.Serial };
+
+		m_Wheel[(Query.Deadline / WHEEL_RESOLUTION) % WHEEL_SLOTS].push_back(Entry);
+
+		++m_Stats.Sent;
+		++Sent;
+	}
+
+	m_NextBurst = Now + m_Interval;
+}
+
+//
+// QueryEngine::ReadReplies()
+//
+// Reads every reply waiting on the socket and hands each one to the server
+// it belongs to
+//
+void QueryEngine::ReadReplies(const uint32_t& WaitMs)
+{
+	uint32_t Wait = WaitMs;
+
+	for(size_t Reads = 0; Reads < MAX_READS_PER_POLL; ++Reads)
+	{
+		if(m_Socket.PollData(Wait) <= 0)
+			return;
+
+		// Only the first read waits
+		Wait = 0;
+
+		uint32_t IP, Response;
+		uint16_t Port;
+
+		m_Socket.GetRemoteIP(IP, Port);
+
+		if(!m_Socket.Read32(Response))
+		{
+			++m_Stats.Stray;
+			continue;
+		}
+
+		// Leave the tag for Parse()
+		m_Socket.ResetBuffer();
+
+		map<uint64_t, size_t>::iterator it =
+		    m_Pending.find(MakeKey(IP, Port, ResponseTag(Response)));
+
+		if(it == m_Pending.end())
+		{
+			++m_Stats.Stray;
+			continue;
+		}
+
+		size_t Index = it->second;
+		Query_t& Query = m_Queries[Index];
+		ServerBase* Server = Query.Server;
+
+		Server->GetLock();
+		Server->Ping = GetMillisNow() - Query.SendTime;
+		int32_t Result = Server->Parse();
+		Server->Unlock();
+
+		++m_Stats.Answered;
+		m_Stats.TotalPing += Server->Ping;
+		if(Server->Ping > m_Stats.MaxPing)
+			m_Stats.MaxPing = Server->Ping;
+
+		Finish(Index, Result);
+	}
+}
+
+//
+// QueryEngine::ExpireQueries()
+//
+// Walks the timer wheel up to Now, resending or failing requests whose
+// deadline has passed
+//
+void QueryEngine::ExpireQueries(const uint64_t& Now)
+{
+	uint64_t NowTick = Now / WHEEL_RESOLUTION;
+
+	if(!m_WheelTick || NowTick - m_WheelTick >= WHEEL_SLOTS)
+		m_WheelTick = NowTick - (WHEEL_SLOTS - 1);
+
+	for(; m_WheelTick <= NowTick; ++m_WheelTick)
+	{
+		vector<WheelEntry_t>& Slot = m_Wheel[m_WheelTick % WHEEL_SLOTS];
+		size_t Kept = 0;
+
+		for(size_t i = 0; i < Slot.size(); ++i)
+		{
+			size_t Index = Slot[i].Index;
+			Query_t& Query = m_Queries[Index];
+
+			// Answered, or resent since this entry was added
+			if(Query.State != QS_InFlight || Query.Serial != Slot[i].Serial)
+				continue;
+
+			// Due on a later turn of the wheel
+			if(Query.Deadline > Now)
+			{
+				Slot[Kept++] = Slot[i];
+				continue;
+			}
+
+			if(Query.Tries < Query.Server->m_RetryCount)
+			{
+				// Keep the pending entry so a late reply is still accepted
+				Query.State = QS_Waiting;
+				m_SendQueue.push_back(Index);
+				continue;
+			}
+
+			++m_Stats.TimedOut;
+
+			Finish(Index, 0);
+		}
+
+		Slot.resize(Kept);
+	}
+}
+
+void QueryEngine::Finish(const size_t& Index, const int32_t& Result)
+{
+	Query_t& Query = m_Queries[Index];
+	uint64_t Key = Query.Key;
+
+	Query.State = QS_Done;
+
+	m_Pending.erase(Key);
+	--m_Active;
+
+	// Let the next query to this address go out
+	multimap<uint64_t, size_t>::iterator it = m_Deferred.find(Key);
+
+	if(it != m_Deferred.end())
+	{
+		m_Pending[Key] = it->second;
+		m_SendQueue.push_front(it->second);
+		m_Deferred.erase(it);
+	}
+
+	if(m_Callback != NULL)
+		m_Callback(Query.Server, Result, m_UserData);
+}
+
+size_t QueryEngine::Poll(const uint32_t& WaitMs)
+{
+	// Everything finished, drop the old queries and any stale wheel entries
+	// that still point at them
+	if(!m_Active)
+	{
+		m_Queries.clear();
+		m_SendQueue.clear();
+
+		for(size_t i = 0; i < m_Wheel.size(); ++i)
+			m_Wheel[i].clear();
+
+		return 0;
+	}
+
+	SendBurst(GetMillisNow());
+
+	// Don't sleep past the next burst or wheel slot
+	uint32_t Wait = WaitMs;
+
+	if(!m_SendQueue.empty() && Wait > m_Interval)
+		Wait = m_Interval;
+	if(Wait > WHEEL_RESOLUTION)
+		Wait = WHEEL_RESOLUTION;
+
+	ReadReplies(Wait);
+
+	ExpireQueries(GetMillisNow());
+
+	return m_Active;
+}
+
+void QueryEngine::Run()
+{
+	while(Poll(WHEEL_RESOLUTION))
+	{
+
+	}
+}
+
+//
+// BenchmarkQueryEngine()
+//
+// Each fake server is a loopback socket that answers master server
+// challenges with a one entry list, which is enough for MasterServer::Parse
+// to succeed. The responders are serviced from the same thread between
+// engine polls.
+//
+bool BenchmarkQueryEngine(const size_t& Servers, QueryStats_t& Stats,
+                          uint64_t& Millis)
+{
+	vector<BufferedSocket*> Responders;
+	vector<MasterServer*> Masters;
+	QueryEngine Engine;
+	bool Ok = true;
+
+	Engine.SetTimeout(500);
+
+	for(size_t i = 0; i < Servers; ++i)
+	{
+		BufferedSocket* Responder = new BufferedSocket;
+		MasterServer* Master = new MasterServer;
+
+		Responders.push_back(Responder);
+		Masters.push_back(Master);
+
+		if(!Responder->Open())
+		{
+			Ok = false;
+			break;
+		}
+
+		Master->SetAddress("127.0.0.1", Responder->GetLocalPort());
+		Master->SetRetries(2);
+	}
+
+	uint64_t Start = GetMillisNow();
+
+	for(size_t i = 0; Ok && i < Servers; ++i)
+		Ok = Engine.Queue(Masters[i]);
+
+	while(Ok && Engine.Poll(0))
+	{
+		for(size_t i = 0; i < Servers; ++i)
+		{
+			BufferedSocket* Responder = Responders[i];
+			uint32_t Challenge;
+
+			while(Responder->PollData(0) > 0)
+			{
+				if(!Responder->Read32(Challenge) || Challenge != MASTER_CHALLENGE)
+					continue;
+
+				// Replies go back to whoever sent the challenge
+				Responder->ClearBuffer();
+				Responder->Write32(MASTER_RESPONSE);
+				Responder->Write16((uint16_t)1);
+				Responder->Write8((uint8_t)127);
+				Responder->Write8((uint8_t)0);
+				Responder->Write8((uint8_t)0);
+				Responder->Write8((uint8_t)1);
+				Responder->Write16(Responder->GetLocalPort());
+				Responder->SendData(0);
+			}
+		}
+	}
+
+	Millis = GetMillisNow() - Start;
+	Stats = Engine.GetStats();
+
+	for(size_t i = 0; i < Masters.size(); ++i)
+	{
+		delete Masters[i];
+		delete Responders[i];
+	}
+
+	return Ok;
+}
+
+} // namespace
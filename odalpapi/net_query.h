@@ -0,0 +1,188 @@
+// Emacs style mode select   -*- C++ -*-
+//-----------------------------------------------------------------------------
+//
+// $Id$
+//
+// Copyright (C) 2006-2020 by The Odamex Team.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//  Asynchronous query engine
+//
+//  Queries any number of servers over a single UDP socket. Requests are
+//  sent in paced bursts, replies are matched to their query by source
+//  address and response tag, and unanswered requests are retried or timed
+//  out from a timer wheel. The caller drives everything by calling Poll()
+//  from one thread and is told about each finished query via a callback.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef NET_QUERY_H
+#define NET_QUERY_H
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "net_io.h"
+#include "net_packet.h"
+#include "typedefs.h"
+
+/**
+ * odalpapi namespace.
+ *
+ * All code for the odamex launcher api is contained within the odalpapi
+ * namespace.
+ */
+namespace odalpapi
+{
+
+// Called from Poll() when a query finishes, Result is the return value of
+// the server's Parse(), or 0 if the query failed or timed out
+typedef void (*QueryCallback_t)(ServerBase* Server, int32_t Result,
+                                void* UserData);
+
+struct QueryStats_t
+{
+	size_t   Queued;
+	size_t   Sent;
+	size_t   Retries;
+	size_t   Answered;
+	size_t   TimedOut;
+	size_t   Stray; // Replies that did not match a pending query
+	uint64_t MaxPing;
+	uint64_t TotalPing;
+};
+
+class QueryEngine
+{
+public:
+	QueryEngine();
+	~QueryEngine();
+
+	// Per-request timeout in milliseconds, the number of attempts comes from
+	// each server's SetRetries()
+	void SetTimeout(const uint32_t& Timeout)
+	{
+		m_Timeout = Timeout;
+	}
+
+	// Send at most Burst requests every Interval milliseconds
+	void SetPacing(const size_t& Burst, const uint32_t& Interval)
+	{
+		m_Burst = Burst ? Burst : 1;
+		m_Interval = Interval;
+	}
+
+	void SetCallback(QueryCallback_t Callback, void* UserData)
+	{
+		m_Callback = Callback;
+		m_UserData = UserData;
+	}
+
+	// Add a server to be queried, its address must already be set
+	bool Queue(ServerBase* Server);
+
+	// Sends due requests, reads replies and expires timed out requests,
+	// waiting at most WaitMs for the first reply. Returns the number of
+	// queries that have not finished yet.
+	size_t Poll(const uint32_t& WaitMs);
+
+	// Poll until every queued query has finished
+	void Run();
+
+	size_t Pending() const
+	{
+		return m_Active;
+	}
+
+	const QueryStats_t& GetStats() const
+	{
+		return m_Stats;
+	}
+
+	// Local port of the shared socket
+	uint16_t GetLocalPort() const
+	{
+		return m_Socket.GetLocalPort();
+	}
+
+private:
+	enum QueryState_t
+	{
+		QS_Waiting,  // In the send queue
+		QS_InFlight, // Sent, waiting for a reply
+		QS_Done
+	};
+
+	struct Query_t
+	{
+		ServerBase*  Server;
+		uint64_t     Key;
+		uint64_t     SendTime;
+		uint64_t     Deadline;
+		uint32_t     Serial;
+		uint8_t      Tries;
+		QueryState_t State;
+	};
+
+	struct WheelEntry_t
+	{
+		size_t   Index;
+		uint32_t Serial;
+	};
+
+	static uint64_t MakeKey(const uint32_t& IP, const uint16_t& Port,
+	                        const uint32_t& Tag);
+	static uint32_t ResponseTag(const uint32_t& Response);
+
+	void SendBurst(const uint64_t& Now);
+	void ReadReplies(const uint32_t& WaitMs);
+	void ExpireQueries(const uint64_t& Now);
+	void Finish(const size_t& Index, const int32_t& Result);
+
+	BufferedSocket m_Socket;
+	bool           m_Open;
+
+	std::vector<Query_t> m_Queries;
+	std::deque<size_t>   m_SendQueue;
+
+	// Pending table, (address, tag) -> query index
+	std::map<uint64_t, size_t> m_Pending;
+	// Queries to an address that already has one in flight
+	std::multimap<uint64_t, size_t> m_Deferred;
+
+	// Timer wheel of in flight requests, bucketed by deadline
+	std::vector<std::vector<WheelEntry_t> > m_Wheel;
+	uint64_t m_WheelTick;
+
+	uint32_t m_Timeout;
+	size_t   m_Burst;
+	uint32_t m_Interval;
+	uint64_t m_NextBurst;
+
+	size_t m_Active;
+
+	QueryCallback_t m_Callback;
+	void*           m_UserData;
+
+	QueryStats_t m_Stats;
+};
+
+// Queries Servers fake servers answering on loopback sockets and reports
+// how the engine kept up. Returns false if the sockets could not be set up.
+bool BenchmarkQueryEngine(const size_t& Servers, QueryStats_t& Stats,
+                          uint64_t& Millis);
+
+} // namespace
+
+#endif // NET_QUERY_H
@@ -64,6 +64,7 @@
 #include "s_sound.h"
 #include "gi.h"
 #include "g_mapinfo.h"
+#include "m_wdlstats.h"
 #include "sv_main.h"
 #include "sv_banlist.h"
 #include "g_horde.h"
@@ -279,6 +280,7 @@ void D_DoomMain()
 	// [SL] Call init routines that need to be reinitialized every time WAD changes
 	D_Init();
 	atterm(D_Shutdown);
+	atterm(M_ShutdownWDLLog);
 
 	Printf(PRINT_HIGH, "SV_InitNetwork: Checking network game status.\n");
 	SV_InitNetwork();
@@ -28,6 +28,7 @@
 
 #include "d_netinf.h"
 #include "sv_main.h"
+#include "sv_sqp.h"
 #include "v_textcolors.h"
 
 // The default preference ordering when the player runs out of one type of ammo.
@@ -76,6 +77,7 @@ void D_SendServerInfoChange (const cvar_t *cvar, const char *value)
 	SetServerVar (cvar->name(), (char *)value);
 	SV_BroadcastPrintf("%s%s has been modified to %s!\n", TEXTCOLOR_YELLOW, cvar->name(), (char*)value);
 	SV_ServerSettingChange ();
+	SV_QryInvalidate ();
 }
 
 FArchive &operator<< (FArchive &arc, UserInfo &info)
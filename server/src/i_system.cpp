@@ -270,6 +270,26 @@ void I_Yield()
 	I_Sleep(1000LL * 1000LL);		// sleep for 1ms
 }
 
+//
+// I_ParallelWorkers
+//
+// The server has no worker threads, so parallel work runs on the calling
+// thread.
+//
+int I_ParallelWorkers()
+{
+	return 1;
+}
+
+//
+// I_RunParallel
+//
+void I_RunParallel(void (*func)(void* data, int part), void* data, int parts)
+{
+	for (int i = 0; i < parts; i++)
+		func(data, i);
+}
+
 //
 // I_WaitVBL
 //
@@ -97,6 +97,9 @@ dtime_t I_MSTime (void);
 
 void I_Yield(void);
 
+int I_ParallelWorkers();
+void I_RunParallel(void (*func)(void* data, int part), void* data, int parts);
+
 // [RH] Title string to display at bottom of console during startup
 extern char DoomStartupTitle[256];
 
@@ -108,6 +108,14 @@ void S_Sound(AActor *ent, int channel, const char *name, float volume, int atten
 {
 }
 
+void S_SoundHandle(int channel, int sfx_id, float volume, int attenuation)
+{
+}
+
+void S_SoundHandle(AActor *ent, int channel, int sfx_id, float volume, int attenuation)
+{
+}
+
 void S_Sound(fixed_t *pt, int channel, const char *name, float volume, int attenuation)
 {
 }
@@ -526,6 +534,7 @@ void S_ParseSndInfo()
 		}
 	}
 	S_HashSounds();
+	S_InternMobjSounds();
 }
 
 void A_Ambient(AActor *actor)
@@ -48,6 +48,7 @@
 #include "s_sound.h"
 #include "sv_main.h"
 #include "sv_maplist.h"
+#include "sv_sqp.h"
 #include "w_wad.h"
 #include "z_zone.h"
 #include "g_levelstate.h"
@@ -781,6 +782,9 @@ void G_DoLoadLevel (int position)
 
 	G_InitLevelLocals ();
 
+	// launcher replies describe the previous map (and maybe wads)
+	SV_QryInvalidate();
+
 	if (firstmapinit) {
 		Printf_Bold ("--- %s: \"%s\" ---\n", level.mapname.c_str(), level.level_name);
 		firstmapinit = false;
@@ -848,8 +852,7 @@ void G_DoLoadLevel (int position)
 	// died.
 
 	{
-		extern msecnode_t *headsecnode; // phares 3/25/98
-		headsecnode = NULL;
+		P_ClearSecNodes(); // phares 3/25/98
 
 		// denis - todo - wtf is this crap?
 		// [RH] Need to prevent the AActor destructor from trying to
@@ -69,6 +69,7 @@
 #include "m_wdlstats.h"
 #include "svc_message.h"
 #include "m_cheat.h"
+#include "hashtable.h"
 
 #include <algorithm>
 #include <sstream>
@@ -528,17 +529,150 @@ Players::iterator SV_GetFreeClient(void)
 	return --it;
 }
 
-player_t &SV_FindPlayerByAddr(void)
+//
+// Address to player id index for SV_FindPlayerByAddr, so that packets from
+// unknown senders (connection attempts, launcher queries, floods) don't
+// cost a walk of the players list each. It is rebuilt whenever players are
+// added or removed, or a player is given a new address.
+//
+typedef OHashTable<uint64_t, byte> PlayerAddrTable;
+static PlayerAddrTable player_addrs;
+static unsigned int player_addrs_generation = 0;
+static bool player_addrs_valid = false;
+
+static unsigned int addr_lookups = 0;
+static unsigned int addr_unknown = 0;
+static unsigned int addr_rebuilds = 0;
+static unsigned int addr_stale = 0;
+
+static uint64_t SV_AddrKey(const netadr_t& adr)
+{
+	return ((uint64_t)adr.ip[0] << 40) | ((uint64_t)adr.ip[1] << 32) |
+	       ((uint64_t)adr.ip[2] << 24) | ((uint64_t)adr.ip[3] << 16) | adr.port;
+}
+
+static void SV_InvalidateAddrIndex()
+{
+	player_addrs_valid = false;
+}
+
+static void SV_RebuildAddrIndex()
+{
+	player_addrs.clear();
+
+	// the first player with an address wins, as with a scan of the list
+	for (Players::iterator it = players.begin(); it != players.end(); ++it)
+	{
+		const uint64_t key = SV_AddrKey(it->client.address);
+		if (player_addrs.find(key) == player_addrs.end())
+			player_addrs.insert(std::make_pair(key, it->id));
+	}
+
+	player_addrs_generation = players.generation();
+	player_addrs_valid = true;
+	addr_rebuilds++;
+}
+
+static player_t& SV_ScanPlayerByAddr(const netadr_t& adr)
 {
 	for (Players::iterator it = players.begin();it != players.end();++it)
 	{
-		if (NET_CompareAdr(it->client.address, net_from))
+		if (NET_CompareAdr(it->client.address, adr))
 		   return *it;
 	}
 
 	return idplayer(0);
 }
 
+static player_t& SV_LookupPlayerByAddr(const netadr_t& adr)
+{
+	if (!player_addrs_valid || player_addrs_generation != players.generation())
+		SV_RebuildAddrIndex();
+
+	PlayerAddrTable::const_iterator it = player_addrs.find(SV_AddrKey(adr));
+	if (it == player_addrs.end())
+		return idplayer(0);
+
+	player_t* player = players.lookup(it->second);
+	if (player != NULL && NET_CompareAdr(player->client.address, adr))
+		return *player;
+
+	// Shouldn't happen, but never turn a connected client away over it.
+	addr_stale++;
+	SV_InvalidateAddrIndex();
+	return SV_ScanPlayerByAddr(adr);
+}
+
+player_t &SV_FindPlayerByAddr(void)
+{
+	player_t& player = SV_LookupPlayerByAddr(net_from);
+
+	addr_lookups++;
+	if (!validplayer(player))
+		addr_unknown++;
+
+	return player;
+}
+
+BEGIN_COMMAND(addrstats)
+{
+	Printf(PRINT_HIGH, "%u packets looked up, %u from unknown senders\n", addr_lookups,
+	       addr_unknown);
+	Printf(PRINT_HIGH, "%u index rebuilds, %u stale entries\n", addr_rebuilds, addr_stale);
+
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+		addr_lookups = addr_unknown = addr_rebuilds = addr_stale = 0;
+}
+END_COMMAND(addrstats)
+
+//
+// addrbench [count]
+//
+// Synthetic flood: looks up count made-up sender addresses plus every
+// connected client's, through the index and through a scan of the players
+// list, and reports the packets per second each could classify.
+//
+BEGIN_COMMAND(addrbench)
+{
+	const int count = argc > 1 ? MAX(atoi(argv[1]), 1) : 100000;
+
+	std::vector<netadr_t> addrs;
+	addrs.reserve(count + players.size());
+
+	for (int i = 0; i < count; i++)
+	{
+		netadr_t adr;
+		adr.ip[0] = 10;
+		adr.ip[1] = (i >> 16) & 0xFF;
+		adr.ip[2] = (i >> 8) & 0xFF;
+		adr.ip[3] = i & 0xFF;
+		adr.port = 10666 + (i & 0x3FF);
+		addrs.push_back(adr);
+	}
+	for (Players::iterator it = players.begin(); it != players.end(); ++it)
+		addrs.push_back(it->client.address);
+
+	unsigned int found = 0;
+	dtime_t start = I_GetTime();
+	for (size_t i = 0; i < addrs.size(); i++)
+		if (validplayer(SV_LookupPlayerByAddr(addrs[i])))
+			found++;
+	const dtime_t indexed = I_GetTime() - start;
+
+	start = I_GetTime();
+	for (size_t i = 0; i < addrs.size(); i++)
+		if (validplayer(SV_ScanPlayerByAddr(addrs[i])))
+			found++;
+	const dtime_t scanned = I_GetTime() - start;
+
+	Printf(PRINT_HIGH, "addrbench: %u packets, %u players, %u matched\n",
+	       (unsigned int)addrs.size(), (unsigned int)players.size(), found / 2);
+	Printf(PRINT_HIGH, "addrbench: index %.0f packets/sec, scan %.0f packets/sec\n",
+	       indexed ? addrs.size() * 1e9 / indexed : 0.0,
+	       scanned ? addrs.size() * 1e9 / scanned : 0.0);
+}
+END_COMMAND(addrbench)
+
 //
 // SV_CheckTimeouts
 // If a packet has not been received from a client in CLIENT_TIMEOUT
@@ -649,10 +783,17 @@ void SV_MidPrint(const char* msg, player_t* p, int msgtime)
 //
 void SV_Sound (AActor *mo, byte channel, const char *name, byte attenuation)
 {
-	int sfx_id;
-	client_t* cl;
+	SV_SoundID(mo, channel, S_FindSound(name), attenuation);
+}
 
-	sfx_id = S_FindSound (name);
+//
+// SV_SoundID
+//
+// SV_Sound for a sound that has already been resolved with S_FindSound.
+//
+void SV_SoundID(AActor* mo, byte channel, int sfx_id, byte attenuation)
+{
+	client_t* cl;
 
 	if (sfx_id >= static_cast<int>(S_sfx.size()) || sfx_id < 0)
 	{
@@ -1759,6 +1900,7 @@ void SV_ConnectClient()
 
 	// clear and reinitialize client network info
 	cl->address = net_from;
+	SV_InvalidateAddrIndex();
 	cl->last_received = gametic;
 	cl->reliable_bps = 0;
 	cl->unreliable_bps = 0;
@@ -2913,22 +3055,27 @@ void SV_RemoveCorpses (void)
 		return;
 	else
 	{
-		TThinkerIterator<AActor> iterator;
+		FActorTypeIterator iterator(MT_PLAYER);
 		while ( (mo = iterator.Next() ) )
 		{
-			if (mo->type == MT_PLAYER && (!mo->player || mo->health <=0) )
+			if (!mo->player || mo->health <=0)
 				corpses++;
 		}
 	}
 
-	TThinkerIterator<AActor> iterator;
-	while (corpses > sv_maxcorpses && (mo = iterator.Next() ) )
+	// oldest corpses first; grab the next link before destroying
+	mo = AActor::FirstOfType(MT_PLAYER);
+	while (corpses > sv_maxcorpses && mo)
 	{
-		if (mo->type == MT_PLAYER && !mo->player)
+		AActor* next = mo->tnext;
+
+		if (!mo->player)
 		{
 			mo->Destroy();
 			corpses--;
 		}
+
+		mo = next;
 	}
 }
 
@@ -4215,6 +4362,8 @@ void SV_RunTics()
 	if (!step_mode && !SV_Frozen())
 		SV_StepTics(1);
 
+	M_WDLTicker();
+
 	// Remove any recently disconnected clients
 	for (Players::iterator it = players.begin(); it != players.end();)
 	{
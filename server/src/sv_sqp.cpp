@@ -31,12 +31,189 @@
 #include "md5.h"
 #include "p_ctf.h"
 #include "g_gametype.h"
+#include "i_system.h"
+#include "c_dispatch.h"
+#include "hashtable.h"
 
 static buf_t ml_message(MAX_UDP_PACKET);
 
 EXTERN_CVAR(join_password)
 EXTERN_CVAR(sv_timelimit)
 EXTERN_CVAR(sv_teamsinplay)
+EXTERN_CVAR(sv_qrylimit)
+
+// Bumped by SV_QryInvalidate, dropping every cached reply
+static unsigned int qry_epoch = 1;
+
+// Queries seen from each source address in the current second
+typedef OHashTable<uint32_t, unsigned int> QrySourceTable;
+static QrySourceTable qry_sources;
+static dtime_t qry_window = 0;
+
+// Sources beyond this in one second are all treated as over the limit,
+// which keeps the table well short of its capacity under a spoofed flood
+static const size_t MAX_QRY_SOURCES = 16384;
+
+static unsigned int qry_built = 0;
+static unsigned int qry_cached = 0;
+static unsigned int qry_limited = 0;
+
+// Pings and time played in a cached reply are refreshed after this long
+static const dtime_t QRY_MAX_AGE = 1000LL * 1000LL * 1000LL;
+
+bool QryCachedReply::valid() const
+{
+	return m_epoch == qry_epoch && !m_data.empty();
+}
+
+bool QryCachedReply::matches(DWORD signature) const
+{
+	return valid() && m_signature == signature && I_GetTime() - m_built < QRY_MAX_AGE;
+}
+
+void QryCachedReply::store(const buf_t& buf, size_t start, DWORD signature)
+{
+	if (buf.overflowed || buf.cursize < start)
+	{
+		m_data.clear();
+		return;
+	}
+
+	m_data.assign(buf.data + start, buf.data + buf.cursize);
+	m_epoch = qry_epoch;
+	m_built = I_GetTime();
+	m_signature = signature;
+}
+
+void QryCachedReply::write(buf_t* buf) const
+{
+	MSG_WriteChunk(buf, &m_data[0], m_data.size());
+}
+
+//
+// SV_QryInvalidate
+//
+// Called when the map or a serverinfo cvar changes.
+//
+void SV_QryInvalidate()
+{
+	if (++qry_epoch == 0)
+		qry_epoch = 1;
+}
+
+static DWORD SV_QryHash(DWORD hash, const void* data, size_t length)
+{
+	const byte* bytes = static_cast<const byte*>(data);
+
+	// FNV-1a
+	for (size_t i = 0; i < length; i++)
+		hash = (hash ^ bytes[i]) * 16777619u;
+
+	return hash;
+}
+
+static DWORD SV_QryHashInt(DWORD hash, int value)
+{
+	return SV_QryHash(hash, &value, sizeof(value));
+}
+
+static DWORD SV_QryHashString(DWORD hash, const std::string& str)
+{
+	return SV_QryHash(hash, str.c_str(), str.length() + 1);
+}
+
+//
+// SV_QryStateSignature
+//
+// A hash of the state launcher replies describe that can change without a
+// map or serverinfo change: who is connected, names, teams, scores and the
+// time left.
+//
+DWORD SV_QryStateSignature()
+{
+	DWORD hash = 2166136261u;
+
+	hash = SV_QryHashInt(hash, players.generation());
+	hash = SV_QryHashInt(hash, G_IsTeamGame());
+	hash = SV_QryHashInt(hash, (int)(sv_timelimit - level.time / (TICRATE * 60)));
+	hash = SV_QryHashString(hash, join_password.str());
+
+	for (int i = 0; i < NUMTEAMS; i++)
+		hash = SV_QryHashInt(hash, GetTeamInfo((team_t)i)->Points);
+
+	for (Players::iterator it = players.begin(); it != players.end(); ++it)
+	{
+		hash = SV_QryHashString(hash, it->userinfo.netname);
+		hash = SV_QryHash(hash, it->userinfo.color, sizeof(it->userinfo.color));
+		hash = SV_QryHashInt(hash, it->userinfo.team);
+		hash = SV_QryHashInt(hash, it->spectator);
+		hash = SV_QryHashInt(hash, it->playerstate);
+		hash = SV_QryHashInt(hash, it->fragcount);
+		hash = SV_QryHashInt(hash, it->killcount);
+		hash = SV_QryHashInt(hash, it->deathcount);
+	}
+
+	return hash;
+}
+
+//
+// SV_QryRateLimited
+//
+// Counts a query from net_from. Sources that query more than sv_qrylimit
+// times a second are answered from cache without looking at the game.
+//
+bool SV_QryRateLimited()
+{
+	if (sv_qrylimit.asInt() <= 0)
+		return false;
+
+	const dtime_t window = I_MSTime() / 1000;
+	if (window != qry_window)
+	{
+		qry_sources.clear();
+		qry_window = window;
+	}
+
+	const uint32_t source = (net_from.ip[0] << 24) | (net_from.ip[1] << 16) |
+	                        (net_from.ip[2] << 8) | net_from.ip[3];
+
+	QrySourceTable::iterator it = qry_sources.find(source);
+	if (it == qry_sources.end())
+	{
+		if (qry_sources.size() >= MAX_QRY_SOURCES)
+		{
+			qry_limited++;
+			return true;
+		}
+
+		qry_sources.insert(std::make_pair(source, 1u));
+		return false;
+	}
+
+	if (++it->second <= (unsigned int)sv_qrylimit.asInt())
+		return false;
+
+	qry_limited++;
+	return true;
+}
+
+void SV_QryCountReply(bool cached)
+{
+	if (cached)
+		qry_cached++;
+	else
+		qry_built++;
+}
+
+BEGIN_COMMAND(qrystats)
+{
+	Printf(PRINT_HIGH, "%u launcher replies built, %u sent from cache, %u rate limited\n",
+	       qry_built, qry_cached, qry_limited);
+
+	if (argc > 1 && stricmp(argv[1], "reset") == 0)
+		qry_built = qry_cached = qry_limited = 0;
+}
+END_COMMAND(qrystats)
 
 struct CvarField_t
 {
@@ -72,14 +249,10 @@ struct CvarField_t
 // IntQryBuildInformation()
 //
 // Protocol building routine, the passed parameter is the enquirer version
-static void IntQryBuildInformation(const DWORD& EqProtocolVersion,
-                                   const DWORD& EqTime)
+static void IntQryBuildInformation(const DWORD& EqProtocolVersion)
 {
 	std::vector<CvarField_t> Cvars;
 
-	// bond - time
-	MSG_WriteLong(&ml_message, EqTime);
-
 	// The servers real protocol version
 	// bond - real protocol
 	MSG_WriteLong(&ml_message, PROTOCOL_VERSION);
@@ -391,7 +564,38 @@ static DWORD IntQrySendResponse(const WORD& TagId,
 	else
 		MSG_WriteLong(&ml_message, EqProtocolVersion);
 
-	IntQryBuildInformation(EqProtocolVersion, EqTime);
+	// bond - time
+	MSG_WriteLong(&ml_message, EqTime);
+
+	// Everything after the time is the same for every enquirer of a given
+	// version until the server changes, so it is cached per version
+	static QryCachedReply replies[PROTOCOL_VERSION + 1];
+	QryCachedReply& reply = replies[EqProtocolVersion];
+
+	const bool limited = SV_QryRateLimited();
+
+	if (limited && reply.valid())
+	{
+		reply.write(&ml_message);
+		SV_QryCountReply(true);
+	}
+	else
+	{
+		const DWORD signature = SV_QryStateSignature();
+
+		if (reply.matches(signature))
+		{
+			reply.write(&ml_message);
+			SV_QryCountReply(true);
+		}
+		else
+		{
+			const size_t start = ml_message.size();
+			IntQryBuildInformation(EqProtocolVersion);
+			reply.store(ml_message, start, signature);
+			SV_QryCountReply(false);
+		}
+	}
 
 	NET_SendPacket(ml_message, net_from);
 
@@ -22,4 +22,40 @@
 
 #pragma once
 
+#include "i_net.h"
+
 DWORD SV_QryParseEnquiry(const DWORD &Tag);
+
+//
+// QryCachedReply
+//
+// The body of a launcher reply, kept until the server state it describes
+// changes. Map changes and serverinfo cvar changes drop every cached reply
+// through SV_QryInvalidate; joins, leaves, scores and names are caught by
+// SV_QryStateSignature. Pings and time played may be up to a second old.
+//
+class QryCachedReply
+{
+  public:
+	QryCachedReply() : m_epoch(0), m_built(0), m_signature(0) { }
+
+	// true if there is a reply that hasn't been invalidated
+	bool valid() const;
+	// true if the reply is valid and still describes the server
+	bool matches(DWORD signature) const;
+
+	// keep everything written to buf since offset start
+	void store(const buf_t& buf, size_t start, DWORD signature);
+	void write(buf_t* buf) const;
+
+  private:
+	std::vector<byte> m_data;
+	unsigned int m_epoch;
+	dtime_t m_built;
+	DWORD m_signature;
+};
+
+void SV_QryInvalidate();
+DWORD SV_QryStateSignature();
+bool SV_QryRateLimited();
+void SV_QryCountReply(bool cached);
@@ -31,6 +31,7 @@
 #include "i_system.h"
 #include "p_ctf.h"
 #include "g_gametype.h"
+#include "sv_sqp.h"
 
 static buf_t ml_message(MAX_UDP_PACKET);
 
@@ -134,23 +135,14 @@ bool SV_IsValidToken(DWORD token)
 }
 
 //
-// SV_SendServerInfo
-// 
-// Sends server info to a launcher
-// TODO: Clean up and reinvent.
-void SV_SendServerInfo()
+// SV_BuildServerInfo
+//
+// Writes the body of a launcher reply, everything after the token and key.
+//
+static void SV_BuildServerInfo()
 {
 	size_t i;
 
-	SZ_Clear(&ml_message);
-	
-	MSG_WriteLong(&ml_message, MSG_CHALLENGE);
-	MSG_WriteLong(&ml_message, SV_NewToken());
-
-	// if master wants a key to be presented, present it we will
-	if(MSG_BytesLeft() == 4)
-		MSG_WriteLong(&ml_message, MSG_ReadLong());
-
 	MSG_WriteString(&ml_message, (char *)sv_hostname.cstring());
 
 	byte playersingame = 0;
@@ -280,6 +272,51 @@ void SV_SendServerInfo()
 		MSG_WriteString(&ml_message,
 		                D_CleanseFileName(patchfiles[i].getBasename()).c_str());
 	}
+}
+
+//
+// SV_SendServerInfo
+// 
+// Sends server info to a launcher
+// TODO: Clean up and reinvent.
+void SV_SendServerInfo()
+{
+	SZ_Clear(&ml_message);
+	
+	MSG_WriteLong(&ml_message, MSG_CHALLENGE);
+	MSG_WriteLong(&ml_message, SV_NewToken());
+
+	// if master wants a key to be presented, present it we will
+	if(MSG_BytesLeft() == 4)
+		MSG_WriteLong(&ml_message, MSG_ReadLong());
+
+	// The token and key are per enquirer, the rest is cached
+	static QryCachedReply reply;
+
+	const bool limited = SV_QryRateLimited();
+
+	if (limited && reply.valid())
+	{
+		reply.write(&ml_message);
+		SV_QryCountReply(true);
+	}
+	else
+	{
+		const DWORD signature = SV_QryStateSignature();
+
+		if (reply.matches(signature))
+		{
+			reply.write(&ml_message);
+			SV_QryCountReply(true);
+		}
+		else
+		{
+			const size_t start = ml_message.size();
+			SV_BuildServerInfo();
+			reply.store(ml_message, start, signature);
+			SV_QryCountReply(false);
+		}
+	}
 
 	NET_SendPacket(ml_message, net_from);
 }